@@ -0,0 +1,142 @@
+#include "BenchmarkScenes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <string>
+#include "physics/Constants.h"
+#include "physics/PointMass.h"
+#include "physics/Precision.h"
+#include "physics/RigidBody.h"
+#include "physics/bounding/BoxCollider.h"
+#include "physics/profiling/StepProfiler.h"
+
+namespace {
+    constexpr float kSpacing = 10.0f;     // mean distance between neighbours
+    constexpr float kBoxHalfSize = 2.0f;  // rigid bodies overlap only with close neighbours
+    constexpr float kPileSpacing = 3.5f;  // FloorPile grid, a little under one box width
+    constexpr float kFloorHalfHeight = 1.0f;
+    constexpr double kCoreMass = 1.0e6;
+
+    // Recorded into the JSON context, results are only comparable within one build flavour
+    [[maybe_unused]] const bool contextRegistered = [] {
+        benchmark::AddCustomContext("physics_precision", sizeof(Physics::Real) == sizeof(double) ? "double" : "float");
+        benchmark::AddCustomContext("physics_profiling", Physics::StepProfiler::enabled ? "on" : "off");
+        return true;
+    }();
+
+    glm::vec3 randomDirection(std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (;;) {
+            const glm::vec3 v(unit(rng), unit(rng), unit(rng));
+            const float lengthSq = glm::dot(v, v);
+            if (lengthSq > 1e-6f && lengthSq <= 1.0f) return v / std::sqrt(lengthSq);
+        }
+    }
+
+    std::unique_ptr<Physics::PhysicsBody> makeBody(std::uint32_t id, double mass, const glm::vec3& pos, bool rigidBox) {
+        if (!rigidBox) return std::make_unique<Physics::PointMass>(id, mass, pos, false);
+        auto collider = std::make_unique<Physics::Bounding::BoxCollider>(
+            glm::vec3(0.0f), glm::vec3(kBoxHalfSize), glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        return std::make_unique<Physics::RigidBody>(id, mass, std::move(collider), pos, false);
+    }
+}
+
+const char* Bench::sceneName(SceneShape shape) {
+    switch (shape) {
+        case SceneShape::UniformCube: return "UniformCube";
+        case SceneShape::Plummer: return "Plummer";
+        case SceneShape::Disk: return "Disk";
+        case SceneShape::FloorPile: return "FloorPile";
+    }
+    return "Unknown";
+}
+
+Bench::Scene Bench::makeScene(SceneShape shape, std::size_t count, bool rigidBoxes, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::uniform_real_distribution<float> temperature(200.0f, 400.0f);
+    const float extent = std::cbrt(static_cast<float>(count)) * kSpacing;
+
+    Scene scene;
+    scene.owned.reserve(count + 1);
+    auto add = [&](std::unique_ptr<Physics::PhysicsBody> body, const glm::vec3& velocity) {
+        ThermalProperties props = body->getThermalProperties(BodyLock::LOCK);
+        props.tempK = temperature(rng);
+        body->setThermalProperty(props, BodyLock::LOCK);
+        body->setVelocity(velocity, BodyLock::LOCK);
+        scene.bodies.push_back(body.get());
+        scene.owned.push_back(std::move(body));
+    };
+
+    switch (shape) {
+        case SceneShape::UniformCube:
+            for (std::uint32_t i = 0; i < count; ++i) {
+                const glm::vec3 pos = (glm::vec3(uniform(rng), uniform(rng), uniform(rng)) - 0.5f) * extent;
+                add(makeBody(i, 1.0, pos, rigidBoxes), glm::vec3(0.0f));
+            }
+            break;
+
+        case SceneShape::Plummer: {
+            // Inverse-CDF radius, speed of a circular orbit at that radius
+            const float a = 0.5f * extent;
+            const double totalMass = static_cast<double>(count);
+            for (std::uint32_t i = 0; i < count; ++i) {
+                const float u = std::max(uniform(rng), 1e-6f);
+                const float r = std::min(a / std::sqrt(std::pow(u, -2.0f / 3.0f) - 1.0f), 20.0f * a);
+                const glm::vec3 dir = randomDirection(rng);
+                const double enclosed = totalMass * std::pow(r * r / (r * r + a * a), 1.5);
+                const float speed = static_cast<float>(std::sqrt(enclosed / std::max(r, 1.0f)));
+                const glm::vec3 tangent = glm::normalize(glm::cross(dir, randomDirection(rng)));
+                add(makeBody(i, 1.0, dir * r, rigidBoxes), tangent * speed);
+            }
+            break;
+        }
+
+        case SceneShape::Disk: {
+            add(makeBody(0, kCoreMass, glm::vec3(0.0f), rigidBoxes), glm::vec3(0.0f));
+            const float scaleLength = 0.25f * std::sqrt(static_cast<float>(count)) * kSpacing;
+            for (std::uint32_t i = 1; i < count; ++i) {
+                // Radius from an exponential profile (sum of two exponentials = gamma(2))
+                const float r = scaleLength * (-std::log(1.0f - uniform(rng)) - std::log(1.0f - uniform(rng))) + kSpacing;
+                const float phi = 2.0f * std::numbers::pi_v<float> * uniform(rng);
+                const float z = (uniform(rng) - 0.5f) * kSpacing;
+                const glm::vec3 pos(r * std::cos(phi), z, r * std::sin(phi));
+                const float speed = static_cast<float>(std::sqrt(kCoreMass / r));
+                add(makeBody(i, 1.0, pos, rigidBoxes), glm::vec3(-std::sin(phi), 0.0f, std::cos(phi)) * speed);
+            }
+            break;
+        }
+
+        case SceneShape::FloorPile: {
+            // Stacked jittered grid, boxes touch their neighbours and the bottom layer sinks into the floor
+            const std::size_t side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(count) / 16.0)));
+            const float footprint = static_cast<float>(side) * kPileSpacing;
+            for (std::uint32_t i = 0; i + 1 < count; ++i) {
+                const std::size_t column = i % (side * side);
+                const std::size_t layer = i / (side * side);
+                const glm::vec3 jitter(uniform(rng) - 0.5f, 0.0f, uniform(rng) - 0.5f);
+                const glm::vec3 pos(static_cast<float>(column % side) * kPileSpacing - 0.5f * footprint,
+                                    static_cast<float>(layer) * kPileSpacing + kFloorHalfHeight + 0.75f * kBoxHalfSize,
+                                    static_cast<float>(column / side) * kPileSpacing - 0.5f * footprint);
+                add(makeBody(i, 1.0, pos + jitter, rigidBoxes), glm::vec3(0.0f));
+            }
+            auto floorCollider = std::make_unique<Physics::Bounding::BoxCollider>(
+                glm::vec3(0.0f), glm::vec3(footprint, kFloorHalfHeight, footprint), glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+            add(std::make_unique<Physics::RigidBody>(static_cast<std::uint32_t>(count - 1), std::move(floorCollider), glm::vec3(0.0f), true),
+                glm::vec3(0.0f));
+            scene.globalAcceleration = glm::vec3(0.0f, -Constants::STANDARD_GRAVITY, 0.0f);
+            break;
+        }
+    }
+    return scene;
+}
+
+void Bench::SceneArgs(benchmark::internal::Benchmark* b) {
+    for (auto shape : { SceneShape::UniformCube, SceneShape::Plummer, SceneShape::Disk, SceneShape::FloorPile }) {
+        for (int count = 100; count <= 1000000; count *= 10) {
+            b->Args({ static_cast<int>(shape), count });
+        }
+    }
+}
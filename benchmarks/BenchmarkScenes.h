@@ -0,0 +1,35 @@
+#pragma once
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "physics/PhysicsBody.h"
+
+// Deterministic synthetic scenes shared by the benchmarks (G = 1 units)
+namespace Bench {
+    enum class SceneShape : int {
+        UniformCube, // constant density cube
+        Plummer,     // Plummer sphere, strongly centrally concentrated
+        Disk,        // thin exponential disk on circular orbits around a heavy core
+        FloorPile,   // column of bodies resting above a static floor box, under uniform gravity
+    };
+
+    const char* sceneName(SceneShape shape);
+
+    struct Scene {
+        std::vector<std::unique_ptr<Physics::PhysicsBody>> owned;
+        std::vector<Physics::PhysicsBody*> bodies;
+        glm::vec3 globalAcceleration = glm::vec3(0.0f);
+    };
+
+    /**
+     * @brief Builds count bodies of the given shape, the same ones for the same seed
+     *
+     * @param rigidBoxes Make every body a small box RigidBody instead of a PointMass,
+     *                   so the BVH has colliders to work on
+     */
+    Scene makeScene(SceneShape shape, std::size_t count, bool rigidBoxes = false, std::uint32_t seed = 42);
+
+    // Args: {SceneShape, body count} for every shape and 100 .. 1M bodies
+    void SceneArgs(benchmark::internal::Benchmark* b);
+}
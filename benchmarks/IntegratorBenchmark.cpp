@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numbers>
+#include <vector>
+#include "physics/PhysicsSystem.h"
+#include "physics/PointMass.h"
+
+namespace {
+    constexpr double kG = 1.0;
+    constexpr double kSofteningSq = Constants::SOFTENING_SQ;
+
+    // Softened like the octree so a perfect integrator conserves it exactly
+    double totalEnergy(const std::vector<std::unique_ptr<Physics::PointMass>>& bodies) {
+        double energy = 0.0;
+        for (std::size_t i = 0; i < bodies.size(); ++i) {
+            const double mi = bodies[i]->getMass(BodyLock::LOCK);
+            const glm::dvec3 vi(bodies[i]->getVelocity(BodyLock::LOCK));
+            const glm::dvec3 xi(bodies[i]->getPosition(BodyLock::LOCK));
+            energy += 0.5 * mi * glm::dot(vi, vi);
+            for (std::size_t j = i + 1; j < bodies.size(); ++j) {
+                const glm::dvec3 d = xi - glm::dvec3(bodies[j]->getPosition(BodyLock::LOCK));
+                energy -= kG * mi * bodies[j]->getMass(BodyLock::LOCK) / std::sqrt(glm::dot(d, d) + kSofteningSq);
+            }
+        }
+        return energy;
+    }
+}
+
+// Energy drift of each integrator on a star with two interacting planets (inner period 2*pi).
+// Args: {IntegratorType, steps per inner orbit}. Runs 20 inner orbits per iteration;
+// energy_drift is the worst relative energy error seen, items_per_second is steps per second.
+static void BM_Integrator_EnergyDrift(benchmark::State& state) {
+    const auto type = static_cast<Physics::IntegratorType>(state.range(0));
+    const auto stepsPerOrbit = static_cast<int>(state.range(1));
+    const float dt = static_cast<float>(2.0 * std::numbers::pi / stepsPerOrbit);
+    const int steps = 20 * stepsPerOrbit;
+
+    double worstDrift = 0.0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Physics::PhysicsSystem system(glm::vec3(0.0f));
+        system.setGravitationalConstant(kG);
+        system.setWorkerCount(1);
+        system.setIntegrator(type);
+
+        std::vector<std::unique_ptr<Physics::PointMass>> bodies;
+        bodies.push_back(std::make_unique<Physics::PointMass>(0, 1.0e6, glm::vec3(0.0f), false));
+        bodies.push_back(std::make_unique<Physics::PointMass>(1, 1.0, glm::vec3(100.0f, 0.0f, 0.0f), false));
+        bodies.push_back(std::make_unique<Physics::PointMass>(2, 10.0, glm::vec3(0.0f, -160.0f, 0.0f), false));
+        bodies[1]->setVelocity(glm::vec3(0.0f, 100.0f, 0.0f), BodyLock::LOCK);
+        bodies[2]->setVelocity(glm::vec3(static_cast<float>(std::sqrt(1.0e6 / 160.0)), 0.0f, 0.0f), BodyLock::LOCK);
+        for (auto& body : bodies) system.addBody(body.get());
+        const double initialEnergy = totalEnergy(bodies);
+        state.ResumeTiming();
+
+        for (int i = 0; i < steps; ++i) {
+            system.step(dt);
+        }
+
+        state.PauseTiming();
+        worstDrift = std::max(worstDrift, std::fabs((totalEnergy(bodies) - initialEnergy) / initialEnergy));
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * steps);
+    state.SetLabel(Physics::integratorName(type));
+    state.counters["energy_drift"] = worstDrift;
+}
+
+static void EnergyDriftArgs(benchmark::internal::Benchmark* b) {
+    for (auto type : { Physics::IntegratorType::VelocityVerlet, Physics::IntegratorType::LeapfrogKDK,
+                       Physics::IntegratorType::Yoshida4, Physics::IntegratorType::Yoshida6,
+                       Physics::IntegratorType::WisdomHolman }) {
+        for (int stepsPerOrbit : { 8, 32, 128, 1024 }) {
+            b->Args({ static_cast<int>(type), stepsPerOrbit });
+        }
+    }
+}
+
+BENCHMARK(BM_Integrator_EnergyDrift)->Apply(EnergyDriftArgs)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,259 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "BenchmarkScenes.h"
+#include "physics/Constants.h"
+#include "physics/spatial/BVH.h"
+#include "physics/spatial/FastMultipole.h"
+#include "physics/spatial/LeafKernels.h"
+#include "physics/spatial/Octree.h"
+#include "physics/utils/ThreadPool.h"
+
+namespace {
+    // Tree queries are timed on an evenly strided sample so 1M-body scenes stay affordable;
+    // the walk cost per query is what matters and items_per_second reports queries
+    constexpr std::size_t kMaxQueries = 10000;
+
+    std::vector<Physics::PhysicsBody*> querySample(const std::vector<Physics::PhysicsBody*>& bodies) {
+        const std::size_t stride = std::max<std::size_t>(1, bodies.size() / kMaxQueries);
+        std::vector<Physics::PhysicsBody*> sample;
+        for (std::size_t i = 0; i < bodies.size(); i += stride) sample.push_back(bodies[i]);
+        return sample;
+    }
+
+    // Mean relative error of forces against the direct sum, over a few hundred bodies
+    template <typename ForceFn>
+    double meanForceError(const std::vector<Physics::PhysicsBody*>& bodies, ForceFn&& force) {
+        constexpr std::size_t kErrorSamples = 256;
+        const std::size_t stride = std::max<std::size_t>(1, bodies.size() / kErrorSamples);
+        double total = 0.0;
+        std::size_t samples = 0;
+        for (std::size_t i = 0; i < bodies.size(); i += stride) {
+            const glm::dvec3 pos = bodies[i]->getPositionPrecise(BodyLock::NOLOCK);
+            glm::dvec3 direct(0.0);
+            for (Physics::PhysicsBody* other : bodies) {
+                if (other == bodies[i]) continue;
+                const glm::dvec3 d = other->getPositionPrecise(BodyLock::NOLOCK) - pos;
+                const double distSq = glm::dot(d, d) + Constants::SOFTENING_SQ;
+                direct += bodies[i]->getMass(BodyLock::NOLOCK) * other->getMass(BodyLock::NOLOCK) / (distSq * std::sqrt(distSq)) * d;
+            }
+            if (glm::length(direct) == 0.0) continue;
+            total += glm::length(glm::dvec3(force(i)) - direct) / glm::length(direct);
+            ++samples;
+        }
+        return samples ? total / static_cast<double>(samples) : 0.0;
+    }
+
+    Bench::SceneShape shapeArg(const benchmark::State& state) {
+        return static_cast<Bench::SceneShape>(state.range(0));
+    }
+
+    // Sources spread over a unit cube around the origin, as an octree query would gather them
+    struct KernelSources {
+        std::vector<Physics::Real> x, y, z, mass;
+        std::vector<double> area, emission;
+
+        explicit KernelSources(std::size_t count) {
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<double> position(-0.5, 0.5);
+            std::uniform_real_distribution<double> weight(0.5, 2.0);
+            for (std::size_t i = 0; i < count; ++i) {
+                x.push_back(static_cast<Physics::Real>(position(rng)));
+                y.push_back(static_cast<Physics::Real>(position(rng)));
+                z.push_back(static_cast<Physics::Real>(position(rng)));
+                mass.push_back(static_cast<Physics::Real>(weight(rng)));
+                area.push_back(weight(rng));
+                emission.push_back(weight(rng) * 1e8);
+            }
+        }
+    };
+
+    // Selects the kernel level for one benchmark run and restores the detected one after
+    class ScopedKernelLevel {
+    public:
+        explicit ScopedKernelLevel(benchmark::State& state) {
+            const auto level = static_cast<Physics::LeafKernels::Level>(state.range(0));
+            supported = level <= Physics::LeafKernels::detectedLevel();
+            if (!supported) {
+                state.SkipWithError("kernel level not supported by this build or CPU");
+                return;
+            }
+            Physics::LeafKernels::setLevel(level);
+            state.SetLabel(Physics::LeafKernels::levelName(level));
+        }
+        ~ScopedKernelLevel() { Physics::LeafKernels::setLevel(Physics::LeafKernels::detectedLevel()); }
+
+        bool supported = false;
+    };
+}
+
+// Args for all: {SceneShape, body count}
+
+static void BM_Octree_Build(benchmark::State& state) {
+    const Bench::Scene scene = Bench::makeScene(shapeArg(state), static_cast<std::size_t>(state.range(1)));
+    Octree octree;
+    for (auto _ : state) {
+        octree.build(scene.bodies);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(scene.bodies.size()));
+    state.counters["nodes"] = static_cast<double>(octree.nodeCount());
+    state.SetLabel(Bench::sceneName(shapeArg(state)));
+}
+
+static void BM_Octree_BuildParallel(benchmark::State& state) {
+    const Bench::Scene scene = Bench::makeScene(shapeArg(state), static_cast<std::size_t>(state.range(1)));
+    Physics::ThreadPool pool;
+    Octree octree;
+    for (auto _ : state) {
+        octree.build(scene.bodies, &pool);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(scene.bodies.size()));
+    state.counters["threads"] = static_cast<double>(pool.size());
+    state.SetLabel(Bench::sceneName(shapeArg(state)));
+}
+
+static void BM_Octree_ComputeForce(benchmark::State& state) {
+    const Bench::Scene scene = Bench::makeScene(shapeArg(state), static_cast<std::size_t>(state.range(1)));
+    const std::vector<Physics::PhysicsBody*> sample = querySample(scene.bodies);
+    Octree octree;
+    octree.build(scene.bodies);
+    for (auto _ : state) {
+        for (Physics::PhysicsBody* body : sample) {
+            benchmark::DoNotOptimize(octree.computeForce(body, 1.0));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(sample.size()));
+    state.SetLabel(Bench::sceneName(shapeArg(state)));
+}
+
+// Args: {SceneShape, body count, thetaSq * 100, quadrupoles}. Query cost against force error
+static void BM_Octree_ComputeForceAccuracy(benchmark::State& state) {
+    const Bench::Scene scene = Bench::makeScene(shapeArg(state), static_cast<std::size_t>(state.range(1)));
+    const std::vector<Physics::PhysicsBody*> sample = querySample(scene.bodies);
+    Octree octree;
+    octree.setThetaSq(static_cast<Physics::Real>(state.range(2)) / Physics::Real(100));
+    octree.setQuadrupoles(state.range(3) != 0);
+    octree.build(scene.bodies);
+    for (auto _ : state) {
+        for (Physics::PhysicsBody* body : sample) {
+            benchmark::DoNotOptimize(octree.computeForce(body, 1.0));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(sample.size()));
+    state.counters["meanError"] = meanForceError(scene.bodies, [&](std::size_t i) { return octree.computeForce(scene.bodies[i], 1.0); });
+    state.SetLabel(Bench::sceneName(shapeArg(state)));
+}
+
+static void OpeningAngleArgs(benchmark::internal::Benchmark* b) {
+    for (int shape : {static_cast<int>(Bench::SceneShape::UniformCube), static_cast<int>(Bench::SceneShape::Plummer)}) {
+        for (int thetaSq : {25, 50, 100, 200}) {
+            for (int quadrupoles : {0, 1}) b->Args({shape, 100000, thetaSq, quadrupoles});
+        }
+    }
+}
+
+// Forces on every body at once, so items_per_second compares directly with BM_Octree_ComputeForce
+static void BM_FastMultipole_ComputeForces(benchmark::State& state) {
+    const Bench::Scene scene = Bench::makeScene(shapeArg(state), static_cast<std::size_t>(state.range(1)));
+    Octree octree;
+    octree.build(scene.bodies);
+    FastMultipole fmm;
+    std::vector<glm::vec3> forces;
+    for (auto _ : state) {
+        fmm.computeForces(octree, 1.0, forces);
+        benchmark::DoNotOptimize(forces.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(scene.bodies.size()));
+    state.counters["far"] = static_cast<double>(fmm.farInteractionCount());
+    state.counters["near"] = static_cast<double>(fmm.nearInteractionCount());
+    state.SetLabel(Bench::sceneName(shapeArg(state)));
+}
+
+static void BM_Octree_ComputeHeat(benchmark::State& state) {
+    const Bench::Scene scene = Bench::makeScene(shapeArg(state), static_cast<std::size_t>(state.range(1)));
+    const std::vector<Physics::PhysicsBody*> sample = querySample(scene.bodies);
+    Octree octree;
+    octree.build(scene.bodies);
+    for (auto _ : state) {
+        for (Physics::PhysicsBody* body : sample) {
+            benchmark::DoNotOptimize(octree.computeHeat(body));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(sample.size()));
+    state.SetLabel(Bench::sceneName(shapeArg(state)));
+}
+
+// Args: {LeafKernels::Level, source count}. items_per_second reports pair interactions
+
+static void BM_LeafKernel_Gravity(benchmark::State& state) {
+    ScopedKernelLevel level(state);
+    if (!level.supported) return;
+    const KernelSources sources(static_cast<std::size_t>(state.range(1)));
+    const Physics::LeafKernels::GravitySources batch{ sources.x.data(), sources.y.data(), sources.z.data(), sources.mass.data(), sources.mass.size() };
+    const Physics::Real target[3] = { Physics::Real(0.1), Physics::Real(-0.2), Physics::Real(0.3) };
+    for (auto _ : state) {
+        Physics::Real field[3] = { 0, 0, 0 };
+        Physics::LeafKernels::gravity(target, batch, static_cast<Physics::Real>(Constants::SOFTENING_SQ), field);
+        benchmark::DoNotOptimize(field);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+static void BM_LeafKernel_Radiation(benchmark::State& state) {
+    ScopedKernelLevel level(state);
+    if (!level.supported) return;
+    const KernelSources sources(static_cast<std::size_t>(state.range(1)));
+    const Physics::LeafKernels::RadiationSources batch{ sources.x.data(), sources.y.data(), sources.z.data(), sources.area.data(), sources.emission.data(), sources.area.size() };
+    const Physics::Real target[3] = { Physics::Real(0.1), Physics::Real(-0.2), Physics::Real(0.3) };
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Physics::LeafKernels::radiation(target, batch, 0.25, 0.0001));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+static void LeafKernelArgs(benchmark::internal::Benchmark* b) {
+    for (int level : {0, 1, 2}) {
+        for (int count : {64, 1024, 16384}) b->Args({level, count});
+    }
+}
+
+static void BM_BVH_Build(benchmark::State& state) {
+    const Bench::Scene scene = Bench::makeScene(shapeArg(state), static_cast<std::size_t>(state.range(1)), true);
+    BVH bvh;
+    for (auto _ : state) {
+        bvh.build(scene.bodies);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(scene.bodies.size()));
+    state.SetLabel(Bench::sceneName(shapeArg(state)));
+}
+
+static void BM_BVH_GetPotentialCollisions(benchmark::State& state) {
+    const Bench::Scene scene = Bench::makeScene(shapeArg(state), static_cast<std::size_t>(state.range(1)), true);
+    BVH bvh;
+    bvh.build(scene.bodies);
+    std::size_t pairs = 0;
+    for (auto _ : state) {
+        auto candidates = bvh.getPotentialCollisions();
+        pairs = candidates.size();
+        benchmark::DoNotOptimize(candidates.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(scene.bodies.size()));
+    state.counters["pairs"] = static_cast<double>(pairs);
+    state.SetLabel(Bench::sceneName(shapeArg(state)));
+}
+
+BENCHMARK(BM_Octree_Build)->Apply(Bench::SceneArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Octree_BuildParallel)->Apply(Bench::SceneArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Octree_ComputeForce)->Apply(Bench::SceneArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Octree_ComputeForceAccuracy)->Apply(OpeningAngleArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FastMultipole_ComputeForces)->Apply(Bench::SceneArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Octree_ComputeHeat)->Apply(Bench::SceneArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LeafKernel_Gravity)->Apply(LeafKernelArgs);
+BENCHMARK(BM_LeafKernel_Radiation)->Apply(LeafKernelArgs);
+BENCHMARK(BM_BVH_Build)->Apply(Bench::SceneArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BVH_GetPotentialCollisions)->Apply(Bench::SceneArgs)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "BenchmarkScenes.h"
+#include "physics/PhysicsSystem.h"
+#include "physics/PointMass.h"
+
+// Full PhysicsSystem::step() throughput against worker count.
+// Args: {body count, worker count}. items_per_second is steps per second.
+static void BM_Step_WorkerScaling(benchmark::State& state) {
+    const auto bodyCount = static_cast<int>(state.range(0));
+    const auto workers = static_cast<std::size_t>(state.range(1));
+
+    Physics::PhysicsSystem system(glm::vec3(0.0f));
+    system.setGravitationalConstant(1.0);
+    system.setWorkerCount(workers);
+
+    std::vector<std::unique_ptr<Physics::PointMass>> bodies;
+    bodies.reserve(bodyCount);
+    for (int i = 0; i < bodyCount; ++i) {
+        const float a = static_cast<float>(i);
+        const glm::vec3 pos(std::sin(a) * 1000.0f, std::cos(a * 1.3f) * 1000.0f, std::sin(a * 0.7f) * 1000.0f);
+        bodies.push_back(std::make_unique<Physics::PointMass>(i, 1.0 + (i % 7), pos, false));
+        system.addBody(bodies.back().get());
+    }
+
+    for (auto _ : state) {
+        system.step(0.001f);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["workers"] = static_cast<double>(system.getWorkerCount());
+}
+
+static void WorkerScalingArgs(benchmark::internal::Benchmark* b) {
+    const int maxWorkers = static_cast<int>(Physics::ThreadPool::defaultThreadCount());
+    for (int bodies : {1000, 10000}) {
+        for (int workers = 1; workers < maxWorkers; workers *= 2) {
+            b->Args({bodies, workers});
+        }
+        b->Args({bodies, maxWorkers});
+    }
+}
+
+BENCHMARK(BM_Step_WorkerScaling)->Apply(WorkerScalingArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Full PhysicsSystem::step() on the generated scenes with every worker.
+// Args: {SceneShape, body count}. items_per_second is bodies advanced per second.
+static void BM_Step_Scene(benchmark::State& state) {
+    const auto shape = static_cast<Bench::SceneShape>(state.range(0));
+    const Bench::Scene scene = Bench::makeScene(shape, static_cast<std::size_t>(state.range(1)));
+
+    Physics::PhysicsSystem system(scene.globalAcceleration);
+    system.setGravitationalConstant(1.0);
+    Physics::FrameHistoryConfig history;
+    history.windowFrames = 0;
+    history.spillToDisk = false;
+    system.setFrameHistoryConfig(history);
+    for (Physics::PhysicsBody* body : scene.bodies) system.addBody(body);
+
+    for (auto _ : state) {
+        system.step(0.001f);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(scene.bodies.size()));
+    state.SetLabel(Bench::sceneName(shape));
+}
+
+BENCHMARK(BM_Step_Scene)->Apply(Bench::SceneArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
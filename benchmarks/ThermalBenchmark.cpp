@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "physics/utils/ThermalUtils.h"
+
+// ThermalUtils::integrateTemperature over many bodies with the convection and ambient
+// radiation terms PhysicsSystem uses. Args: {body count, dt in seconds}; a long dt forces
+// many sub-steps. items_per_second is bodies per second, substeps the mean per body.
+static void BM_Thermal_IntegrateTemperature(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const auto dt = static_cast<double>(state.range(1));
+    constexpr double kMass = 10.0;
+    constexpr double kArea = 2.0;
+    constexpr double kAmbientK = 293.15;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> temperature(200.0, 400.0);
+    std::vector<ThermalProperties> initial(count);
+    for (ThermalProperties& props : initial) props.tempK = temperature(rng);
+    std::vector<ThermalProperties> working;
+
+    long long subSteps = 0;
+    for (auto _ : state) {
+        working = initial;
+        subSteps = 0;
+        for (ThermalProperties& props : working) {
+            subSteps += Physics::Thermal::integrateTemperature(props, kMass, dt, [&](double) {
+                return Physics::Thermal::convectionHeatRate(props, kArea, kAmbientK)
+                    + Physics::Thermal::ambientRadiationHeatRate(props, kArea, kAmbientK);
+            });
+        }
+        benchmark::DoNotOptimize(working.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+    state.counters["substeps"] = static_cast<double>(subSteps) / static_cast<double>(count);
+}
+
+static void ThermalArgs(benchmark::internal::Benchmark* b) {
+    for (int dt : { 1, 3600 }) {
+        for (int count = 100; count <= 1000000; count *= 10) {
+            b->Args({ count, dt });
+        }
+    }
+}
+
+BENCHMARK(BM_Thermal_IntegrateTemperature)->Apply(ThermalArgs)->Unit(benchmark::kMillisecond);
@@ -88,14 +88,9 @@ void Scene::freeObjectID(uint32_t objID) {
     freeIDs.push_back(objID);
 }
 
-void Scene::draw(const std::optional<std::vector<ObjectSnapshot>>& snaps, const std::unordered_set<uint32_t>& hoveredIDs, const std::unordered_set<uint32_t>& selectedIDs) {
-    SceneObject::PosMap renderPositions;
+void Scene::draw(const std::vector<ObjectSnapshot>* snaps, const std::unordered_set<uint32_t>& hoveredIDs, const std::unordered_set<uint32_t>& selectedIDs) {
     if (snaps) {
-        renderPositions.reserve(snaps->size());
-        for (const auto &s : *snaps) {
-            renderPositions.emplace(s.body, s.position);
-        }
-        SceneObject::setPhysicsPosMap(renderPositions);
+        SceneObject::updatePhysicsPosMap(*snaps);
     }
 
     glm::vec3 renderTargetPosition;
@@ -71,6 +71,7 @@ void SceneManager::resetScene() {
     setSimSpeed(1.0f);
     physicsSystem->setGravitationalConstant(Constants::G);
     physicsSystem->setAmbientTemperature(293.15f);
+    physicsSystem->setBlockTimestepConfig({});
     setSelectFor(nullptr);
 }
 
@@ -56,6 +56,7 @@ public:
     glm::vec3 getGlobalAcceleration() const { return physicsSystem->getGlobalAcceleration(); }
     void setGlobalAcceleration(const glm::vec3& newAcceleration) const { physicsSystem->setGlobalAcceleration(newAcceleration); }
     bool isPhysicsRunning() const { return physicsSystem->isPhysicsEnabled(); }
+    const Physics::StepProfiler& getStepProfiler() const { return physicsSystem->getProfiler(); }
     float getSimSpeed() const { return window->getSimSpeed(); }
     void setSimSpeed(float newSpeed) { window->setSimSpeed(newSpeed); physicsSystem->setSimSpeed(newSpeed); }
     void startSimulation() const { window->setRenderClockRunning(true); physicsSystem->enablePhysics(); }
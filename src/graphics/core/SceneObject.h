@@ -56,6 +56,18 @@ public:
         std::lock_guard<std::mutex> lk(posMapMutex);
         posMap = m;
     }
+    // Overwrites positions in place so the steady state does not allocate
+    static void updatePhysicsPosMap(const std::vector<ObjectSnapshot>& snapshots) {
+        std::lock_guard<std::mutex> lk(posMapMutex);
+        for (const auto& s : snapshots) {
+            posMap.insert_or_assign(s.body, s.position);
+        }
+        // A body left the set, drop its stale key
+        if (posMap.size() != snapshots.size()) {
+            posMap.clear();
+            for (const auto& s : snapshots) posMap.emplace(s.body, s.position);
+        }
+    }
 
     static void setRenderOrigin(const glm::vec3& origin) {
         std::lock_guard<std::mutex> lk(posMapMutex);
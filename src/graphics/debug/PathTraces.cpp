@@ -61,7 +61,7 @@ void PathTraces::draw() const {
         if (!body) continue;
 
         const glm::vec3 renderOrigin = SceneObject::getRenderOrigin();
-        body->withFrames(BodyLock::LOCK, [this, &points, renderOrigin](const std::vector<ObjectSnapshot>& snapshots) {
+        body->withFrames(BodyLock::LOCK, [this, &points, renderOrigin](const Physics::FrameHistory::View& snapshots) {
         if (snapshots.size() < kMinTrailPointCount) return;
 
         const float latestTime = snapshots.back().time;
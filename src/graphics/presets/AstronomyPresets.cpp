@@ -236,6 +236,11 @@ void createRealSolarSystem(SceneManager& sceneManager) {
     sceneManager.physicsSystem->setGravitationalConstant(Constants::G);
     sceneManager.setSimSpeed(1.0e6f);
 
+    // Mercury's 88-day orbit would otherwise set the step for Neptune too, let each body pick its own
+    Physics::BlockTimestepConfig blockSteps;
+    blockSteps.enabled = true;
+    sceneManager.physicsSystem->setBlockTimestepConfig(blockSteps);
+
     PointMassOptions sunOptions;
     sunOptions.base.position = glm::vec3(0.0f);
     sunOptions.base.scale = glm::vec3(static_cast<float>(sunRadiusKm * 2.0 * metersPerKm));
@@ -0,0 +1,202 @@
+#include "JsonValue.h"
+
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+
+namespace Headless {
+    class JsonParser {
+    public:
+        explicit JsonParser(std::string_view input) : src(input) {}
+
+        bool parseDocument(JsonValue& out) {
+            if (!parseValue(out, 0)) return false;
+            skipWhitespace();
+            if (pos != src.size()) return fail("trailing characters after document");
+            return true;
+        }
+
+        std::string error;
+
+    private:
+        static constexpr int kMaxDepth = 256;
+
+        std::string_view src;
+        std::size_t pos = 0;
+
+        bool fail(const char* message) {
+            if (error.empty()) error = std::string(message) + " at offset " + std::to_string(pos);
+            return false;
+        }
+
+        void skipWhitespace() {
+            while (pos < src.size() && std::isspace(static_cast<unsigned char>(src[pos]))) ++pos;
+        }
+
+        bool consume(char c) {
+            skipWhitespace();
+            if (pos < src.size() && src[pos] == c) {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+
+        bool consumeLiteral(std::string_view literal) {
+            if (src.substr(pos, literal.size()) != literal) return false;
+            pos += literal.size();
+            return true;
+        }
+
+        bool parseValue(JsonValue& out, int depth) {
+            if (depth > kMaxDepth) return fail("nesting too deep");
+            skipWhitespace();
+            if (pos >= src.size()) return fail("unexpected end of input");
+
+            const char c = src[pos];
+            if (c == '{') return parseObject(out, depth);
+            if (c == '[') return parseArray(out, depth);
+            if (c == '"') {
+                out.kind = JsonValue::Type::String;
+                return parseString(out.text);
+            }
+            if (consumeLiteral("true")) {
+                out.kind = JsonValue::Type::Bool;
+                out.boolean = true;
+                return true;
+            }
+            if (consumeLiteral("false")) {
+                out.kind = JsonValue::Type::Bool;
+                out.boolean = false;
+                return true;
+            }
+            if (consumeLiteral("null")) {
+                out.kind = JsonValue::Type::Null;
+                return true;
+            }
+            return parseNumber(out);
+        }
+
+        bool parseObject(JsonValue& out, int depth) {
+            out.kind = JsonValue::Type::Object;
+            ++pos; // '{'
+            if (consume('}')) return true;
+
+            do {
+                skipWhitespace();
+                std::string key;
+                if (pos >= src.size() || src[pos] != '"' || !parseString(key)) return fail("expected object key");
+                if (!consume(':')) return fail("expected ':'");
+
+                JsonValue value;
+                if (!parseValue(value, depth + 1)) return false;
+                out.keys.push_back(std::move(key));
+                out.values.push_back(std::move(value));
+            } while (consume(','));
+
+            return consume('}') || fail("expected '}'");
+        }
+
+        bool parseArray(JsonValue& out, int depth) {
+            out.kind = JsonValue::Type::Array;
+            ++pos; // '['
+            if (consume(']')) return true;
+
+            do {
+                JsonValue value;
+                if (!parseValue(value, depth + 1)) return false;
+                out.values.push_back(std::move(value));
+            } while (consume(','));
+
+            return consume(']') || fail("expected ']'");
+        }
+
+        bool parseString(std::string& out) {
+            ++pos; // opening quote
+            while (pos < src.size()) {
+                const char c = src[pos++];
+                if (c == '"') return true;
+                if (c != '\\') {
+                    out.push_back(c);
+                    continue;
+                }
+                if (pos >= src.size()) break;
+
+                const char esc = src[pos++];
+                switch (esc) {
+                    case '"': out.push_back('"'); break;
+                    case '\\': out.push_back('\\'); break;
+                    case '/': out.push_back('/'); break;
+                    case 'b': out.push_back('\b'); break;
+                    case 'f': out.push_back('\f'); break;
+                    case 'n': out.push_back('\n'); break;
+                    case 'r': out.push_back('\r'); break;
+                    case 't': out.push_back('\t'); break;
+                    case 'u': {
+                        if (pos + 4 > src.size()) return fail("truncated unicode escape");
+                        unsigned int code = 0;
+                        auto [ptr, ec] = std::from_chars(src.data() + pos, src.data() + pos + 4, code, 16);
+                        if (ec != std::errc() || ptr != src.data() + pos + 4) return fail("invalid unicode escape");
+                        pos += 4;
+                        // Scene files only ever contain names, encode the BMP code point as UTF-8
+                        if (code < 0x80) {
+                            out.push_back(static_cast<char>(code));
+                        } else if (code < 0x800) {
+                            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                        } else {
+                            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                        }
+                        break;
+                    }
+                    default: return fail("invalid escape sequence");
+                }
+            }
+            return fail("unterminated string");
+        }
+
+        bool parseNumber(JsonValue& out) {
+            const std::size_t start = pos;
+            if (pos < src.size() && (src[pos] == '-' || src[pos] == '+')) ++pos;
+            while (pos < src.size()) {
+                const char c = src[pos];
+                if (std::isdigit(static_cast<unsigned char>(c)) || c == '.' || c == 'e' || c == 'E' || c == '-' || c == '+') {
+                    ++pos;
+                } else {
+                    break;
+                }
+            }
+            if (pos == start) return fail("unexpected character");
+
+            const std::string token(src.substr(start, pos - start));
+            char* end = nullptr;
+            const double value = std::strtod(token.c_str(), &end);
+            if (end != token.c_str() + token.size()) return fail("invalid number");
+
+            out.kind = JsonValue::Type::Number;
+            out.number = value;
+            return true;
+        }
+    };
+}
+
+std::optional<Headless::JsonValue> Headless::JsonValue::parse(std::string_view text, std::string* error) {
+    JsonValue root;
+    JsonParser parser(text);
+    if (!parser.parseDocument(root)) {
+        if (error) *error = parser.error;
+        return std::nullopt;
+    }
+    return root;
+}
+
+const Headless::JsonValue& Headless::JsonValue::operator[](std::string_view key) const {
+    static const JsonValue kNull;
+    if (kind != Type::Object) return kNull;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == key) return values[i];
+    }
+    return kNull;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Headless {
+    /**
+     * @brief Minimal read-only JSON document used by the headless runner
+     *
+     * The editor parses scenes with QJsonDocument, which is not available to a
+     * PhysicsCore-only build. This covers exactly what scene files use: objects,
+     * arrays, numbers, strings, booleans and null. Lookups never throw; a missing
+     * key or wrong type yields a null value or the supplied fallback.
+     */
+    class JsonValue {
+    public:
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        static std::optional<JsonValue> parse(std::string_view text, std::string* error = nullptr);
+
+        Type type() const { return kind; }
+        bool isNull() const { return kind == Type::Null; }
+        bool isNumber() const { return kind == Type::Number; }
+        bool isArray() const { return kind == Type::Array; }
+        bool isObject() const { return kind == Type::Object; }
+
+        double numberOr(double fallback) const { return kind == Type::Number ? number : fallback; }
+        bool boolOr(bool fallback) const { return kind == Type::Bool ? boolean : fallback; }
+        std::string stringOr(const std::string& fallback) const { return kind == Type::String ? text : fallback; }
+
+        // Array elements (empty unless this is an array)
+        const std::vector<JsonValue>& items() const { return values; }
+
+        // Object member lookup, returns a null value if missing or not an object
+        const JsonValue& operator[](std::string_view key) const;
+        double numberOr(std::string_view key, double fallback) const { return (*this)[key].numberOr(fallback); }
+
+    private:
+        friend class JsonParser;
+
+        Type kind = Type::Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string text;
+        std::vector<std::string> keys;  // object keys, parallel to values
+        std::vector<JsonValue> values;  // array elements or object values
+    };
+}
@@ -0,0 +1,155 @@
+#include "SceneLoader.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "JsonValue.h"
+#include "physics/PointMass.h"
+#include "physics/RigidBody.h"
+#include "physics/bounding/BoxCollider.h"
+
+namespace {
+    // Positions and velocities keep every digit of the file, the body narrows them to its precision
+    glm::dvec3 toDVec3(const Headless::JsonValue& value, const glm::dvec3& fallback = glm::dvec3(0.0)) {
+        const auto& items = value.items();
+        if (!value.isArray() || items.size() != 3) return fallback;
+        if (!items[0].isNumber() || !items[1].isNumber() || !items[2].isNumber()) return fallback;
+        return { items[0].numberOr(0.0), items[1].numberOr(0.0), items[2].numberOr(0.0) };
+    }
+
+    glm::vec3 toVec3(const Headless::JsonValue& value, const glm::vec3& fallback = glm::vec3(0.0f)) {
+        return glm::vec3(toDVec3(value, glm::dvec3(fallback)));
+    }
+
+    // Same keys as JsonUtils::jsonToThermal in SceneSerializer
+    ThermalProperties toThermal(const Headless::JsonValue& obj, const ThermalProperties& fallback) {
+        ThermalProperties props = fallback;
+        props.tempK = obj.numberOr("tempK", props.tempK);
+        props.internalHeatPower = obj.numberOr("internalHeatPower", props.internalHeatPower);
+        props.externalHeatFlux = obj.numberOr("externalHeatFlux", props.externalHeatFlux);
+        props.entropyJPerK = obj.numberOr("entropyJPerK", props.entropyJPerK);
+        props.referenceTempK = static_cast<float>(obj.numberOr("referenceTempK", props.referenceTempK));
+        props.specificHeat = static_cast<float>(obj.numberOr("specificHeat", props.specificHeat));
+        props.specificHeatTempCoeff = static_cast<float>(obj.numberOr("specificHeatTempCoeff", props.specificHeatTempCoeff));
+        props.thermalMassFraction = static_cast<float>(obj.numberOr("thermalMassFraction", props.thermalMassFraction));
+        props.emissivity = static_cast<float>(obj.numberOr("emissivity", props.emissivity));
+        props.emissivityTempCoeff = static_cast<float>(obj.numberOr("emissivityTempCoeff", props.emissivityTempCoeff));
+        props.absorptivity = static_cast<float>(obj.numberOr("absorptivity", props.absorptivity));
+        props.absorptivityTempCoeff = static_cast<float>(obj.numberOr("absorptivityTempCoeff", props.absorptivityTempCoeff));
+        props.heatTransferCoeff = static_cast<float>(obj.numberOr("heatTransferCoeff", props.heatTransferCoeff));
+        props.conductivity = static_cast<float>(obj.numberOr("conductivity", props.conductivity));
+        props.conductivityTempCoeff = static_cast<float>(obj.numberOr("conductivityTempCoeff", props.conductivityTempCoeff));
+        props.density = static_cast<float>(obj.numberOr("density", props.density));
+        props.linearExpansionCoeff = static_cast<float>(obj.numberOr("linearExpansionCoeff", props.linearExpansionCoeff));
+        props.meltingPoint = static_cast<float>(obj.numberOr("meltingPoint", props.meltingPoint));
+        props.latentHeatFusion = static_cast<float>(obj.numberOr("latentHeatFusion", props.latentHeatFusion));
+        props.fusionProgress = static_cast<float>(obj.numberOr("fusionProgress", props.fusionProgress));
+        props.boilingPoint = static_cast<float>(obj.numberOr("boilingPoint", props.boilingPoint));
+        props.latentHeatVaporization = static_cast<float>(obj.numberOr("latentHeatVaporization", props.latentHeatVaporization));
+        props.vaporizationProgress = static_cast<float>(obj.numberOr("vaporizationProgress", props.vaporizationProgress));
+        return props;
+    }
+
+    // Mirrors SceneObject::buildModelMatrix
+    glm::mat4 modelMatrix(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale) {
+        glm::mat4 model(1.0f);
+        model = glm::translate(model, position);
+        model = model * glm::mat4_cast(glm::quat(rotation));
+        model = glm::scale(model, scale);
+        return model;
+    }
+
+    // prim_cube from ResourceManager::loadPrimCube
+    void setUnitCubeGeometry(Physics::RigidBody& rb) {
+        std::vector<glm::vec3> vertices = {
+            {-0.5f, -0.5f, -0.5f}, { 0.5f, -0.5f, -0.5f}, { 0.5f,  0.5f, -0.5f}, {-0.5f,  0.5f, -0.5f},
+            {-0.5f, -0.5f,  0.5f}, { 0.5f, -0.5f,  0.5f}, { 0.5f,  0.5f,  0.5f}, {-0.5f,  0.5f,  0.5f},
+        };
+        std::vector<unsigned int> indices = {
+            0, 1, 2, 0, 3, 2,
+            0, 1, 5, 0, 4, 5,
+            0, 4, 7, 0, 3, 7,
+            1, 2, 6, 1, 5, 6,
+            2, 3, 7, 2, 6, 7,
+            4, 5, 6, 4, 7, 6,
+        };
+        rb.setGeometry(vertices, indices);
+    }
+}
+
+bool Headless::loadScene(const std::string& path, Physics::PhysicsSystem& system, std::vector<LoadedBody>& bodies, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "failed to open " + path;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    std::optional<JsonValue> doc = JsonValue::parse(buffer.str(), &error);
+    if (!doc) return false;
+    if (!doc->isObject()) {
+        error = "scene root is not an object";
+        return false;
+    }
+    const JsonValue& root = *doc;
+
+    const JsonValue& settings = root["settings"];
+    if (settings.isObject()) {
+        if (settings["gravity"].isArray()) {
+            system.setGlobalAcceleration(toVec3(settings["gravity"]));
+        }
+        system.setSimSpeed(static_cast<float>(settings.numberOr("simSpeed", system.getSimSpeed())));
+        system.setGravitationalConstant(settings.numberOr("gravitationalConstant", system.getGravitationalConstant()));
+        system.setAmbientTemperature(static_cast<float>(settings.numberOr("ambientTemperature", system.getAmbientTemperature())));
+    }
+
+    for (const JsonValue& objJson : root["objects"].items()) {
+        if (!objJson.isObject()) continue;
+
+        const JsonValue& options = objJson["options"];
+        const std::string type = options["type"].stringOr("");
+        if (type != "PointMassOptions" && type != "RigidBodyOptions") continue; // no physics body
+
+        const JsonValue& data = options["data"];
+        const auto id = static_cast<uint32_t>(objJson.numberOr("id", static_cast<double>(bodies.size())));
+        const glm::dvec3 position = toDVec3(data["position"]);
+        const glm::vec3 scale = toVec3(data["scale"], glm::vec3(1.0f));
+        const glm::vec3 rotation = toVec3(data["rotation"]);
+        const bool isStatic = data["isStatic"].boolOr(false);
+        const double mass = data.numberOr("mass", 1.0);
+
+        std::unique_ptr<Physics::PhysicsBody> body;
+        if (type == "PointMassOptions") {
+            body = std::make_unique<Physics::PointMass>(id, mass, glm::vec3(position), isStatic);
+        } else {
+            auto collider = std::make_unique<Physics::Bounding::BoxCollider>(
+                glm::vec3(0.0f),
+                glm::vec3(0.5f),
+                glm::quat(1.0f, 0.0f, 0.0f, 0.0f)
+            );
+            auto rb = std::make_unique<Physics::RigidBody>(id, mass, std::move(collider), glm::vec3(position), isStatic);
+            const std::string meshName = objJson["meshName"].stringOr("");
+            if (meshName != "prim_cube") {
+                std::cerr << "[SceneLoader] Warning: rigid body mesh '" << meshName << "' approximated by a unit cube.\n";
+            }
+            setUnitCubeGeometry(*rb);
+            rb->setScale(scale);
+            body = std::move(rb);
+        }
+
+        body->setVelocityPrecise(toDVec3(data["velocity"]), BodyLock::LOCK);
+        system.addBody(body.get());
+        body->setWorldTransform(modelMatrix(glm::vec3(position), rotation, scale), BodyLock::LOCK);
+        body->setPositionPrecise(position, BodyLock::LOCK);
+        if (data["thermal"].isObject()) {
+            body->setThermalProperty(toThermal(data["thermal"], body->getThermalProperties(BodyLock::LOCK)), BodyLock::LOCK);
+        }
+
+        bodies.push_back({ objJson["name"].stringOr("Object" + std::to_string(id)), std::move(body) });
+    }
+    return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "physics/PhysicsSystem.h"
+
+namespace Headless {
+    struct LoadedBody {
+        std::string name;
+        std::unique_ptr<Physics::PhysicsBody> body;
+    };
+
+    /**
+     * @brief Loads a scene file saved by the editor (SceneSerializer) straight into a PhysicsSystem
+     *
+     * Only the physics side is restored: global settings and every PointMassOptions /
+     * RigidBodyOptions object, including thermal state. Meshes, shaders, camera and
+     * selection are ignored. Rigid bodies get the unit-cube geometry of prim_cube,
+     * which is the only collider shape the editor saves.
+     *
+     * @return false and sets error if the file can't be read or isn't a scene
+     */
+    bool loadScene(const std::string& path, Physics::PhysicsSystem& system, std::vector<LoadedBody>& bodies, std::string& error);
+}
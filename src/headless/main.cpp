@@ -0,0 +1,295 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "SceneLoader.h"
+#include "physics/PhysicsSystem.h"
+
+// Batch runner: loads a scene, steps it at a fixed dt as fast as the CPU allows
+// (no wall-clock pacing, no render thread) and streams samples to CSV files.
+
+namespace {
+    struct Options {
+        std::string scenePath;
+        std::string trajectoryPath;
+        std::string metricsPath;
+        std::string profilePath;
+        float dt = 1.0f / 1000.0f;
+        double duration = 10.0;
+        long long steps = -1; // overrides duration when set
+        long long every = 100;
+        std::size_t threads = 0;
+        int blockLevels = -1; // block timesteps off unless set
+        double tolerance = 0.0; // adaptive timesteps off unless set
+        double sleepAfter = -1.0; // sleeping off unless set
+        double fmmTheta = 0.0; // Barnes-Hut unless set
+        Physics::IntegratorType integrator = Physics::IntegratorType::VelocityVerlet;
+    };
+
+    bool parseIntegrator(const std::string& name, Physics::IntegratorType& out) {
+        using Physics::IntegratorType;
+        for (IntegratorType type : { IntegratorType::VelocityVerlet, IntegratorType::LeapfrogKDK, IntegratorType::Yoshida4,
+                                     IntegratorType::Yoshida6, IntegratorType::WisdomHolman }) {
+            if (name == Physics::integratorName(type)) {
+                out = type;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void printUsage(const char* exe) {
+        std::cerr
+            << "Usage: " << exe << " <scene.json> [options]\n"
+            << "  --dt <seconds>         fixed timestep (default 0.001)\n"
+            << "  --duration <seconds>   simulated time to run (default 10)\n"
+            << "  --steps <n>            number of steps, overrides --duration\n"
+            << "  --every <n>            write a sample every n steps (default 100)\n"
+            << "  --trajectory <file>    per-body CSV: step,time,id,name,px,py,pz,vx,vy,vz,tempK\n"
+            << "  --metrics <file>       per-sample CSV: step,time,kineticEnergy,px,py,pz,meanTempK,wallSeconds\n"
+            << "  --profile <file>       per-step CSV of phase times (ms) and counters, plus a summary on exit\n"
+            << "  --threads <n>          physics worker threads (default: all cores)\n"
+            << "  --integrator <name>    VelocityVerlet, LeapfrogKDK, Yoshida4, Yoshida6 or WisdomHolman (default: VelocityVerlet)\n"
+            << "  --block-levels <n>     per-body timesteps down to dt / 2^n (default: off)\n"
+            << "  --tolerance <rel>      error-controlled steps of at most dt, local error per step relative to how far each body moves (default: off)\n"
+            << "  --sleep <seconds>      bodies at rest this long stop being integrated until touched (default: off)\n"
+            << "  --fmm <theta>          fast multipole gravity with this opening angle, e.g. 0.6 (default: Barnes-Hut)\n";
+    }
+
+    bool parseArgs(int argc, char** argv, Options& opts) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+
+            if (arg == "-h" || arg == "--help") return false;
+            if (arg.rfind("--", 0) != 0) {
+                if (!opts.scenePath.empty()) return false;
+                opts.scenePath = arg;
+                continue;
+            }
+
+            const char* value = next();
+            if (!value) return false;
+            if (arg == "--dt") opts.dt = std::strtof(value, nullptr);
+            else if (arg == "--duration") opts.duration = std::strtod(value, nullptr);
+            else if (arg == "--steps") opts.steps = std::strtoll(value, nullptr, 10);
+            else if (arg == "--every") opts.every = std::strtoll(value, nullptr, 10);
+            else if (arg == "--trajectory") opts.trajectoryPath = value;
+            else if (arg == "--metrics") opts.metricsPath = value;
+            else if (arg == "--profile") opts.profilePath = value;
+            else if (arg == "--threads") opts.threads = static_cast<std::size_t>(std::strtoull(value, nullptr, 10));
+            else if (arg == "--block-levels") opts.blockLevels = std::atoi(value);
+            else if (arg == "--tolerance") opts.tolerance = std::strtod(value, nullptr);
+            else if (arg == "--sleep") opts.sleepAfter = std::strtod(value, nullptr);
+            else if (arg == "--fmm") opts.fmmTheta = std::strtod(value, nullptr);
+            else if (arg == "--integrator") {
+                if (!parseIntegrator(value, opts.integrator)) return false;
+            }
+            else return false;
+        }
+        return !opts.scenePath.empty() && opts.dt > 0.0f && opts.every > 0;
+    }
+
+    void writeTrajectory(std::ostream& out, long long step, double time, const std::vector<Headless::LoadedBody>& bodies) {
+        for (const auto& [name, body] : bodies) {
+            const glm::dvec3 p = body->getPositionPrecise(BodyLock::LOCK);
+            const glm::dvec3 v = body->getVelocityPrecise(BodyLock::LOCK);
+            const double tempK = body->getThermalProperties(BodyLock::LOCK).tempK;
+            out << step << ',' << time << ',' << body->getID() << ',' << name << ','
+                << p.x << ',' << p.y << ',' << p.z << ','
+                << v.x << ',' << v.y << ',' << v.z << ',' << tempK << '\n';
+        }
+    }
+
+    void writeMetrics(std::ostream& out, long long step, double time, double wallSeconds, const std::vector<Headless::LoadedBody>& bodies) {
+        double kinetic = 0.0;
+        glm::dvec3 momentum(0.0);
+        double tempSum = 0.0;
+        for (const auto& loaded : bodies) {
+            const Physics::PhysicsBody& body = *loaded.body;
+            const double mass = body.getMass(BodyLock::LOCK);
+            const glm::dvec3 v = body.getVelocityPrecise(BodyLock::LOCK);
+            tempSum += body.getThermalProperties(BodyLock::LOCK).tempK;
+            if (body.getIsStatic(BodyLock::LOCK)) continue;
+            kinetic += 0.5 * mass * glm::dot(v, v);
+            momentum += mass * v;
+        }
+        const double meanTemp = bodies.empty() ? 0.0 : tempSum / static_cast<double>(bodies.size());
+        out << step << ',' << time << ',' << kinetic << ','
+            << momentum.x << ',' << momentum.y << ',' << momentum.z << ','
+            << meanTemp << ',' << wallSeconds << '\n';
+    }
+
+    void writeProfileHeader(std::ostream& out) {
+        out << "step,totalMs";
+        for (std::size_t p = 0; p < Physics::kStepPhaseCount; ++p) out << ',' << Physics::stepPhaseName(static_cast<Physics::StepPhase>(p)) << "Ms";
+        for (std::size_t c = 0; c < Physics::kStepCounterCount; ++c) out << ',' << Physics::stepCounterName(static_cast<Physics::StepCounter>(c));
+        out << '\n';
+    }
+
+    void writeProfile(std::ostream& out, const Physics::StepProfile& profile) {
+        out << profile.step << ',' << profile.totalMilliseconds();
+        for (std::size_t p = 0; p < Physics::kStepPhaseCount; ++p) out << ',' << profile.milliseconds(static_cast<Physics::StepPhase>(p));
+        for (std::uint64_t count : profile.counters) out << ',' << count;
+        out << '\n';
+    }
+
+    // Field-wise sum of every step seen for the summary on exit, step counts the steps
+    void accumulate(Physics::StepProfile& sum, const Physics::StepProfile& profile) {
+        ++sum.step;
+        sum.totalNanos += profile.totalNanos;
+        for (std::size_t p = 0; p < Physics::kStepPhaseCount; ++p) sum.phaseNanos[p] += profile.phaseNanos[p];
+        for (std::size_t c = 0; c < Physics::kStepCounterCount; ++c) sum.counters[c] += profile.counters[c];
+    }
+
+    void printProfileSummary(std::ostream& out, const Physics::StepProfile& sum) {
+        if (sum.step == 0) return;
+        const double steps = static_cast<double>(sum.step);
+        out << "Mean per step: " << sum.totalMilliseconds() / steps << " ms\n";
+        for (std::size_t p = 0; p < Physics::kStepPhaseCount; ++p) {
+            const auto phase = static_cast<Physics::StepPhase>(p);
+            out << "  " << Physics::stepPhaseName(phase) << ": " << sum.milliseconds(phase) / steps << " ms\n";
+        }
+        for (std::size_t c = 0; c < Physics::kStepCounterCount; ++c) {
+            const auto counter = static_cast<Physics::StepCounter>(c);
+            out << "  " << Physics::stepCounterName(counter) << ": " << static_cast<double>(sum.count(counter)) / steps << "\n";
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Physics::PhysicsSystem system;
+    // The per-body frame history only feeds the editor's timeline, keep the minimum in memory
+    Physics::FrameHistoryConfig history;
+    history.windowFrames = 0;
+    history.spillToDisk = false;
+    system.setFrameHistoryConfig(history);
+
+    std::vector<Headless::LoadedBody> bodies;
+    std::string error;
+    if (!Headless::loadScene(opts.scenePath, system, bodies, error)) {
+        std::cerr << "Failed to load scene: " << error << "\n";
+        return EXIT_FAILURE;
+    }
+    if (opts.threads > 0) {
+        system.setWorkerCount(opts.threads);
+    }
+    system.setIntegrator(opts.integrator);
+    if (opts.blockLevels >= 0) {
+        Physics::BlockTimestepConfig blockSteps;
+        blockSteps.enabled = true;
+        blockSteps.maxLevel = opts.blockLevels;
+        system.setBlockTimestepConfig(blockSteps);
+    }
+    if (opts.sleepAfter >= 0.0) {
+        Physics::SleepConfig sleep;
+        sleep.enabled = true;
+        sleep.timeToSleep = static_cast<float>(opts.sleepAfter);
+        system.setSleepConfig(sleep);
+    }
+    if (opts.fmmTheta > 0.0) {
+        Physics::GravityConfig gravity;
+        gravity.solver = Physics::GravitySolver::FastMultipole;
+        gravity.fmmTheta = opts.fmmTheta;
+        system.setGravityConfig(gravity);
+    }
+    const bool adaptive = opts.tolerance > 0.0;
+    if (adaptive) {
+        Physics::AdaptiveTimestepConfig adaptiveSteps;
+        adaptiveSteps.enabled = true;
+        adaptiveSteps.relativeTolerance = opts.tolerance;
+        adaptiveSteps.maxDt = opts.dt;
+        system.setAdaptiveTimestepConfig(adaptiveSteps);
+    }
+
+    std::ofstream trajectory;
+    std::ofstream metrics;
+    if (!opts.trajectoryPath.empty()) {
+        trajectory.open(opts.trajectoryPath);
+        if (!trajectory) {
+            std::cerr << "Failed to open " << opts.trajectoryPath << "\n";
+            return EXIT_FAILURE;
+        }
+        trajectory.precision(std::numeric_limits<double>::max_digits10);
+        trajectory << "step,time,id,name,px,py,pz,vx,vy,vz,tempK\n";
+    }
+    if (!opts.metricsPath.empty()) {
+        metrics.open(opts.metricsPath);
+        if (!metrics) {
+            std::cerr << "Failed to open " << opts.metricsPath << "\n";
+            return EXIT_FAILURE;
+        }
+        metrics.precision(std::numeric_limits<double>::max_digits10);
+        metrics << "step,time,kineticEnergy,px,py,pz,meanTempK,wallSeconds\n";
+    }
+    std::ofstream profile;
+    if (!opts.profilePath.empty()) {
+        if (!Physics::StepProfiler::enabled) {
+            std::cerr << "--profile needs a build with PHYSICS_ENABLE_PROFILING=ON\n";
+            return EXIT_FAILURE;
+        }
+        profile.open(opts.profilePath);
+        if (!profile) {
+            std::cerr << "Failed to open " << opts.profilePath << "\n";
+            return EXIT_FAILURE;
+        }
+        writeProfileHeader(profile);
+    }
+    Physics::StepProfile profileSum;
+    Physics::StepProfile lastProfile;
+
+    const long long totalSteps = opts.steps >= 0
+        ? opts.steps
+        : static_cast<long long>(std::ceil(opts.duration / opts.dt - 0.5));
+    // Adaptive runs take as many steps as the tolerance needs to cover the duration
+    auto finished = [&](long long stepsRun) {
+        if (!adaptive || opts.steps >= 0) return stepsRun >= totalSteps;
+        return system.simTime >= opts.duration;
+    };
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    auto wallSeconds = [&] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    };
+    auto sample = [&](long long step) {
+        if (trajectory.is_open()) writeTrajectory(trajectory, step, system.simTime, bodies);
+        if (metrics.is_open()) writeMetrics(metrics, step, system.simTime, wallSeconds(), bodies);
+    };
+
+    sample(0);
+    long long step = 0;
+    while (!finished(step)) {
+        ++step;
+        if (adaptive) {
+            system.stepAdaptive(opts.steps >= 0 ? opts.dt : static_cast<float>(std::min<double>(opts.dt, opts.duration - system.simTime)));
+        } else {
+            system.step(opts.dt);
+        }
+        if (profile.is_open() && system.getProfiler().latest(lastProfile)) {
+            writeProfile(profile, lastProfile);
+            accumulate(profileSum, lastProfile);
+        }
+
+        if (step % opts.every == 0 || finished(step)) {
+            sample(step);
+        }
+    }
+
+    const double elapsed = wallSeconds();
+    std::cout << "Ran " << step << " steps (" << system.simTime << " s simulated) for "
+              << bodies.size() << " bodies in " << elapsed << " s wall, "
+              << (elapsed > 0.0 ? static_cast<double>(step) / elapsed : 0.0) << " steps/s\n";
+    if (profile.is_open()) printProfileSummary(std::cout, profileSum);
+    return EXIT_SUCCESS;
+}
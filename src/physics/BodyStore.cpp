@@ -0,0 +1,163 @@
+#include "physics/BodyStore.h"
+
+#include "physics/PhysicsBody.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace {
+    // Every column but owners, in checkpoint order
+    template <typename Store, typename Fn>
+    void forEachStateColumn(Store& store, Fn&& fn) {
+        fn(store.positions);
+        fn(store.velocities);
+        fn(store.netForces);
+        fn(store.forces);
+        fn(store.masses);
+        fn(store.thermals);
+        fn(store.surfaceAreas);
+        fn(store.staticFlags);
+        fn(store.derivesAreaFromDensity);
+        fn(store.worldTransforms);
+        fn(store.sleepTimers);
+        fn(store.sleepFlags);
+        fn(store.islands);
+    }
+}
+
+Physics::BodyStore::~BodyStore() {
+    // Bodies may outlive the system that stored them, hand their state back
+    std::lock_guard<std::mutex> guard(storeMutex);
+    for (Slot slot = 0; slot < owners.size(); ++slot) {
+        PhysicsBody* body = owners[slot];
+        body->local = gather(slot);
+        body->store.store(nullptr, std::memory_order_release);
+    }
+}
+
+void Physics::BodyStore::attach(PhysicsBody* body) {
+    // While detached the body's own mutex guards its state, so hold both
+    std::scoped_lock guard(body->stateMutex, storeMutex);
+    if (body->store.load(std::memory_order_relaxed) != nullptr) return;
+
+    body->slot = static_cast<Slot>(owners.size());
+    owners.push_back(body);
+    pushBack(body->local);
+    body->store.store(this, std::memory_order_release);
+}
+
+void Physics::BodyStore::detach(PhysicsBody* body) {
+    std::scoped_lock guard(body->stateMutex, storeMutex);
+    if (body->store.load(std::memory_order_relaxed) != this) return;
+
+    const Slot slot = body->slot;
+    const Slot last = static_cast<Slot>(owners.size() - 1);
+    body->local = gather(slot);
+
+    if (slot != last) {
+        scatter(slot, gather(last));
+        owners[slot] = owners[last];
+        owners[slot]->slot = slot;
+    }
+    owners.pop_back();
+    popBack();
+    body->store.store(nullptr, std::memory_order_release);
+}
+
+Physics::BodyStore::Slot Physics::BodyStore::slotOf(const PhysicsBody* body) const {
+    return body->slot;
+}
+
+Physics::BodyState Physics::BodyStore::gather(Slot slot) const {
+    BodyState state;
+    state.position = positions[slot];
+    state.velocity = velocities[slot];
+    state.netForce = netForces[slot];
+    state.forces = forces[slot];
+    state.mass = masses[slot];
+    state.thermal = thermals[slot];
+    state.surfaceArea = surfaceAreas[slot];
+    state.isStatic = staticFlags[slot];
+    state.derivesAreaFromDensity = derivesAreaFromDensity[slot];
+    state.worldTransform = worldTransforms[slot];
+    state.sleepTimer = sleepTimers[slot];
+    state.isSleeping = sleepFlags[slot];
+    state.island = islands[slot];
+    return state;
+}
+
+void Physics::BodyStore::scatter(Slot slot, const BodyState& state) {
+    positions[slot] = state.position;
+    velocities[slot] = state.velocity;
+    netForces[slot] = state.netForce;
+    forces[slot] = state.forces;
+    masses[slot] = state.mass;
+    thermals[slot] = state.thermal;
+    surfaceAreas[slot] = state.surfaceArea;
+    staticFlags[slot] = state.isStatic;
+    derivesAreaFromDensity[slot] = state.derivesAreaFromDensity;
+    worldTransforms[slot] = state.worldTransform;
+    sleepTimers[slot] = state.sleepTimer;
+    sleepFlags[slot] = state.isSleeping;
+    islands[slot] = state.island;
+}
+
+void Physics::BodyStore::pushBack(const BodyState& state) {
+    positions.push_back(state.position);
+    velocities.push_back(state.velocity);
+    netForces.push_back(state.netForce);
+    forces.push_back(state.forces);
+    masses.push_back(state.mass);
+    thermals.push_back(state.thermal);
+    surfaceAreas.push_back(state.surfaceArea);
+    staticFlags.push_back(state.isStatic);
+    derivesAreaFromDensity.push_back(state.derivesAreaFromDensity);
+    worldTransforms.push_back(state.worldTransform);
+    sleepTimers.push_back(state.sleepTimer);
+    sleepFlags.push_back(state.isSleeping);
+    islands.push_back(state.island);
+}
+
+void Physics::BodyStore::popBack() {
+    positions.pop_back();
+    velocities.pop_back();
+    netForces.pop_back();
+    forces.pop_back();
+    masses.pop_back();
+    thermals.pop_back();
+    surfaceAreas.pop_back();
+    staticFlags.pop_back();
+    derivesAreaFromDensity.pop_back();
+    worldTransforms.pop_back();
+    sleepTimers.pop_back();
+    sleepFlags.pop_back();
+    islands.pop_back();
+}
+
+std::size_t Physics::BodyStore::slotBytes() const {
+    std::size_t bytes = 0;
+    forEachStateColumn(*this, [&](const auto& column) {
+        using T = typename std::decay_t<decltype(column)>::value_type;
+        static_assert(std::is_trivially_copyable_v<T>, "checkpoints copy columns as raw bytes");
+        bytes += sizeof(T);
+    });
+    return bytes;
+}
+
+void Physics::BodyStore::capture(std::vector<std::byte>& out) const {
+    out.resize(size() * slotBytes());
+    std::byte* cursor = out.data();
+    forEachStateColumn(*this, [&](const auto& column) {
+        const std::size_t bytes = column.size() * sizeof(column[0]);
+        if (bytes) std::memcpy(cursor, column.data(), bytes);
+        cursor += bytes;
+    });
+}
+
+void Physics::BodyStore::restore(const std::byte* in) {
+    forEachStateColumn(*this, [&](auto& column) {
+        const std::size_t bytes = column.size() * sizeof(column[0]);
+        if (bytes) std::memcpy(column.data(), in, bytes);
+        in += bytes;
+    });
+}
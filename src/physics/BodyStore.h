@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "physics/ForceRegistry.h"
+#include "physics/Precision.h"
+#include "physics/ThermalProperties.h"
+
+namespace Physics {
+    class PhysicsBody;
+
+    /**
+     * @brief Hot simulation state of a single body
+     *
+     * A detached body keeps one of these inline. Once the body is attached to a
+     * BodyStore the same fields live in the store's columns instead, and the body
+     * becomes a handle (store pointer + slot) into them.
+     */
+    struct BodyState {
+        Vec3 position = Vec3(0);
+        Vec3 velocity = Vec3(0);
+        glm::vec3 netForce = glm::vec3(0.0f);
+        ForceSlots forces;
+        double mass = 1.0;
+        ThermalProperties thermal;
+        float surfaceArea = 1.0f;
+        std::uint8_t isStatic = 0;
+        std::uint8_t derivesAreaFromDensity = 0; // surface area follows mass and density (spheres)
+        glm::mat4 worldTransform = glm::mat4(1.0f);
+        float sleepTimer = 0.0f;    // seconds spent below the sleep thresholds
+        std::uint8_t isSleeping = 0;
+        std::uint32_t island = 0;   // shared by bodies that fell asleep together, 0 while awake
+    };
+
+    /**
+     * @brief Structure-of-arrays storage for every body owned by a PhysicsSystem
+     *
+     * Each column is indexed by slot, so the force, thermal and integration phases
+     * of a step can walk dense arrays instead of chasing body pointers through
+     * virtual getters. Slots are compacted on detach (swap with the last slot), so
+     * a body's slot may change while it stays attached.
+     *
+     * The store mutex guards every column and replaces the per-body mutex of all
+     * attached bodies: PhysicsBody::lockState() on an attached body locks it. One
+     * lock therefore covers a whole step instead of one lock per body.
+     */
+    class BodyStore {
+    public:
+        using Slot = std::uint32_t;
+
+        BodyStore() = default;
+        ~BodyStore();
+
+        BodyStore(const BodyStore&) = delete;
+        BodyStore& operator=(const BodyStore&) = delete;
+
+        std::unique_lock<std::mutex> lock() const { return std::unique_lock(storeMutex); }
+        std::mutex& mutex() const { return storeMutex; }
+
+        // Moves the body's inline state into a new slot / back out of its slot
+        void attach(PhysicsBody* body);
+        void detach(PhysicsBody* body);
+
+        std::size_t size() const { return owners.size(); }
+        bool empty() const { return owners.empty(); }
+
+        // Sleeping bodies are skipped by integration like static ones
+        bool isFrozen(std::size_t slot) const { return staticFlags[slot] || sleepFlags[slot]; }
+        Slot slotOf(const PhysicsBody* body) const;
+
+        // Sets the position and rebuilds the transform translation from it, so the float
+        // transform never accumulates per-step increments
+        void moveTo(std::size_t slot, const Vec3& position) {
+            positions[slot] = position;
+            worldTransforms[slot][3] = glm::vec4(glm::vec3(position), 1.0f);
+        }
+
+        BodyState gather(Slot slot) const;
+        void scatter(Slot slot, const BodyState& state);
+
+        // Raw copy of every column except owners, for checkpoints (lock held)
+        std::size_t slotBytes() const;
+        void capture(std::vector<std::byte>& out) const;
+        // in must come from capture() on a store with the same size()
+        void restore(const std::byte* in);
+
+        // Columns, all indexed by slot
+        std::vector<PhysicsBody*> owners;
+        std::vector<Vec3> positions;
+        std::vector<Vec3> velocities;
+        std::vector<glm::vec3> netForces;
+        std::vector<ForceSlots> forces;
+        std::vector<double> masses;
+        std::vector<ThermalProperties> thermals;
+        std::vector<float> surfaceAreas;
+        std::vector<std::uint8_t> staticFlags;
+        std::vector<std::uint8_t> derivesAreaFromDensity;
+        std::vector<glm::mat4> worldTransforms;
+        std::vector<float> sleepTimers;
+        std::vector<std::uint8_t> sleepFlags;
+        std::vector<std::uint32_t> islands;
+
+        // Bumped by PhysicsBody setters of anything gravity or heat depends on (position, mass,
+        // static flag, thermal state), so PhysicsSystem knows when forces it kept went stale (lock held)
+        std::uint64_t edits = 0;
+
+    private:
+        void pushBack(const BodyState& state);
+        void popBack();
+
+        mutable std::mutex storeMutex;
+    };
+}
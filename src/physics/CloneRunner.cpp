@@ -0,0 +1,26 @@
+#include "CloneRunner.h"
+
+#include "physics/PhysicsSystem.h"
+
+Physics::CloneRunner& Physics::CloneRunner::shared() {
+    static CloneRunner runner;
+    return runner;
+}
+
+std::vector<std::size_t> Physics::CloneRunner::run(const std::vector<PhysicsSystem*>& clones, float dt, const StopCondition& stop, std::size_t maxSteps) {
+    std::vector<std::size_t> steps(clones.size(), 0);
+    forEach(clones.size(), [&](std::size_t i) {
+        PhysicsSystem& clone = *clones[i];
+        while (steps[i] < maxSteps && !(stop && stop(clone, i))) {
+            clone.step(dt);
+            ++steps[i];
+        }
+    });
+    return steps;
+}
+
+void Physics::CloneRunner::forEach(std::size_t count, const std::function<void(std::size_t)>& fn) {
+    pool.parallelFor(count, 1, [&fn](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) fn(i);
+    });
+}
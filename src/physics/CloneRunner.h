@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "physics/utils/ThreadPool.h"
+
+namespace Physics {
+    class PhysicsSystem;
+
+    /**
+     * @brief Steps independent PhysicsSystem clones side by side on one shared pool
+     *
+     * Every clone runs start to finish on a single worker, so a batch of N small
+     * what-if scenes keeps up to N cores busy. The pool is separate from the live
+     * system's, so previews, solvers and ensembles can branch while the live scene
+     * keeps stepping. Concurrent run() calls from several threads queue up.
+     */
+    class CloneRunner {
+    public:
+        // Checked before every step of a clone, index is its position in the batch
+        using StopCondition = std::function<bool(const PhysicsSystem& clone, std::size_t index)>;
+
+        /**
+         * @param threadCount Total workers including the caller; 0 picks the hardware concurrency
+         */
+        explicit CloneRunner(std::size_t threadCount = 0) : pool(threadCount) {}
+
+        // Process-wide runner sized to the hardware
+        static CloneRunner& shared();
+
+        std::size_t size() const { return pool.size(); }
+
+        /**
+         * @brief Steps each clone with dt until stop holds or maxSteps steps have run, blocks until all are done
+         * @return Steps taken per clone
+         */
+        std::vector<std::size_t> run(const std::vector<PhysicsSystem*>& clones, float dt, const StopCondition& stop, std::size_t maxSteps);
+
+        // Runs fn(i) for every i in [0, count), one index per task, for custom per-clone work
+        void forEach(std::size_t count, const std::function<void(std::size_t)>& fn);
+
+    private:
+        ThreadPool pool;
+    };
+}
@@ -0,0 +1,63 @@
+#include "ForceRegistry.h"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+namespace {
+    struct Table {
+        std::mutex mutex;
+        std::array<std::string, Physics::ForceRegistry::kMaxForces> names;
+        std::atomic<std::size_t> count{0};
+
+        Table() {
+            names[Physics::ForceRegistry::Gravity] = "Gravity";
+            names[Physics::ForceRegistry::Normal] = "Normal";
+            count.store(2, std::memory_order_release);
+        }
+
+        // Caller holds mutex
+        std::optional<Physics::ForceId> lookup(const std::string& name) const {
+            const std::size_t n = count.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (names[i] == name) return static_cast<Physics::ForceId>(i);
+            }
+            return std::nullopt;
+        }
+    };
+
+    Table& table() {
+        static Table instance;
+        return instance;
+    }
+}
+
+std::optional<Physics::ForceId> Physics::ForceRegistry::intern(const std::string& name) {
+    Table& t = table();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (auto id = t.lookup(name)) return id;
+
+    const std::size_t n = t.count.load(std::memory_order_relaxed);
+    if (n == kMaxForces) {
+        std::cerr << "[ForceRegistry] Warning: too many force kinds, ignoring '" << name << "'.\n";
+        return std::nullopt;
+    }
+    t.names[n] = name;
+    // Published after the name so name() can read it without the lock
+    t.count.store(n + 1, std::memory_order_release);
+    return static_cast<ForceId>(n);
+}
+
+std::optional<Physics::ForceId> Physics::ForceRegistry::find(const std::string& name) {
+    Table& t = table();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    return t.lookup(name);
+}
+
+const std::string& Physics::ForceRegistry::name(ForceId id) {
+    return table().names[id];
+}
+
+std::size_t Physics::ForceRegistry::count() {
+    return table().count.load(std::memory_order_acquire);
+}
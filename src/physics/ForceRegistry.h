@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <glm/glm.hpp>
+
+namespace Physics {
+    using ForceId = std::uint8_t;
+
+    /**
+     * @brief Process-wide table interning force names into small integer IDs
+     *
+     * Names are interned once (at setup, or the first time a string-keyed setForce
+     * sees them) and the step loop then addresses forces by ID. IDs are never
+     * reused, so there can be at most kMaxForces distinct force kinds. Names are
+     * kept for the inspector.
+     */
+    class ForceRegistry {
+    public:
+        static constexpr std::size_t kMaxForces = 32;
+
+        static constexpr ForceId Gravity = 0;
+        static constexpr ForceId Normal = 1;
+
+        /// Returns the ID for name, registering it if needed. Empty if the table is full
+        static std::optional<ForceId> intern(const std::string& name);
+        /// Returns the ID for name without registering it
+        static std::optional<ForceId> find(const std::string& name);
+        static const std::string& name(ForceId id);
+        static std::size_t count();
+    };
+
+    /**
+     * @brief Fixed inline per-body force storage indexed by ForceId
+     *
+     * A force counts as present once it has been set, even to zero, which matches
+     * the old map semantics the inspector relies on.
+     */
+    struct ForceSlots {
+        std::array<glm::vec3, ForceRegistry::kMaxForces> values;
+        std::uint32_t present = 0;
+
+        ForceSlots() { values.fill(glm::vec3(0.0f)); }
+
+        static_assert(ForceRegistry::kMaxForces <= 32, "present mask holds one bit per force");
+
+        bool has(ForceId id) const { return (present >> id) & 1u; }
+    };
+}
@@ -1,14 +1,139 @@
 #include "physics/PhysicsBody.h"
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
 #include <iostream>
 #include "physics/utils/ThermalUtils.h"
 
+Physics::PhysicsBody::~PhysicsBody() {
+    // Safety net for bodies destroyed without being removed from their system
+    if (BodyStore* attached = store.load(std::memory_order_acquire))
+        attached->detach(this);
+}
+
+std::unique_lock<std::mutex> Physics::PhysicsBody::lockState() const {
+    // The guarding mutex changes on attach/detach, retry if it moved under us
+    for (;;) {
+        BodyStore* attached = store.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> guard(attached ? attached->mutex() : stateMutex);
+        if (store.load(std::memory_order_acquire) == attached) return guard;
+    }
+}
+
+Physics::Vec3& Physics::PhysicsBody::positionRef() {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->positions[slot] : local.position;
+}
+
+const Physics::Vec3& Physics::PhysicsBody::positionRef() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->positions[slot] : local.position;
+}
+
+Physics::Vec3& Physics::PhysicsBody::velocityRef() {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->velocities[slot] : local.velocity;
+}
+
+const Physics::Vec3& Physics::PhysicsBody::velocityRef() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->velocities[slot] : local.velocity;
+}
+
+glm::vec3& Physics::PhysicsBody::netForceRef() {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->netForces[slot] : local.netForce;
+}
+
+const glm::vec3& Physics::PhysicsBody::netForceRef() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->netForces[slot] : local.netForce;
+}
+
+Physics::ForceSlots& Physics::PhysicsBody::forcesRef() {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->forces[slot] : local.forces;
+}
+
+const Physics::ForceSlots& Physics::PhysicsBody::forcesRef() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->forces[slot] : local.forces;
+}
+
+double& Physics::PhysicsBody::massRef() {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->masses[slot] : local.mass;
+}
+
+const double& Physics::PhysicsBody::massRef() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->masses[slot] : local.mass;
+}
+
+ThermalProperties& Physics::PhysicsBody::thermalRef() {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->thermals[slot] : local.thermal;
+}
+
+const ThermalProperties& Physics::PhysicsBody::thermalRef() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->thermals[slot] : local.thermal;
+}
+
+std::uint8_t& Physics::PhysicsBody::staticRef() {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->staticFlags[slot] : local.isStatic;
+}
+
+const std::uint8_t& Physics::PhysicsBody::staticRef() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->staticFlags[slot] : local.isStatic;
+}
+
+glm::mat4& Physics::PhysicsBody::worldTransformRef() {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->worldTransforms[slot] : local.worldTransform;
+}
+
+const glm::mat4& Physics::PhysicsBody::worldTransformRef() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->worldTransforms[slot] : local.worldTransform;
+}
+
+std::uint8_t& Physics::PhysicsBody::sleepRef() {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->sleepFlags[slot] : local.isSleeping;
+}
+
+const std::uint8_t& Physics::PhysicsBody::sleepRef() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->sleepFlags[slot] : local.isSleeping;
+}
+
+void Physics::PhysicsBody::countEdit() {
+    if (BodyStore* attached = store.load(std::memory_order_relaxed)) ++attached->edits;
+}
+
+float Physics::PhysicsBody::getSurfaceArea() const {
+    const BodyStore* attached = store.load(std::memory_order_relaxed);
+    return attached ? attached->surfaceAreas[slot] : local.surfaceArea;
+}
+
+void Physics::PhysicsBody::setSurfaceArea(float area) {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    (attached ? attached->surfaceAreas[slot] : local.surfaceArea) = area;
+}
+
+void Physics::PhysicsBody::setDerivesAreaFromDensity(bool flag) {
+    BodyStore* attached = store.load(std::memory_order_relaxed);
+    (attached ? attached->derivesAreaFromDensity[slot] : local.derivesAreaFromDensity) = flag ? 1 : 0;
+}
+
 bool Physics::PhysicsBody::isUnknown(const std::string &key, BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
     return unknowns.find(key) != unknowns.end();
 }
@@ -16,7 +141,7 @@ bool Physics::PhysicsBody::isUnknown(const std::string &key, BodyLock lock) cons
 void Physics::PhysicsBody::setUnknown(const std::string &key, bool active, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
     if (active) {
         unknowns.insert(key);
@@ -25,91 +150,144 @@ void Physics::PhysicsBody::setUnknown(const std::string &key, bool active, BodyL
     }
 }
 
-void Physics::PhysicsBody::setForce(const std::string &name, const glm::vec3 &force, BodyLock lock) {
+void Physics::PhysicsBody::setForce(ForceId id, const glm::vec3 &force, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
-
-    // Recalculate net force
-    auto it = forces.find(name);
-    if (it != forces.end()) {
-        // Its old value we remove it
-        netForce -= it->second;
-        it->second = force;
-    } else {
-        forces[name] = force;
+        maybeLock = lockState();
+
+    ForceSlots& forces = forcesRef();
+    glm::vec3& slot = forces.values[id];
+    if (force != slot) sleepRef() = 0;
+    slot = force;
+    forces.present |= 1u << id;
+
+    // Re-sum the set slots in id order: a running float total of the changes would drift,
+    // leaving a phantom force once every slot is cleared
+    glm::dvec3 net(0.0);
+    for (std::uint32_t mask = forces.present; mask; mask &= mask - 1) {
+        net += glm::dvec3(forces.values[std::countr_zero(mask)]);
     }
-    // Just add new force
-    netForce += force;
+    netForceRef() = glm::vec3(net);
 }
 
-glm::vec3 Physics::PhysicsBody::getForce(const std::string &name, BodyLock lock) const {
+glm::vec3 Physics::PhysicsBody::getForce(ForceId id, BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
+
+    return forcesRef().values[id]; // zero if never set
+}
 
-    auto it = forces.find(name);
-    if (it == forces.end()) {
-        return glm::vec3(0.0f); // Return zero vector if key doesn't exist
+void Physics::PhysicsBody::setForce(const std::string &name, const glm::vec3 &force, BodyLock lock) {
+    if (auto id = ForceRegistry::intern(name)) {
+        setForce(*id, force, lock);
     }
+}
 
-    return forces.find(name)->second;
+glm::vec3 Physics::PhysicsBody::getForce(const std::string &name, BodyLock lock) const {
+    auto id = ForceRegistry::find(name);
+    return id ? getForce(*id, lock) : glm::vec3(0.0f);
 }
 
 std::map<std::string, glm::vec3> Physics::PhysicsBody::getAllForces(BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
-
-    return forces;
+        maybeLock = lockState();
+
+    const ForceSlots& forces = forcesRef();
+    std::map<std::string, glm::vec3> named;
+    for (std::size_t id = 0; id < ForceRegistry::kMaxForces; ++id) {
+        if (forces.has(static_cast<ForceId>(id))) {
+            named.emplace(ForceRegistry::name(static_cast<ForceId>(id)), forces.values[id]);
+        }
+    }
+    return named;
 }
 
 glm::vec3 Physics::PhysicsBody::getNetForce(BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    return netForce;
+    return netForceRef();
 }
 
 glm::vec3 Physics::PhysicsBody::getPosition(BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    return position;
+    return glm::vec3(positionRef());
 }
 
 void Physics::PhysicsBody::setPosition(const glm::vec3 &pos, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    position = pos;
+    positionRef() = Vec3(pos);
+    sleepRef() = 0;
+    countEdit();
 }
 
 glm::vec3 Physics::PhysicsBody::getVelocity(BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    return velocity;
+    return glm::vec3(velocityRef());
 }
 
 void Physics::PhysicsBody::setVelocity(const glm::vec3 &vel, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
+
+    velocityRef() = Vec3(vel);
+    sleepRef() = 0;
+}
+
+glm::dvec3 Physics::PhysicsBody::getPositionPrecise(BodyLock lock) const {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
 
-    velocity = vel;
+    return glm::dvec3(positionRef());
+}
+
+void Physics::PhysicsBody::setPositionPrecise(const glm::dvec3& pos, BodyLock lock) {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
+
+    positionRef() = Vec3(pos);
+    sleepRef() = 0;
+    countEdit();
+}
+
+glm::dvec3 Physics::PhysicsBody::getVelocityPrecise(BodyLock lock) const {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
+
+    return glm::dvec3(velocityRef());
+}
+
+void Physics::PhysicsBody::setVelocityPrecise(const glm::dvec3& vel, BodyLock lock) {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
+
+    velocityRef() = Vec3(vel);
+    sleepRef() = 0;
 }
 
 double Physics::PhysicsBody::getMass(BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    return mass;
+    return massRef();
 }
 
 void Physics::PhysicsBody::setMass(double newMass, BodyLock lock) {
@@ -120,55 +298,100 @@ void Physics::PhysicsBody::setMass(double newMass, BodyLock lock) {
 
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
-    mass = newMass;
+        maybeLock = lockState();
+    massRef() = newMass;
+    sleepRef() = 0;
+    countEdit();
 }
 
 bool Physics::PhysicsBody::getIsStatic(BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    return isStatic;
+    return staticRef() != 0;
 }
 
 void Physics::PhysicsBody::setIsStatic(bool flag, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    isStatic = flag;
+    staticRef() = flag ? 1 : 0;
+    sleepRef() = 0;
+    countEdit();
+}
+
+bool Physics::PhysicsBody::isSleeping(BodyLock lock) const {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
+
+    return sleepRef() != 0;
 }
 
 glm::mat4 Physics::PhysicsBody::getWorldTransform(BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    return worldMatrix;
+    return worldTransformRef();
 }
 
 void Physics::PhysicsBody::setWorldTransform(const glm::mat4 &M, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    worldMatrix = M;
+    worldTransformRef() = M;
 }
 
 void Physics::PhysicsBody::clearAllFrames(BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
     frames.clear();
 }
 
+void Physics::PhysicsBody::copyStateFrom(const PhysicsBody& source) {
+    const BodyStore* attached = source.store.load(std::memory_order_relaxed);
+    local = attached ? attached->gather(source.slot) : source.local;
+    unknowns = source.unknowns;
+}
+
+void Physics::PhysicsBody::copyFramesFrom(const PhysicsBody& source, BodyLock lock) {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
+
+    frames.assign(source.frames);
+}
+
+void Physics::PhysicsBody::truncateFrames(std::size_t recordedCount, BodyLock lock) {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
+
+    frames.truncate(recordedCount);
+}
+
+void Physics::PhysicsBody::configureFrameHistory(std::size_t windowFrames, std::shared_ptr<FrameSpillFile> spill, BodyLock lock) {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
+
+    frames.configure(windowFrames, std::move(spill));
+}
+
 void Physics::PhysicsBody::setThermalProperty(const ThermalProperties &newProps, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
+    sleepRef() = 0;
+    countEdit();
+    ThermalProperties& thermalProps = thermalRef();
     thermalProps = newProps;
     thermalProps.tempK = Physics::Thermal::clampTemperature(thermalProps.tempK);
     if (!std::isfinite(thermalProps.internalHeatPower)) thermalProps.internalHeatPower = 0.0;
@@ -198,7 +421,7 @@ void Physics::PhysicsBody::setThermalProperty(const ThermalProperties &newProps,
 ThermalProperties Physics::PhysicsBody::getThermalProperties(BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    return thermalProps;
+    return thermalRef();
 }
@@ -5,10 +5,14 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <unordered_set>
 
+#include "physics/BodyStore.h"
+#include "physics/ForceRegistry.h"
 #include "physics/ThermalProperties.h"
+#include "physics/history/FrameHistory.h"
 
 class ICollider;
 
@@ -31,30 +35,30 @@ constexpr BodyLock operator!(BodyLock lock) {
     return (lock == BodyLock::LOCK) ? BodyLock::NOLOCK : BodyLock::LOCK;
 }
 
-struct ObjectSnapshot {
-    Physics::PhysicsBody* body;
-    float time;
-    glm::vec3 position;
-    glm::vec3 velocity;
-    float temperature;
-};
-
 namespace Physics {
     class PhysicsBody {
     public:
         PhysicsBody() = delete;
-        virtual ~PhysicsBody() = default;
+        virtual ~PhysicsBody();
 
         virtual void step(float dt, BodyLock lock) = 0;
         virtual void recordFrame(float t, BodyLock lock) = 0;
         virtual void loadFrame(const ObjectSnapshot& snapshot, BodyLock lock) = 0;
 
-        std::unique_lock<std::mutex> lockState() const { return std::unique_lock(stateMutex); }
+        // Detached deep copy with the same id, state, forces and collider. Frames are not copied
+        virtual std::unique_ptr<PhysicsBody> clone(BodyLock lock) const = 0;
+
+        // Locks the body's own mutex, or the store mutex while attached to a BodyStore
+        std::unique_lock<std::mutex> lockState() const;
+        bool isAttached() const { return store.load(std::memory_order_acquire) != nullptr; }
 
         uint32_t getID() const { return id; }
         bool isUnknown(const std::string& key, BodyLock lock) const;
         void setUnknown(const std::string& key, bool active, BodyLock lock);
 
+        // Hot path, no lookup or allocation. The string overloads intern the name first
+        void setForce(ForceId id, const glm::vec3& force, BodyLock lock);
+        glm::vec3 getForce(ForceId id, BodyLock lock) const;
         void setForce(const std::string& name, const glm::vec3& force, BodyLock lock);
         glm::vec3 getForce(const std::string& name, BodyLock lock) const;
         glm::vec3 getNetForce(BodyLock lock) const;
@@ -64,18 +68,30 @@ namespace Physics {
         void setPosition(const glm::vec3& pos, BodyLock lock);
         glm::vec3 getVelocity(BodyLock lock) const;
         void setVelocity(const glm::vec3& vel, BodyLock lock);
+        // Full-precision state, exact in a PHYSICS_DOUBLE_PRECISION build
+        glm::dvec3 getPositionPrecise(BodyLock lock) const;
+        void setPositionPrecise(const glm::dvec3& pos, BodyLock lock);
+        glm::dvec3 getVelocityPrecise(BodyLock lock) const;
+        void setVelocityPrecise(const glm::dvec3& vel, BodyLock lock);
         virtual double getMass(BodyLock lock) const;
         virtual void setMass(double newMass, BodyLock lock);
         virtual ThermalProperties getThermalProperties(BodyLock lock) const;
         virtual void setThermalProperty(const ThermalProperties& newProps, BodyLock lock);
-        float getSurfaceArea() const { return surfaceArea; }
+        float getSurfaceArea() const;
         bool getIsStatic(BodyLock lock) const;
         void setIsStatic(bool newStatic, BodyLock lock);
+        // Put to sleep by PhysicsSystem when at rest. Any setter of state, mass or forces wakes the body
+        bool isSleeping(BodyLock lock) const;
 
         glm::mat4 getWorldTransform(BodyLock lock) const;
         void setWorldTransform(const glm::mat4& M, BodyLock lock);
         void setGlobalAccelerationRef(std::atomic<glm::vec3>& globalAccRef) { globalAccelPtr = &globalAccRef; }
         void clearAllFrames(BodyLock lock);
+        void truncateFrames(std::size_t recordedCount, BodyLock lock); // see FrameHistory::truncate
+        void copyFramesFrom(const PhysicsBody& source, BodyLock lock); // caller must hold lockState() on source
+        void configureFrameHistory(std::size_t windowFrames, std::shared_ptr<FrameSpillFile> spill, BodyLock lock);
+
+        // fn receives a FrameHistory::View, valid only for the duration of the call
 
         template <typename F>
         void withFrames(BodyLock lock, F&& fn) const;
@@ -93,32 +109,53 @@ namespace Physics {
     protected:
         explicit PhysicsBody(uint32_t _id) : id(_id) {}
 
-        mutable std::mutex stateMutex;
-        std::vector<ObjectSnapshot> frames;
-        float surfaceArea = 1.0f;
+        // Caller must hold lockState() on source, this must be a fresh detached body
+        void copyStateFrom(const PhysicsBody& source);
+
+        // Caller must hold lockState()
+        void setSurfaceArea(float area);
+        void setDerivesAreaFromDensity(bool flag);
+
+        FrameHistory frames;
     private:
-        bool isStatic = false;
-        uint32_t id;
+        friend class BodyStore;
+
+        // Resolve to the store column while attached, the inline state otherwise
+        Vec3& positionRef();
+        const Vec3& positionRef() const;
+        Vec3& velocityRef();
+        const Vec3& velocityRef() const;
+        glm::vec3& netForceRef();
+        const glm::vec3& netForceRef() const;
+        double& massRef();
+        const double& massRef() const;
+        ThermalProperties& thermalRef();
+        const ThermalProperties& thermalRef() const;
+        std::uint8_t& staticRef();
+        const std::uint8_t& staticRef() const;
+        glm::mat4& worldTransformRef();
+        const glm::mat4& worldTransformRef() const;
+        std::uint8_t& sleepRef();
+        const std::uint8_t& sleepRef() const;
+        void countEdit(); // see BodyStore::edits
+        ForceSlots& forcesRef();
+        const ForceSlots& forcesRef() const;
 
-        glm::vec3 position = glm::vec3(0.0f);
-        glm::vec3 velocity = glm::vec3(0.0f);
-        glm::vec3 netForce = glm::vec3(0.0f);
-        std::map<std::string, glm::vec3> forces;
+        mutable std::mutex stateMutex;
+        std::atomic<BodyStore*> store{nullptr};
+        BodyStore::Slot slot = 0;
+        BodyState local;
 
+        uint32_t id;
         std::unordered_set<std::string> unknowns;
-
-        glm::mat4 worldMatrix = glm::mat4(1.0f);
         std::atomic<glm::vec3>* globalAccelPtr = nullptr;
-
-        double mass = 1.0;
-        ThermalProperties thermalProps;
     };
 
     template <typename F>
     void PhysicsBody::withFrames(BodyLock lock, F&& fn) const {
         std::unique_lock<std::mutex> maybeLock;
         if (lock == BodyLock::LOCK)
-            maybeLock = std::unique_lock<std::mutex>(stateMutex);
-        std::forward<F>(fn)(frames);
+            maybeLock = lockState();
+        std::forward<F>(fn)(frames.view(const_cast<PhysicsBody*>(this)));
     }
 }
@@ -2,6 +2,8 @@
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <glm/gtc/matrix_transform.hpp>
 #include "PointMass.h"
 #include "physics/utils/ThermalUtils.h"
 
@@ -9,7 +11,18 @@ namespace Physics {
     class PointMass;
 }
 
-Physics::PhysicsSystem::PhysicsSystem(const glm::vec3 &globalAccel) : globalAcceleration(globalAccel), router(*this) {}
+namespace {
+    // Bodies per work chunk. Tree walks are expensive enough to split finely,
+    // the integrator is a handful of flops and only pays off in big chunks.
+    constexpr std::size_t kTreeQueryGrain = 16;
+    constexpr std::size_t kIntegrateGrain = 512;
+    // Block sub-steps where at most this share of the bodies closes refit the octree instead of rebuilding it
+    constexpr std::size_t kRefitDueFraction = 4;
+}
+
+Physics::PhysicsSystem::PhysicsSystem(const glm::vec3 &globalAccel, std::size_t workerCount) : globalAcceleration(globalAccel), router(*this), pool(std::make_shared<ThreadPool>(workerCount)),
+    integrator(makeIntegrator(integratorType)),
+    historySpill(std::make_shared<FrameSpillFile>(historyConfig.spillDirectory, historyConfig.maxSpillBytes)) {}
 
 Physics::PhysicsSystem::~PhysicsSystem() {
     stop();
@@ -34,64 +47,32 @@ void Physics::PhysicsSystem::waitForStop() {
 Physics::PhysicsBody* Physics::PhysicsSystem::getBodyById(uint32_t id) const {
     std::lock_guard<std::mutex> lock(bodiesMutex);
 
-    for (PhysicsBody* body : bodies) {
+    for (PhysicsBody* body : store.owners) {
         if (body->getID() == id) return body;
     }
     return nullptr;
 }
 
-std::optional<std::vector<ObjectSnapshot>> Physics::PhysicsSystem::fetchLatestSnapshot(float renderSimTime) {
-    if (!snapshotReady.load(std::memory_order_acquire))
-        return std::nullopt;
-
-    std::lock_guard<std::mutex> lk(snapshotMutex);
-
-    if (currentSnapshots.empty()) {
-        return std::nullopt;
-    }
-
-    if (previousSnapshots.empty() || previousSnapshots.size() != currentSnapshots.size()) {
-        return currentSnapshots;
-    }
-
-    float t0 = previousSnapshots[0].time;
-    float t1 = currentSnapshots[0].time;
-
-    if (!std::isfinite(t0) || !std::isfinite(t1) || t1 <= t0) {
-        return currentSnapshots;
-    }
-
-    if (renderSimTime <= t0) {
-        return previousSnapshots;
-    }
-    if (renderSimTime >= t1) {
-        return currentSnapshots;
+void Physics::PhysicsSystem::setFrameHistoryConfig(const FrameHistoryConfig& config) {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    historyConfig = config;
+    historySpill = config.spillToDisk
+        ? std::make_shared<FrameSpillFile>(config.spillDirectory, config.maxSpillBytes)
+        : nullptr;
+
+    auto storeLock = store.lock();
+    for (PhysicsBody* body : store.owners) {
+        body->configureFrameHistory(historyConfig.windowFrames, historySpill, BodyLock::NOLOCK);
     }
+}
 
-    float alpha = (renderSimTime - t0) / (t1 - t0);
-
-    std::vector<ObjectSnapshot> out;
-    out.reserve(currentSnapshots.size());
-    for (size_t i = 0; i < currentSnapshots.size(); ++i) {
-        const auto &A = previousSnapshots[i];
-        const auto &B = currentSnapshots[i];
-
-        if (A.body != B.body) {
-            out.push_back(B);
-            continue;
-        }
-
-        ObjectSnapshot C;
-        C.body     = A.body;
-        C.time     = renderSimTime;
-        C.position = glm::mix(A.position, B.position, alpha);
-        C.velocity = glm::mix(A.velocity, B.velocity, alpha);
-        C.temperature = glm::mix(A.temperature, B.temperature, alpha);
-
-        out.push_back(C);
-    }
+Physics::FrameHistoryConfig Physics::PhysicsSystem::getFrameHistoryConfig() const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    return historyConfig;
+}
 
-    return out;
+bool Physics::PhysicsSystem::fetchLatestSnapshot(float renderSimTime, std::vector<ObjectSnapshot>& out) {
+    return snapshots.read(renderSimTime, snapshotEpoch.load(std::memory_order_acquire), out);
 }
 
 void Physics::PhysicsSystem::physicsLoop() {
@@ -115,10 +96,25 @@ void Physics::PhysicsSystem::physicsLoop() {
 
         accumulator += frameTime * getSimSpeed();
 
-        std::vector<ObjectSnapshot> localSnaps;
         {
             std::lock_guard<std::mutex> lock(bodiesMutex);
-            if (accumulator >= kBaseDt) {
+            if (stepSizeController.getConfig().enabled) {
+                // The tolerance sizes each step and the owed sim time caps it, so the scene never runs ahead of
+                // simSpeed. Owed time below kBaseDt waits, unless the tolerance wants steps that small anyway
+                int stepsRun = 0;
+                while (stepsRun < kMaxCatchUpSteps && accumulator >= std::min(stepSizeController.proposed(), kBaseDt)) {
+                    ++stepsRun;
+                    if (stepAdaptive(accumulator)) {
+                        accumulator = 0.0f;
+                        break;
+                    }
+                    accumulator -= std::min(lastStepDt, accumulator);
+                }
+                // Falling behind simSpeed is preferred to taking steps coarser than the tolerance allows
+                if (stepsRun == kMaxCatchUpSteps && accumulator >= kBaseDt) {
+                    accumulator = 0.0f;
+                }
+            } else if (accumulator >= kBaseDt) {
                 const int neededSteps = static_cast<int>(std::ceil(accumulator / kBaseDt));
                 const int stepsToRun = std::max(1, std::min(neededSteps, kMaxCatchUpSteps));
                 const float dt = std::min(std::max(accumulator / static_cast<float>(stepsToRun), kBaseDt), kMaxAdaptiveDt);
@@ -136,154 +132,761 @@ void Physics::PhysicsSystem::physicsLoop() {
                 }
             }
 
-            localSnaps.reserve(bodies.size());
-            for (auto* body : bodies) {
-                localSnaps.push_back({ body,simTime, body->getPosition(BodyLock::LOCK), body->getVelocity(BodyLock::LOCK), static_cast<float>(body->getThermalProperties(BodyLock::LOCK).tempK) });
+            std::vector<ObjectSnapshot>& frame = snapshots.beginWrite();
+            {
+                auto storeLock = store.lock();
+                for (BodyStore::Slot i = 0; i < store.size(); ++i) {
+                    frame.push_back({ store.owners[i], static_cast<float>(simTime), glm::vec3(store.positions[i]), glm::vec3(store.velocities[i]), static_cast<float>(store.thermals[i].tempK) });
+                }
             }
-
-            std::lock_guard<std::mutex> lk(snapshotMutex);
-            previousSnapshots = std::move(currentSnapshots);
-            currentSnapshots = std::move(localSnaps);
-            snapshotReady.store(true, std::memory_order_release);
+            snapshots.publish(snapshotEpoch.load(std::memory_order_relaxed));
         }
     }
 }
 
 void Physics::PhysicsSystem::addBody(PhysicsBody *body) {
     std::lock_guard<std::mutex> lock(bodiesMutex);
-    body->setForce("Gravity", static_cast<float>(body->getMass(BodyLock::LOCK)) * getGlobalAcceleration(), BodyLock::LOCK);
-    body->setForce("Normal", glm::vec3(0.0f), BodyLock::LOCK);
-    bodies.push_back(body);
+    body->setForce(ForceRegistry::Gravity, static_cast<float>(body->getMass(BodyLock::LOCK)) * getGlobalAcceleration(), BodyLock::LOCK);
+    body->setForce(ForceRegistry::Normal, glm::vec3(0.0f), BodyLock::LOCK);
+    body->configureFrameHistory(historyConfig.windowFrames, historySpill, BodyLock::LOCK);
+    store.attach(body);
+    blockStateStale = true;
 }
 
 void Physics::PhysicsSystem::removeBody(PhysicsBody *body) {
     std::lock_guard<std::mutex> lock(bodiesMutex);
-    auto it = std::remove(bodies.begin(), bodies.end(), body);
-    if (it != bodies.end()) {
-        bodies.erase(it, bodies.end());
+    auto it = std::find(store.owners.begin(), store.owners.end(), body);
+    if (it != store.owners.end()) {
+        store.detach(body);
+        blockStateStale = true;
+        sleepStateStale = true;
         resetState.erase(body);
-        {
-            std::lock_guard<std::mutex> snapshotLock(snapshotMutex);
-            auto removeSnapshotForBody = [body](std::vector<ObjectSnapshot>& snapshots) {
-                snapshots.erase(
-                    std::remove_if(snapshots.begin(), snapshots.end(), [body](const ObjectSnapshot& snapshot) {
-                        return snapshot.body == body;
-                    }),
-                    snapshots.end()
-                );
-            };
-            removeSnapshotForBody(currentSnapshots);
-            removeSnapshotForBody(previousSnapshots);
-            if (currentSnapshots.empty() && previousSnapshots.empty()) {
-                snapshotReady.store(false, std::memory_order_relaxed);
-            }
-        }
+        startCheckpoint.clear();
+        // Published frames may still point at the body, drop them
+        snapshotEpoch.fetch_add(1, std::memory_order_release);
     } else {
         std::cerr << "[PhysicsSystem] Warning: Tried to remove a body not in the system.\n";
     }
 }
 
-void Physics::PhysicsSystem::advancePhysics(float dt) {
-    float targetTime = simTime + dt;
-    std::vector<PhysicsBody*> collidableBodies;
+void Physics::PhysicsSystem::advancePhysics(float dt, bool subStep) {
+    const double targetTime = simTime + dt;
+    if (!subStep) PHYSICS_PROFILE_BEGIN(profiler);
 
-    PhysicsSystem::octree.build(bodies);
-    for (auto body : bodies) {
-        std::unique_lock<std::mutex> guard = body->lockState();
-        if (body->getCollider() != nullptr) {
-            collidableBodies.push_back(body);
+    {
+        // One store lock covers every attached body for the dense phases
+        std::unique_lock<std::mutex> storeLock(store.mutex(), std::defer_lock);
+        {
+            PHYSICS_PROFILE_SCOPE(profiler, StepPhase::LockWait);
+            storeLock.lock();
         }
 
-        glm::vec3 nBodyGravity  = PhysicsSystem::octree.computeForce(body, getGravitationalConstant());
-        glm::vec3 globalGravity = static_cast<float>(body->getMass(BodyLock::NOLOCK)) * getGlobalAcceleration();
-        glm::vec3 totalGravity  = nBodyGravity + globalGravity;
-        
-        body->setForce("Normal", glm::vec3(0.0f), BodyLock::NOLOCK);
-        body->setForce("Gravity", totalGravity, BodyLock::NOLOCK);
+        if (simTime == 0.0 && !startCheckpoint.matches(store.owners)) {
+            captureStoreState(startCheckpoint);
+        }
 
-        if (simTime == 0.0f) {
-            body->recordFrame(0.0f, BodyLock::NOLOCK);
+        prepareSleep();
 
-            if (resetState.find(body) == resetState.end()) {
-                body->withFrames(BodyLock::NOLOCK, [this, body](const std::vector<ObjectSnapshot>& fr) {
-                    if (!fr.empty()) resetState[body] = fr.front();
-                });
+        // Sleepers wait in sleepingBVH
+        collidableBodies.clear();
+        for (BodyStore::Slot i = 0; i < store.size(); ++i) {
+            if (!store.sleepFlags[i] && store.owners[i]->getCollider() != nullptr) {
+                collidableBodies.push_back(store.owners[i]);
             }
         }
 
-        ThermalProperties props = body->getThermalProperties(BodyLock::NOLOCK);
-        const double area = body->getSurfaceArea();
-        const double mass = body->getMass(BodyLock::NOLOCK);
-        const double ambientTemp = getAmbientTemperature();
-        const double proximityRadiation = PhysicsSystem::octree.computeHeat(body);
-
-        Physics::Thermal::integrateTemperature(props, mass, dt, [&](double tempK) {
-            ThermalProperties tmp = props;
-            tmp.tempK = tempK;
-            return Physics::Thermal::convectionHeatRate(tmp, area, ambientTemp)
-                + Physics::Thermal::ambientRadiationHeatRate(tmp, area, ambientTemp)
-                + Physics::Thermal::externalHeatFluxRate(tmp, area)
-                + proximityRadiation
-                + tmp.internalHeatPower;
-        });
-        if (std::isfinite(props.tempK)) {
-            body->setThermalProperty(props, BodyLock::NOLOCK);
+        const bool forcesCurrent = blockScheduler.getConfig().enabled && blockForcesCurrent && !blockStateStale && store.edits == blockForcesEdits;
+        blockForcesCurrent = false;
+        if (!forcesCurrent) {
+            rebuildOctree();
+            computeForces();
         }
 
-        if (!body->getIsStatic(BodyLock::NOLOCK)) {
-            body->step(dt, BodyLock::NOLOCK);
+        if (simTime == 0.0) {
+            recordFrames(0.0f);
+            for (PhysicsBody* body : store.owners) {
+                if (resetState.find(body) == resetState.end()) {
+                    body->withFrames(BodyLock::NOLOCK, [this, body](const FrameHistory::View& fr) {
+                        if (!fr.empty()) resetState[body] = fr.front();
+                    });
+                }
+            }
         }
-        body->recordFrame(targetTime, BodyLock::NOLOCK);
+
+        integrateThermal(dt);
+        {
+            PHYSICS_PROFILE_SCOPE(profiler, StepPhase::Integrate);
+            if (blockScheduler.getConfig().enabled) {
+                integrateMotionBlocks(dt);
+            } else {
+                integrateMotion(dt);
+            }
+        }
+        if (!subStep) recordFrames(static_cast<float>(targetTime));
     }
 
     // Broad phase
     BVH bvh;
-    bvh.build(collidableBodies);
-    for (const auto[a, b] : bvh.getPotentialCollisions()) {
-        // Narrow phase
-        if (a->getIsStatic(BodyLock::LOCK) && b->getIsStatic(BodyLock::LOCK)) continue;
+    std::vector<std::pair<PhysicsBody*, PhysicsBody*>> candidatePairs;
+    {
+        PHYSICS_PROFILE_SCOPE(profiler, StepPhase::BroadPhaseBuild);
+        bvh.build(collidableBodies);
+    }
+    {
+        PHYSICS_PROFILE_SCOPE(profiler, StepPhase::BroadPhaseQuery);
+        candidatePairs = bvh.getPotentialCollisions();
+        if (!sleepers.empty()) {
+            std::vector<std::pair<PhysicsBody*, PhysicsBody*>> sleeperPairs = bvh.getPotentialCollisions(sleepingBVH);
+            candidatePairs.insert(candidatePairs.end(), sleeperPairs.begin(), sleeperPairs.end());
+        }
+    }
+    PHYSICS_PROFILE_COUNT(profiler, StepCounter::CandidatePairs, candidatePairs.size());
 
-        if (a->collidesWith(*b)) {
-            a->resolveCollisionWith(dt, *b);
+    {
+        PHYSICS_PROFILE_SCOPE(profiler, StepPhase::NarrowPhase);
+        contactPairs.clear();
+        const auto frozen = [](const PhysicsBody* body) {
+            return body->getIsStatic(BodyLock::LOCK) || body->isSleeping(BodyLock::LOCK);
+        };
+        for (const auto& [a, b] : candidatePairs) {
+            if (frozen(a) && frozen(b)) continue;
+
+            if (a->collidesWith(*b)) {
+                PHYSICS_PROFILE_COUNT(profiler, StepCounter::Contacts, 1);
+                blockForcesCurrent = false;
+                if (sleepConfig.enabled) contactPairs.emplace_back(a, b);
+                a->resolveCollisionWith(dt, *b);
+            }
         }
     }
+    updateSleep(dt);
 
-    stepCount++;
     simTime = targetTime;
+    if (!subStep) {
+        stepCount++;
+        PHYSICS_PROFILE_COMMIT(profiler, static_cast<std::uint64_t>(stepCount.load()));
+    }
+}
+
+void Physics::PhysicsSystem::rebuildOctree() {
+    PHYSICS_PROFILE_SCOPE(profiler, StepPhase::OctreeBuild);
+    PhysicsSystem::octree.build(sleepers.empty() ? store.owners : awakeBodies, pool.get());
+    PHYSICS_PROFILE_COUNT(profiler, StepCounter::OctreeNodes, PhysicsSystem::octree.nodeCount());
+}
+
+void Physics::PhysicsSystem::refitOctree() {
+    PHYSICS_PROFILE_SCOPE(profiler, StepPhase::OctreeBuild);
+    PhysicsSystem::octree.refit(pool.get());
+}
+
+void Physics::PhysicsSystem::computeForces() {
+    if (!sleepers.empty()) {
+        computeForces(awakeSlots);
+        return;
+    }
+    PHYSICS_PROFILE_SCOPE(profiler, StepPhase::GravityForces);
+    PHYSICS_PROFILE_COUNT(profiler, StepCounter::ForceEvaluations, store.size());
+    const double G = getGravitationalConstant();
+    const glm::vec3 globalAccel = getGlobalAcceleration();
+    computeMultipoleForces(G);
+
+    pool->parallelFor(store.size(), kTreeQueryGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            applyGravity(i, G, globalAccel);
+        }
+    });
+}
+
+void Physics::PhysicsSystem::computeForces(const std::vector<std::size_t>& slots) {
+    PHYSICS_PROFILE_SCOPE(profiler, StepPhase::GravityForces);
+    PHYSICS_PROFILE_COUNT(profiler, StepCounter::ForceEvaluations, slots.size());
+    const double G = getGravitationalConstant();
+    const glm::vec3 globalAccel = getGlobalAcceleration();
+    computeMultipoleForces(G);
+
+    pool->parallelFor(slots.size(), kTreeQueryGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            applyGravity(slots[k], G, globalAccel);
+        }
+    });
+}
+
+void Physics::PhysicsSystem::computeMultipoleForces(double G) {
+    if (gravityConfig.solver != GravitySolver::FastMultipole) return;
+
+    // One pass for every awake body, even when only a few are due
+    fastMultipole.computeForces(PhysicsSystem::octree, G, treeForces, pool.get());
+    if (sleepers.empty()) {
+        multipoleForces.swap(treeForces);
+        return;
+    }
+    multipoleForces.assign(store.size(), glm::vec3(0.0f));
+    for (std::size_t k = 0; k < awakeSlots.size(); ++k) multipoleForces[awakeSlots[k]] = treeForces[k];
+}
+
+void Physics::PhysicsSystem::applyGravity(std::size_t slot, double G, const glm::vec3& globalAccel) {
+    PhysicsBody* body = store.owners[slot];
+    glm::vec3 nBodyGravity  = gravityConfig.solver == GravitySolver::FastMultipole
+        ? multipoleForces[slot]
+        : PhysicsSystem::octree.computeForce(body, G);
+    if (!sleepers.empty()) nBodyGravity += sleepingOctree.computeForce(body, G);
+    glm::vec3 globalGravity = static_cast<float>(store.masses[slot]) * globalAccel;
+    glm::vec3 totalGravity  = nBodyGravity + globalGravity;
+
+    body->setForce(ForceRegistry::Normal, glm::vec3(0.0f), BodyLock::NOLOCK);
+    body->setForce(ForceRegistry::Gravity, totalGravity, BodyLock::NOLOCK);
+}
+
+void Physics::PhysicsSystem::integrateThermal(float dt) {
+    const std::size_t count = store.size();
+    const double ambientTemp = getAmbientTemperature();
+
+    // Gather radiation first so every body sees the same start-of-step temperatures
+    proximityHeat.resize(count);
+    {
+        PHYSICS_PROFILE_SCOPE(profiler, StepPhase::ThermalRadiation);
+        pool->parallelFor(count, kTreeQueryGrain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (store.sleepFlags[i]) continue;
+                proximityHeat[i] = PhysicsSystem::octree.computeHeat(store.owners[i]);
+                if (!sleepers.empty()) proximityHeat[i] += sleepingOctree.computeHeat(store.owners[i]);
+            }
+        });
+    }
+
+    PHYSICS_PROFILE_SCOPE(profiler, StepPhase::ThermalIntegrate);
+    pool->parallelFor(count, kTreeQueryGrain, [&](std::size_t begin, std::size_t end) {
+        [[maybe_unused]] std::uint64_t subSteps = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            if (store.sleepFlags[i]) continue;
+            ThermalProperties props = store.thermals[i];
+            const double area = store.surfaceAreas[i];
+            const double mass = store.masses[i];
+            const double proximityRadiation = proximityHeat[i];
+
+            // integrateTemperature always evaluates at props.tempK, so no scratch copy is needed
+            subSteps += Physics::Thermal::integrateTemperature(props, mass, dt, [&](double) {
+                return Physics::Thermal::convectionHeatRate(props, area, ambientTemp)
+                    + Physics::Thermal::ambientRadiationHeatRate(props, area, ambientTemp)
+                    + Physics::Thermal::externalHeatFluxRate(props, area)
+                    + proximityRadiation
+                    + props.internalHeatPower;
+            });
+            if (!std::isfinite(props.tempK)) continue;
+
+            store.thermals[i] = props;
+            if (store.derivesAreaFromDensity[i]) {
+                const double sphereArea = Physics::Thermal::sphereSurfaceArea(mass, Physics::Thermal::effectiveDensity(props, props.tempK));
+                if (sphereArea > 0.0) store.surfaceAreas[i] = static_cast<float>(sphereArea);
+            }
+        }
+        PHYSICS_PROFILE_COUNT(profiler, StepCounter::ThermalSubSteps, subSteps);
+    });
+}
+
+void Physics::PhysicsSystem::integrateMotion(float dt) {
+    IntegrationContext ctx{ store, *pool, getGravitationalConstant(), [this] {
+        rebuildOctree();
+        computeForces();
+    } };
+    integrator->advance(ctx, dt);
+}
+
+void Physics::PhysicsSystem::integrateMotionBlocks(float dt) {
+    const std::size_t count = store.size();
+    if (blockStateStale || blockScheduler.size() != count) {
+        blockScheduler.reset(count);
+        blockStateStale = false;
+    }
+
+    // Kick-drift-kick leapfrog per body: half kick when a body's step opens, half
+    // kick with fresh forces when it closes. Every body drifts together, but only
+    // up to the next sub-step where someone closes, since nothing changes between.
+    // The octree is rebuilt once per step and when many bodies close together; sub-steps
+    // that only close a few fast bodies refit it, so they cost O(N) rather than a sort.
+    const std::uint32_t subSteps = blockScheduler.subSteps();
+    const float h = dt / static_cast<float>(subSteps);
+    std::uint32_t driftedTo = 0;
+    bool treeBuilt = false;
+    bool endForcesComputed = false;
+
+    for (std::uint32_t s = 0; s < subSteps; ++s) {
+        pool->parallelFor(count, kIntegrateGrain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (store.isFrozen(i) || !blockScheduler.isDue(i, s)) continue;
+                const Vec3 acceleration = Vec3(store.netForces[i]) / static_cast<Real>(store.masses[i]);
+                blockScheduler.open(i, glm::vec3(acceleration));
+                store.velocities[i] += acceleration * static_cast<Real>(0.5f * h * static_cast<float>(blockScheduler.stride(i)));
+            }
+        });
+
+        const std::uint32_t next = s + 1;
+        dueBodies.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!store.isFrozen(i) && blockScheduler.isDue(i, next)) dueBodies.push_back(i);
+        }
+        if (dueBodies.empty()) continue;
+
+        const float drift = h * static_cast<float>(next - driftedTo);
+        driftedTo = next;
+        pool->parallelFor(count, kIntegrateGrain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (store.isFrozen(i)) continue;
+                const Vec3 posIncrement = store.velocities[i] * static_cast<Real>(drift);
+                store.moveTo(i, store.positions[i] + posIncrement);
+            }
+        });
+
+        if (!treeBuilt || dueBodies.size() * kRefitDueFraction > count) {
+            rebuildOctree();
+            treeBuilt = true;
+        } else {
+            refitOctree();
+        }
+        if (next == subSteps) {
+            // Everyone closes here; static bodies come along so the next step can start from these forces
+            computeForces();
+            endForcesComputed = true;
+        } else {
+            computeForces(dueBodies);
+        }
+
+        pool->parallelFor(dueBodies.size(), kIntegrateGrain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t k = begin; k < end; ++k) {
+                const std::size_t i = dueBodies[k];
+                const float stepSize = h * static_cast<float>(blockScheduler.stride(i));
+                const Vec3 acceleration = Vec3(store.netForces[i]) / static_cast<Real>(store.masses[i]);
+                store.velocities[i] += acceleration * static_cast<Real>(0.5f * stepSize);
+                blockScheduler.close(i, next, glm::vec3(acceleration), stepSize, dt);
+            }
+        });
+    }
+    blockForcesCurrent = endForcesComputed;
+    blockForcesEdits = store.edits;
+}
+
+void Physics::PhysicsSystem::recordFrames(float t) {
+    PHYSICS_PROFILE_SCOPE(profiler, StepPhase::RecordFrames);
+    pool->parallelFor(store.size(), kIntegrateGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            store.owners[i]->recordFrame(t, BodyLock::NOLOCK);
+        }
+    });
+}
+
+void Physics::PhysicsSystem::prepareSleep() {
+    const glm::vec3 globalAccel = getGlobalAcceleration();
+    const double G = getGravitationalConstant();
+    const float ambientTemp = getAmbientTemperature();
+    // Sleepers hold the forces and temperatures of the old globals
+    const bool globalsChanged = globalAccel != sleepAcceleration || G != sleepG || ambientTemp != sleepAmbient;
+    if (globalsChanged || (!sleepConfig.enabled && (!sleepers.empty() || sleepStateStale))) {
+        blockForcesCurrent = false;
+        wakeAll();
+        sleepAcceleration = globalAccel;
+        sleepG = G;
+        sleepAmbient = ambientTemp;
+    }
+    if (!sleepConfig.enabled && sleepers.empty() && !sleepStateStale) return;
+    wakeMarkedIslands();
+
+    const std::size_t count = store.size();
+    bool changed = sleepStateStale;
+    std::size_t sleeping = 0;
+    for (BodyStore::Slot i = 0; i < count; ++i) {
+        if (!store.sleepFlags[i]) continue;
+        const std::pair<BodyStore::Slot, std::uint32_t> entry{ i, store.islands[i] };
+        if (!changed && (sleeping >= sleepers.size() || sleepers[sleeping] != entry)) changed = true;
+        if (changed) {
+            sleepers.resize(sleeping);
+            sleepers.push_back(entry);
+        }
+        ++sleeping;
+    }
+    if (sleeping != sleepers.size()) {
+        sleepers.resize(sleeping);
+        changed = true;
+    }
+    PHYSICS_PROFILE_COUNT(profiler, StepCounter::SleepingBodies, sleeping);
+
+    if (changed) {
+        blockForcesCurrent = false;
+        sleepStateStale = false;
+        awakeBodies.clear();
+        awakeSlots.clear();
+        std::vector<PhysicsBody*> sleepingBodies;
+        std::vector<PhysicsBody*> sleepingCollidables;
+        std::size_t next = 0;
+        for (BodyStore::Slot i = 0; i < count; ++i) {
+            if (next < sleepers.size() && sleepers[next].first == i) {
+                ++next;
+                sleepingBodies.push_back(store.owners[i]);
+                if (store.owners[i]->getCollider() != nullptr) sleepingCollidables.push_back(store.owners[i]);
+            } else {
+                awakeBodies.push_back(store.owners[i]);
+                awakeSlots.push_back(i);
+            }
+        }
+        sleepingOctree.build(sleepingBodies, pool.get());
+        sleepingBVH.build(std::move(sleepingCollidables));
+        PHYSICS_PROFILE_COUNT(profiler, StepCounter::OctreeNodes, sleepingOctree.nodeCount());
+    }
+
+    if (sleepConfig.enabled) {
+        stepStartTemperatures.resize(count);
+        for (std::size_t i = 0; i < count; ++i) stepStartTemperatures[i] = store.thermals[i].tempK;
+    }
+}
+
+void Physics::PhysicsSystem::wakeMarkedIslands() {
+    // An island wakes as a whole once any of its bodies is awake again
+    wokenIslands.clear();
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        if (store.islands[i] != 0 && !store.sleepFlags[i]) wokenIslands.push_back(store.islands[i]);
+    }
+    if (wokenIslands.empty()) return;
+
+    std::sort(wokenIslands.begin(), wokenIslands.end());
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        if (store.islands[i] != 0 && std::binary_search(wokenIslands.begin(), wokenIslands.end(), store.islands[i])) {
+            store.sleepFlags[i] = 0;
+            store.islands[i] = 0;
+            store.sleepTimers[i] = 0.0f; // stays awake for a full timeToSleep, so the island can regroup through its contacts
+        }
+    }
+}
+
+void Physics::PhysicsSystem::wakeAll() {
+    std::fill(store.sleepFlags.begin(), store.sleepFlags.end(), std::uint8_t{0});
+    std::fill(store.islands.begin(), store.islands.end(), 0u);
+    std::fill(store.sleepTimers.begin(), store.sleepTimers.end(), 0.0f);
+}
+
+void Physics::PhysicsSystem::updateSleep(float dt) {
+    if (!sleepConfig.enabled || !(dt > 0.0f)) return;
+
+    auto storeLock = store.lock();
+    const std::size_t count = store.size();
+    islands.reset(count);
+    for (const auto& [a, b] : contactPairs) {
+        const BodyStore::Slot slotA = store.slotOf(a);
+        const BodyStore::Slot slotB = store.slotOf(b);
+        // Frozen pairs never reach the narrow phase, so a sleeper here was touched by a moving body
+        store.sleepFlags[slotA] = 0;
+        store.sleepFlags[slotB] = 0;
+        if (!store.staticFlags[slotA] && !store.staticFlags[slotB]) islands.unite(slotA, slotB);
+    }
+    wakeMarkedIslands();
+
+    islandReady.assign(count, 1);
+    for (BodyStore::Slot i = 0; i < count; ++i) {
+        if (store.staticFlags[i] || store.sleepFlags[i]) continue;
+        const double speed = glm::length(glm::dvec3(store.velocities[i]));
+        const double acceleration = glm::length(glm::dvec3(store.netForces[i])) / store.masses[i];
+        const double heatingRate = std::abs(store.thermals[i].tempK - stepStartTemperatures[i]) / dt;
+        if (speed < sleepConfig.linearThreshold && acceleration < sleepConfig.accelerationThreshold && heatingRate < sleepConfig.thermalThreshold) {
+            store.sleepTimers[i] += dt;
+        } else {
+            store.sleepTimers[i] = 0.0f;
+        }
+        if (store.sleepTimers[i] < sleepConfig.timeToSleep) islandReady[islands.find(i)] = 0;
+    }
+
+    islandOfRoot.assign(count, 0);
+    for (BodyStore::Slot i = 0; i < count; ++i) {
+        if (store.staticFlags[i] || store.sleepFlags[i]) continue;
+        const std::uint32_t root = islands.find(i);
+        if (!islandReady[root]) continue;
+        if (islandOfRoot[root] == 0) {
+            islandOfRoot[root] = nextIsland;
+            if (++nextIsland == 0) nextIsland = 1;
+        }
+        store.sleepFlags[i] = 1;
+        store.islands[i] = islandOfRoot[root];
+        store.velocities[i] = Vec3(0);
+    }
+}
+
+void Physics::PhysicsSystem::captureStoreState(StateCheckpoint& out) const {
+    store.capture(out.state);
+    out.owners = store.owners;
+    out.frameCounts.resize(store.size());
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        store.owners[i]->withFrames(BodyLock::NOLOCK, [&out, i](const FrameHistory::View& frames) {
+            out.frameCounts[i] = frames.recordedFrames();
+        });
+    }
+    out.simTime = simTime;
+    out.stepCount = stepCount.load();
+}
+
+void Physics::PhysicsSystem::setWorkerCount(std::size_t count) {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    pool = std::make_shared<ThreadPool>(count);
+}
+
+std::size_t Physics::PhysicsSystem::getWorkerCount() const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    return pool->size();
+}
+
+void Physics::PhysicsSystem::setIntegrator(IntegratorType type) {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    integratorType = type;
+    integrator = makeIntegrator(type);
+}
+
+Physics::IntegratorType Physics::PhysicsSystem::getIntegrator() const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    return integratorType;
+}
+
+void Physics::PhysicsSystem::setBlockTimestepConfig(const BlockTimestepConfig& config) {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    blockScheduler.configure(config);
+    blockStateStale = true;
+}
+
+Physics::BlockTimestepConfig Physics::PhysicsSystem::getBlockTimestepConfig() const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    return blockScheduler.getConfig();
+}
+
+int Physics::PhysicsSystem::getBlockLevel(const PhysicsBody* body) const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    auto storeLock = store.lock();
+    if (!blockScheduler.getConfig().enabled || blockStateStale || blockScheduler.size() != store.size()) return -1;
+    const BodyStore::Slot slot = store.slotOf(body);
+    if (slot >= store.size() || store.owners[slot] != body) return -1;
+    return blockScheduler.level(slot);
+}
+
+void Physics::PhysicsSystem::setAdaptiveTimestepConfig(const AdaptiveTimestepConfig& config) {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    stepSizeController.configure(config);
+}
+
+Physics::AdaptiveTimestepConfig Physics::PhysicsSystem::getAdaptiveTimestepConfig() const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    return stepSizeController.getConfig();
+}
+
+void Physics::PhysicsSystem::setGravityConfig(const GravityConfig& config) {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    gravityConfig = config;
+    gravityConfig.fmmTheta = std::clamp(gravityConfig.fmmTheta, 0.05, 0.95);
+    gravityConfig.barnesHutThetaSq = std::max(gravityConfig.barnesHutThetaSq, 0.0);
+    applyGravityConfig();
+    blockForcesCurrent = false;
+}
+
+void Physics::PhysicsSystem::applyGravityConfig() {
+    fastMultipole.setTheta(gravityConfig.fmmTheta);
+    for (Octree* tree : {&octree, &sleepingOctree}) {
+        tree->setThetaSq(static_cast<Real>(gravityConfig.barnesHutThetaSq));
+        tree->setQuadrupoles(gravityConfig.quadrupoles);
+    }
+    sleepStateStale = true; // rebuilds the sleeping octree with the new moments
+}
+
+Physics::GravityConfig Physics::PhysicsSystem::getGravityConfig() const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    return gravityConfig;
+}
+
+void Physics::PhysicsSystem::setSleepConfig(const SleepConfig& config) {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    sleepConfig = config;
+    sleepConfig.timeToSleep = std::max(sleepConfig.timeToSleep, 0.0f);
+    sleepStateStale = true;
+}
+
+Physics::SleepConfig Physics::PhysicsSystem::getSleepConfig() const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    return sleepConfig;
+}
+
+std::size_t Physics::PhysicsSystem::getSleepingBodyCount() const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    auto storeLock = store.lock();
+    return static_cast<std::size_t>(std::count(store.sleepFlags.begin(), store.sleepFlags.end(), std::uint8_t{1}));
 }
 
 bool Physics::PhysicsSystem::step(float dt) {
+    lastStepDt = dt;
+    if (finishSolver()) return true;
+
+    advancePhysics(dt);
+    return false;
+}
+
+bool Physics::PhysicsSystem::stepAdaptive(float maxDt) {
+    if (finishSolver()) return true;
+
+    advanceAdaptive(maxDt);
+    return false;
+}
+
+void Physics::PhysicsSystem::advanceAdaptive(float maxDt) {
+    PHYSICS_PROFILE_BEGIN(profiler); // one sample for the whole step, rejected tries included
+    const int order = integratorOrder(integratorType);
+    const AdaptiveTimestepConfig& config = stepSizeController.getConfig();
+    // Full and half steps differ by about (2^p - 1) times the error of the half steps that are kept
+    const double errorRatio = std::ldexp(1.0, order) - 1.0;
+    // Below a few ulps of the position the estimate is rounding noise, a tighter tolerance would only shrink dt to minDt
+    constexpr double kRoundingUlps = 8.0 * std::numeric_limits<Real>::epsilon();
+
+    {
+        // Smooth motion gives no error to stop the step growing, so bound how far anything moves against the scene's size
+        auto storeLock = store.lock();
+        if (config.maxSceneFraction > 0.0 && store.size() > 1) {
+            Vec3 lo = store.positions[0];
+            Vec3 hi = store.positions[0];
+            double maxSpeed = 0.0;
+            for (BodyStore::Slot i = 0; i < store.size(); ++i) {
+                lo = glm::min(lo, store.positions[i]);
+                hi = glm::max(hi, store.positions[i]);
+                maxSpeed = std::max(maxSpeed, static_cast<double>(glm::length(store.velocities[i])));
+            }
+            const double maxDisplacement = config.maxSceneFraction * glm::length(glm::dvec3(hi - lo));
+            if (maxSpeed > 0.0 && maxDisplacement > 0.0) {
+                maxDt = std::min(maxDt, std::max(static_cast<float>(maxDisplacement / maxSpeed), config.minDt));
+            }
+        }
+    }
+
+    for (;;) {
+        const float dt = std::min(stepSizeController.proposed(), maxDt);
+        captureCheckpoint(stepStart);
+        {
+            auto storeLock = store.lock();
+            stepStartPositions = store.positions;
+        }
+        advancePhysics(dt, true);
+        {
+            auto storeLock = store.lock();
+            fullStepPositions = store.positions;
+            fullStepVelocities = store.velocities;
+        }
+
+        restoreCheckpoint(stepStart);
+        advancePhysics(0.5f * dt, true);
+        advancePhysics(0.5f * dt, true);
+
+        double error = 0.0;
+        {
+            auto storeLock = store.lock();
+            for (BodyStore::Slot i = 0; i < store.size(); ++i) {
+                // Velocity errors turn into position errors over the next step
+                const double positionError = glm::length(glm::dvec3(store.positions[i] - fullStepPositions[i]));
+                const double velocityError = glm::length(glm::dvec3(store.velocities[i] - fullStepVelocities[i])) * dt;
+                const double displacement = glm::length(glm::dvec3(store.positions[i] - stepStartPositions[i]));
+                const double scale = std::max(config.absoluteTolerance + config.relativeTolerance * displacement,
+                                              kRoundingUlps * glm::length(glm::dvec3(store.positions[i])));
+                error = std::max(error, std::max(positionError, velocityError) / (errorRatio * scale));
+            }
+        }
+
+        if (stepSizeController.update(dt, error, order)) {
+            lastStepDt = dt;
+            {
+                auto storeLock = store.lock();
+                recordFrames(static_cast<float>(simTime));
+            }
+            stepCount++;
+            PHYSICS_PROFILE_COMMIT(profiler, static_cast<std::uint64_t>(stepCount.load()));
+            return;
+        }
+        restoreCheckpoint(stepStart);
+    }
+}
+
+bool Physics::PhysicsSystem::finishSolver() {
     if (solver && solver->stepFrame()) {
         std::cout << "Solver Converged!" << std::endl;
 
-        float finalDuration = this->simTime - (dt * 0.5f); // ensures no extra step is made due to floating point errors
-
-        for (auto body : bodies) {
-            body->withFrames(BodyLock::LOCK, [this, body](const std::vector<ObjectSnapshot>& frames) {
+        // The last run used the final guess, its recorded frames and current state are the solution
+        for (auto body : store.owners) {
+            body->withFrames(BodyLock::LOCK, [this, body](const FrameHistory::View& frames) {
                 if (!frames.empty()) {
                     // The first frame is always t=0 for the current trajectory
                     resetState[body] = frames.front();
                 }
             });
         }
-        reset();
-
-        float bakeTimer = 0.0f;
-
-        while (bakeTimer < finalDuration) {
-            advancePhysics(dt);
-            bakeTimer += dt;
-        }
+        // The checkpoint predates the converged guess, later resets replay resetState and capture again
+        startCheckpoint.clear();
 
         solver = nullptr;
         physicsEnabled = false;
         return true;
     }
-
-    advancePhysics(dt);
     return false;
 }
 
+std::unique_ptr<Physics::PhysicsSystem> Physics::PhysicsSystem::clone() const {
+    std::lock_guard<std::mutex> lock(bodiesMutex);
+    return cloneUnlocked();
+}
+
+std::unique_ptr<Physics::PhysicsSystem> Physics::PhysicsSystem::cloneUnlocked(std::shared_ptr<ThreadPool> forkPool) const {
+    auto copy = std::make_unique<PhysicsSystem>(getGlobalAcceleration(), 1);
+    if (forkPool) copy->pool = std::move(forkPool);
+    copy->setSimSpeed(getSimSpeed());
+    copy->setGravitationalConstant(getGravitationalConstant());
+    copy->setAmbientTemperature(getAmbientTemperature());
+    copy->integratorType = integratorType;
+    copy->integrator = makeIntegrator(integratorType);
+    copy->blockScheduler.configure(blockScheduler.getConfig());
+    copy->stepSizeController = stepSizeController;
+    copy->gravityConfig = gravityConfig;
+    copy->applyGravityConfig();
+    copy->sleepConfig = sleepConfig;
+    copy->nextIsland = nextIsland;
+    copy->sleepAcceleration = sleepAcceleration;
+    copy->sleepG = sleepG;
+    copy->sleepAmbient = sleepAmbient;
+    copy->historyConfig = historyConfig;
+    copy->historyConfig.spillToDisk = false;
+    copy->historySpill = nullptr;
+    copy->lastStepDt = lastStepDt;
+
+    auto storeLock = store.lock();
+    copy->ownedBodies.reserve(store.size());
+    for (PhysicsBody* body : store.owners) {
+        std::unique_ptr<PhysicsBody> bodyCopy = body->clone(BodyLock::NOLOCK);
+        // Attached directly rather than through addBody so forces and state stay exactly as they are
+        bodyCopy->configureFrameHistory(copy->historyConfig.windowFrames, nullptr, BodyLock::LOCK);
+        copy->store.attach(bodyCopy.get());
+        copy->ownedBodies.push_back(std::move(bodyCopy));
+    }
+    copy->simTime = simTime;
+    copy->stepCount.store(stepCount.load());
+    return copy;
+}
+
+bool Physics::PhysicsSystem::adoptState(const PhysicsSystem& fork) {
+    std::scoped_lock locks(store.mutex(), fork.store.mutex());
+    if (fork.store.size() != store.size()) return false;
+    for (BodyStore::Slot i = 0; i < store.size(); ++i) {
+        if (fork.store.owners[i]->getID() != store.owners[i]->getID()) return false;
+    }
+
+    // Clones attach their bodies in store order, so the columns line up slot for slot
+    std::vector<std::byte> state;
+    fork.store.capture(state);
+    store.restore(state.data());
+    for (BodyStore::Slot i = 0; i < store.size(); ++i) {
+        store.owners[i]->copyFramesFrom(*fork.store.owners[i], BodyLock::NOLOCK);
+    }
+    simTime = fork.simTime;
+    stepCount.store(fork.stepCount.load());
+    lastStepDt = fork.lastStepDt;
+    blockStateStale = true;
+    sleepStateStale = true;
+    return true;
+}
+
 void Physics::PhysicsSystem::solveProblem(PhysicsBody* body, const std::unordered_map<std::string, double> &knowns, const std::string &unknown) {
     solver = router.makeSolver(body, knowns, unknown);
 
@@ -296,8 +899,11 @@ void Physics::PhysicsSystem::solveProblem(PhysicsBody* body, const std::unordere
 }
 
 void Physics::PhysicsSystem::reset() {
+    if (restoreCheckpoint(startCheckpoint)) return;
+
     stepCount.store(0);
-    simTime = 0.0f;
+    simTime = 0.0;
+    blockStateStale = true;
     for (auto [body, initialState] : resetState) {
         body->clearAllFrames(BodyLock::LOCK);
         body->loadFrame(initialState, BodyLock::LOCK);
@@ -307,20 +913,36 @@ void Physics::PhysicsSystem::reset() {
 void Physics::PhysicsSystem::clearRuntimeState() {
     std::lock_guard<std::mutex> bodiesLock(bodiesMutex);
     resetState.clear();
+    startCheckpoint.clear();
     solver.reset();
     stepCount.store(0);
-    simTime = 0.0f;
-    {
-        std::lock_guard<std::mutex> snapshotLock(snapshotMutex);
-        currentSnapshots.clear();
-        previousSnapshots.clear();
+    simTime = 0.0;
+    snapshotEpoch.fetch_add(1, std::memory_order_release);
+}
+
+void Physics::PhysicsSystem::captureCheckpoint(StateCheckpoint& out) const {
+    auto storeLock = store.lock();
+    captureStoreState(out);
+}
+
+bool Physics::PhysicsSystem::restoreCheckpoint(const StateCheckpoint& checkpoint) {
+    auto storeLock = store.lock();
+    if (!checkpoint.matches(store.owners)) return false;
+
+    store.restore(checkpoint.state.data());
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        store.owners[i]->truncateFrames(checkpoint.frameCounts[i], BodyLock::NOLOCK);
     }
-    snapshotReady.store(false, std::memory_order_relaxed);
+    simTime = checkpoint.simTime;
+    stepCount.store(checkpoint.stepCount);
+    blockStateStale = true;
+    if (!sleepConfig.enabled) sleepStateStale = true; // wakes anything the checkpoint had asleep
+    return true;
 }
 
 void Physics::PhysicsSystem::enablePhysics() {
     physicsEnabled.store(true);
-    snapshotReady.store(false, std::memory_order_relaxed); // so we don't read from the stale buffer
+    snapshotEpoch.fetch_add(1, std::memory_order_release); // so we don't read from the stale buffer
 }
 
 void Physics::PhysicsSystem::disablePhysics() {
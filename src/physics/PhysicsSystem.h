@@ -4,18 +4,30 @@
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <memory>
 #include <optional>
 
 #include "RigidBody.h"
+#include "physics/BodyStore.h"
 #include "physics/Constants.h"
+#include "physics/SleepIslands.h"
+#include "physics/SnapshotChannel.h"
+#include "physics/history/StateCheckpoint.h"
+#include "physics/integration/AdaptiveTimestep.h"
+#include "physics/integration/BlockTimestep.h"
+#include "physics/integration/Integrator.h"
+#include "physics/profiling/StepProfiler.h"
 #include "solver/ProblemRouter.h"
 #include "spatial/Octree.h"
+#include "spatial/FastMultipole.h"
 #include "spatial/BVH.h"
+#include "utils/ThreadPool.h"
 
 namespace Physics {
     class PhysicsSystem {
     public:
-        explicit PhysicsSystem(const glm::vec3& globalAccel = glm::vec3(0.0f, -Constants::STANDARD_GRAVITY, 0.0f));
+        // workerCount as in setWorkerCount
+        explicit PhysicsSystem(const glm::vec3& globalAccel = glm::vec3(0.0f, -Constants::STANDARD_GRAVITY, 0.0f), std::size_t workerCount = 0);
         ~PhysicsSystem();
 
         // thread control
@@ -28,6 +40,14 @@ namespace Physics {
         PhysicsBody* getBodyById(uint32_t id) const;
 
         bool step(float dt);
+        // One step of at most maxDt sized by the adaptive timestep tolerance, like step(dt) otherwise
+        bool stepAdaptive(float maxDt);
+        float getLastStepDt() const { return lastStepDt; } // what solver forks step with
+
+        // Independent headless copy of the scene that owns deep copies of every body and collider,
+        // with the same globals, integrator, clock and step count, one worker and no frame spill.
+        // Frames are not copied. Safe from any thread; step batches of clones with CloneRunner
+        std::unique_ptr<PhysicsSystem> clone() const;
 
         void enablePhysics();
         void disablePhysics();
@@ -43,32 +63,152 @@ namespace Physics {
         float getAmbientTemperature() const { return ambientTemperature.load(); }
         void setAmbientTemperature(float newTemp) { ambientTemperature.store(newTemp); }
 
-        std::optional<std::vector<ObjectSnapshot>> fetchLatestSnapshot(float renderSimTime);
+        // Threads used by the force, thermal and integration phases (caller included, 0 = hardware concurrency)
+        void setWorkerCount(std::size_t count);
+        std::size_t getWorkerCount() const;
+
+        // Motion integrator for every step; block timesteps, when enabled, take precedence
+        void setIntegrator(IntegratorType type);
+        IntegratorType getIntegrator() const;
+
+        // Per-body power-of-two sub-stepping inside each step(dt), off by default
+        void setBlockTimestepConfig(const BlockTimestepConfig& config);
+        BlockTimestepConfig getBlockTimestepConfig() const;
+        // Level of the body's current block step, 0 being the full step; -1 while block timesteps are off or not yet assigned
+        int getBlockLevel(const PhysicsBody* body) const;
+
+        // Error-controlled step sizes for the physics loop, off by default. Takes precedence over the wall-clock dt
+        void setAdaptiveTimestepConfig(const AdaptiveTimestepConfig& config);
+        AdaptiveTimestepConfig getAdaptiveTimestepConfig() const;
+
+        // Solver and opening angles for the gravity between bodies, Barnes-Hut by default. Sleepers always attract through Barnes-Hut
+        void setGravityConfig(const GravityConfig& config);
+        GravityConfig getGravityConfig() const;
+
+        // Islands of bodies at rest stop being integrated until touched, off by default. While asleep
+        // a body keeps attracting and heating others but no longer feels them; changing the globals wakes everything
+        void setSleepConfig(const SleepConfig& config);
+        SleepConfig getSleepConfig() const;
+        std::size_t getSleepingBodyCount() const;
+
+        // Applies to every body, including ones added later. Replacing the spill migrates spilled frames where possible
+        void setFrameHistoryConfig(const FrameHistoryConfig& config);
+        FrameHistoryConfig getFrameHistoryConfig() const;
+
+        // Per-phase timings and counters of recent steps, readable from any thread without blocking physics
+        const StepProfiler& getProfiler() const { return profiler; }
+
+        // Render thread only. Fills out with the newest state interpolated to renderSimTime, never blocks the physics thread
+        bool fetchLatestSnapshot(float renderSimTime, std::vector<ObjectSnapshot>& out);
 
         const ProblemRouter* getRouter() const { return &router; }
         void solveProblem(PhysicsBody* body, const std::unordered_map<std::string, double>& knowns, const std::string& unknown = "");
         void reset();
         void clearRuntimeState();
 
-        float simTime = 0.0f; // TODO move
+        // Physics thread or stopped physics only, like reset(). Capturing into the same checkpoint reuses its buffer
+        void captureCheckpoint(StateCheckpoint& out) const;
+        // False, leaving the state alone, if the body set changed since the capture
+        bool restoreCheckpoint(const StateCheckpoint& checkpoint);
+
+        double simTime = 0.0; // TODO move. Double so long runs keep sub-second resolution
 
     private:
+        friend class ::ProblemRouter; // solvers clone and re-step from inside step(), with bodiesMutex already held
+
+        // One worker suits clones stepped side by side on a CloneRunner, a lone clone can take more
+        // Steps on forkPool when given, e.g. one a solver keeps across iterations, otherwise on a single worker
+        std::unique_ptr<PhysicsSystem> cloneUnlocked(std::shared_ptr<ThreadPool> forkPool = nullptr) const;
+        // Takes over the state, frames and clock of a clone of this system, so a solver keeps the run
+        // of its winning fork instead of replaying it. False, changing nothing, if the body sets differ
+        bool adoptState(const PhysicsSystem& fork);
         void physicsLoop();
-        void advancePhysics(float dt);
+        // Adaptive sub-steps leave the frame, the step count and the profile sample to the step they make up
+        void advancePhysics(float dt, bool subStep = false);
+        bool finishSolver(); // true once the active solver has converged
+        void advanceAdaptive(float maxDt);
+
+        // Step phases, each runs over the dense store columns on the pool (store lock held)
+        void rebuildOctree();
+        void refitOctree(); // moves the bodies of the last rebuild without re-sorting, see Octree::refit
+        void computeForces();
+        void computeForces(const std::vector<std::size_t>& slots);
+        void applyGravity(std::size_t slot, double G, const glm::vec3& globalAccel);
+        void computeMultipoleForces(double G); // fills multipoleForces by slot when the FMM solver is selected
+        void applyGravityConfig(); // hands gravityConfig to the octrees and the FMM solver
+        void integrateThermal(float dt);
+        void integrateMotion(float dt);
+        void integrateMotionBlocks(float dt);
+        void recordFrames(float t);
+        void prepareSleep(); // wakes touched islands and refreshes the awake lists and sleeping trees
+        void wakeMarkedIslands();
+        void wakeAll();
+        void updateSleep(float dt); // takes the store lock itself, after the narrow phase
+        void captureStoreState(StateCheckpoint& out) const; // store lock held
 
         ProblemRouter router;
         std::unique_ptr<ISolver> solver = nullptr;
         float solverTargetTime = 10.0f;
         std::unordered_map<PhysicsBody*, ObjectSnapshot> resetState{};
+        StateCheckpoint startCheckpoint; // full t=0 state, reset() falls back to resetState when the body set changed
 
         Octree octree;
+        Octree sleepingOctree; // rebuilt only when the sleeping set changes
+        BVH sleepingBVH;
+
+        GravityConfig gravityConfig;
+        FastMultipole fastMultipole;
+        std::vector<glm::vec3> multipoleForces; // by slot, zero for sleepers
+        std::vector<glm::vec3> treeForces;      // in the order the octree was built from
 
         std::atomic<glm::vec3> globalAcceleration;
         std::atomic<float> simSpeed{1.0f};
         std::atomic<double> gravitationalConstant{Constants::G};
         std::atomic<float> ambientTemperature{293.15f};
         std::atomic<long long> stepCount{0};
-        std::vector<PhysicsBody*> bodies;
+        float lastStepDt = 1.0f / 1000.0f;
+        std::vector<std::unique_ptr<PhysicsBody>> ownedBodies; // clones only, declared before the store so they outlive it
+        BodyStore store;
+
+        // Per-step scratch, kept to avoid reallocating every step
+        std::vector<PhysicsBody*> collidableBodies;
+        std::vector<double> proximityHeat;
+        std::shared_ptr<ThreadPool> pool;
+
+        IntegratorType integratorType = IntegratorType::VelocityVerlet;
+        std::unique_ptr<IIntegrator> integrator;
+
+        BlockScheduler blockScheduler;
+        StepSizeController stepSizeController;
+        StateCheckpoint stepStart; // adaptive steps rewind here between the full and the half steps
+        std::vector<Vec3> stepStartPositions;
+        std::vector<Vec3> fullStepPositions;
+        std::vector<Vec3> fullStepVelocities;
+        bool blockStateStale = true; // body set changed since the levels were assigned
+        // The last block step ended on a force pass over every awake body; the next step reuses it while
+        // nothing it depends on changed since (no contacts, edits, sleep changes or new globals)
+        bool blockForcesCurrent = false;
+        std::uint64_t blockForcesEdits = 0;
+        std::vector<std::size_t> dueBodies;
+
+        SleepConfig sleepConfig;
+        IslandSet islands;
+        std::uint32_t nextIsland = 1;
+        std::vector<std::pair<BodyStore::Slot, std::uint32_t>> sleepers; // slot and island the sleeping trees were built from
+        bool sleepStateStale = true; // slots moved since the sleeping trees were built
+        std::vector<PhysicsBody*> awakeBodies; // only maintained while something sleeps
+        std::vector<std::size_t> awakeSlots;
+        std::vector<std::pair<PhysicsBody*, PhysicsBody*>> contactPairs;
+        std::vector<double> stepStartTemperatures;
+        std::vector<std::uint8_t> islandReady;   // per island root, scratch of updateSleep
+        std::vector<std::uint32_t> islandOfRoot; // island id handed to each root that falls asleep
+        std::vector<std::uint32_t> wokenIslands; // scratch of wakeMarkedIslands
+        glm::vec3 sleepAcceleration{0.0f}; // globals the sleepers last felt
+        double sleepG = 0.0;
+        float sleepAmbient = 0.0f;
+
+        FrameHistoryConfig historyConfig;
+        std::shared_ptr<FrameSpillFile> historySpill; // shared by all bodies, null when spilling is off
 
         std::atomic<bool> physicsEnabled{false};
 
@@ -77,10 +217,10 @@ namespace Physics {
         mutable std::mutex bodiesMutex;
         std::atomic<bool> threadRunning{false};
 
-        std::mutex snapshotMutex;
-        std::vector<ObjectSnapshot> currentSnapshots;
-        std::vector<ObjectSnapshot> previousSnapshots;
-        std::atomic<bool> snapshotReady{false};
+        SnapshotChannel snapshots;
+        std::atomic<std::uint64_t> snapshotEpoch{1}; // bumped to invalidate already published frames
+
+        StepProfiler profiler;
     };
 
 }
@@ -12,26 +12,28 @@ constexpr double kContactConductionDistance = 0.01;
 }
 
 Physics::PointMass::PointMass(uint32_t id, double m, glm::vec3 pos, bool bodyStatic) : PhysicsBody(id) {
-    std::lock_guard<std::mutex> lock(stateMutex);
+    auto lock = lockState();
     setPosition(pos, BodyLock::NOLOCK);
     setMass(m, BodyLock::NOLOCK);
     setIsStatic(bodyStatic, BodyLock::NOLOCK);
     setVelocity(glm::vec3(0.0f), BodyLock::NOLOCK);
+    setDerivesAreaFromDensity(true);
     recomputeSurfaceArea();
 }
 
 Physics::PointMass::PointMass(uint32_t id, glm::vec3 pos, bool bodyStatic) : PhysicsBody(id) {
-    std::lock_guard<std::mutex> lock(stateMutex);
+    auto lock = lockState();
     setPosition(pos, BodyLock::NOLOCK);
     setIsStatic(bodyStatic, BodyLock::NOLOCK);
     setMass(1.0f, BodyLock::NOLOCK);
+    setDerivesAreaFromDensity(true);
     recomputeSurfaceArea();
 }
 
 void Physics::PointMass::setMass(double newMass, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
     PhysicsBody::setMass(newMass, BodyLock::NOLOCK);
     recomputeSurfaceArea();
@@ -40,49 +42,46 @@ void Physics::PointMass::setMass(double newMass, BodyLock lock) {
 void Physics::PointMass::setThermalProperty(const ThermalProperties& newProps, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
     PhysicsBody::setThermalProperty(newProps, BodyLock::NOLOCK);
     recomputeSurfaceArea();
 }
 
 void Physics::PointMass::recomputeSurfaceArea() {
-    double curMass = getMass(BodyLock::NOLOCK);
     const ThermalProperties props = getThermalProperties(BodyLock::NOLOCK);
-    double density = Physics::Thermal::effectiveDensity(props, props.tempK);
-    if (density > 0.0f) {
-        double volume = curMass / density;
-        float radius = std::cbrt((3.0f * volume) / (4.0f * glm::pi<float>()));
-        surfaceArea = 4.0f * glm::pi<float>() * radius * radius;
+    const double area = Physics::Thermal::sphereSurfaceArea(getMass(BodyLock::NOLOCK), Physics::Thermal::effectiveDensity(props, props.tempK));
+    if (area > 0.0) {
+        setSurfaceArea(static_cast<float>(area));
     }
 }
 
 void Physics::PointMass::applyImpulse(const glm::vec3 &impulse, BodyLock lock) {
-    glm::vec3 curVel;
+    glm::dvec3 curVel;
     double curMass;
 
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    curVel = getVelocity(BodyLock::NOLOCK);
+    curVel = getVelocityPrecise(BodyLock::NOLOCK);
     curMass = getMass(BodyLock::NOLOCK);
 
-    setVelocity(curVel + impulse * static_cast<float>(1.0 / curMass), BodyLock::NOLOCK);
+    setVelocityPrecise(curVel + glm::dvec3(impulse) / curMass, BodyLock::NOLOCK);
 }
 
 void Physics::PointMass::recordFrame(float t, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    frames.push_back( {this, t, getPosition(BodyLock::NOLOCK), getVelocity(BodyLock::NOLOCK), static_cast<float>(getThermalProperties(BodyLock::NOLOCK).tempK)} );
+    frames.push( {t, getPosition(BodyLock::NOLOCK), getVelocity(BodyLock::NOLOCK), static_cast<float>(getThermalProperties(BodyLock::NOLOCK).tempK)} );
 }
 
 void Physics::PointMass::loadFrame(const ObjectSnapshot &snapshot, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
     setPosition(snapshot.position, BodyLock::NOLOCK);
     setVelocity(snapshot.velocity, BodyLock::NOLOCK);
@@ -91,15 +90,26 @@ void Physics::PointMass::loadFrame(const ObjectSnapshot &snapshot, BodyLock lock
     setThermalProperty(props, BodyLock::NOLOCK);
 }
 
+std::unique_ptr<Physics::PhysicsBody> Physics::PointMass::clone(BodyLock lock) const {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
+
+    auto copy = std::make_unique<PointMass>(getID());
+    copy->copyStateFrom(*this);
+    return copy;
+}
+
 void Physics::PointMass::step(float dt, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    glm::vec3 acceleration = getNetForce(BodyLock::NOLOCK) / static_cast<float>(getMass(BodyLock::NOLOCK));
-    setPosition(getPosition(BodyLock::NOLOCK) + (getVelocity(BodyLock::NOLOCK) * dt + 0.5f * acceleration * dt * dt), BodyLock::NOLOCK);
-    glm::vec3 newAcceleration = getNetForce(BodyLock::NOLOCK) / static_cast<float>(getMass(BodyLock::NOLOCK)); // if netForce changed during the step
-    setVelocity(getVelocity(BodyLock::NOLOCK) + 0.5f * (acceleration + newAcceleration) * dt, BodyLock::NOLOCK);
+    const double h = dt;
+    glm::dvec3 acceleration = glm::dvec3(getNetForce(BodyLock::NOLOCK)) / getMass(BodyLock::NOLOCK);
+    setPositionPrecise(getPositionPrecise(BodyLock::NOLOCK) + (getVelocityPrecise(BodyLock::NOLOCK) * h + 0.5 * acceleration * h * h), BodyLock::NOLOCK);
+    glm::dvec3 newAcceleration = glm::dvec3(getNetForce(BodyLock::NOLOCK)) / getMass(BodyLock::NOLOCK); // if netForce changed during the step
+    setVelocityPrecise(getVelocityPrecise(BodyLock::NOLOCK) + 0.5 * (acceleration + newAcceleration) * h, BodyLock::NOLOCK);
 }
 
 bool Physics::PointMass::collidesWith(const PhysicsBody &other) const {
@@ -107,7 +117,7 @@ bool Physics::PointMass::collidesWith(const PhysicsBody &other) const {
 }
 
 bool Physics::PointMass::collidesWithPointMass(const PointMass &pm) const {
-    return glm::distance(getPosition(BodyLock::LOCK), pm.getPosition(BodyLock::LOCK)) <= kPointMassCollisionDistance;
+    return glm::distance(getPositionPrecise(BodyLock::LOCK), pm.getPositionPrecise(BodyLock::LOCK)) <= kPointMassCollisionDistance;
 }
 
 bool Physics::PointMass::collidesWithRigidBody(const RigidBody &rb) const {
@@ -121,8 +131,8 @@ bool Physics::PointMass::resolveCollisionWith(float dt, PhysicsBody &other) {
 bool Physics::PointMass::resolveCollisionWithPointMass(float dt, PointMass &pm) {
     // elastic collision
     // compute normal and relative velocity
-    std::lock_guard<std::mutex> lock(stateMutex);
-    glm::vec3 normal = glm::normalize(pm.getPosition(BodyLock::NOLOCK) - getPosition(BodyLock::NOLOCK));
+    auto lock = lockState();
+    glm::vec3 normal = glm::vec3(glm::normalize(pm.getPositionPrecise(BodyLock::NOLOCK) - getPositionPrecise(BodyLock::NOLOCK)));
     glm::vec3 relVel = pm.getVelocity(BodyLock::NOLOCK) - getVelocity(BodyLock::NOLOCK);
     float velNorm = glm::dot(relVel, normal);
 
@@ -21,6 +21,7 @@ namespace Physics {
 
         void recordFrame(float t, BodyLock lock) override;
         void loadFrame(const ObjectSnapshot &snapshot, BodyLock lock) override;
+        std::unique_ptr<PhysicsBody> clone(BodyLock lock) const override;
 
         bool collidesWith(const PhysicsBody& other) const override;
         bool collidesWithPointMass(const PointMass& pm) const override;
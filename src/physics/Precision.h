@@ -0,0 +1,19 @@
+#pragma once
+#include <glm/glm.hpp>
+
+namespace Physics {
+    /**
+     * @brief Scalar type of body positions and velocities inside PhysicsCore
+     *
+     * Single precision by default. Configuring with PHYSICS_DOUBLE_PRECISION=ON
+     * keeps state, integration and the octree in double, so bodies 1e12 m from the
+     * origin still resolve millimetres instead of kilometres. Forces, colliders
+     * and everything handed to the renderer stay float either way.
+     */
+#ifdef PHYSICS_DOUBLE_PRECISION
+    using Real = double;
+#else
+    using Real = float;
+#endif
+    using Vec3 = glm::vec<3, Real>;
+}
@@ -14,13 +14,13 @@ constexpr double kContactConductionDistance = 0.01;
 }
 
 void Physics::RigidBody::setScale(const glm::vec3& newScale) {
-    std::lock_guard<std::mutex> lock(stateMutex);
+    auto lock = lockState();
     scale = newScale;
     recomputeGeometry();
 }
 
 void Physics::RigidBody::setGeometry(const std::vector<glm::vec3>& vertices, const std::vector<unsigned int>& indices) {
-    std::lock_guard<std::mutex> lock(stateMutex);
+    auto lock = lockState();
     meshVertices = vertices;
     meshIndices = indices;
     recomputeGeometry();
@@ -37,11 +37,11 @@ void Physics::RigidBody::recomputeGeometry() {
         area += 0.5f * glm::length(glm::cross(b - a, c - a));
     }
 
-    surfaceArea = area;
+    setSurfaceArea(area);
 }
 
 Physics::RigidBody::RigidBody(uint32_t id, double m, std::unique_ptr<Bounding::ICollider> col, glm::vec3 pos, bool bodyStatic) : PhysicsBody(id) {
-    std::lock_guard<std::mutex> lock(stateMutex);
+    auto lock = lockState();
     setMass(m, BodyLock::NOLOCK);
     setPosition(pos, BodyLock::NOLOCK);
     setWorldTransform(glm::translate(glm::mat4(1.0f), pos), BodyLock::NOLOCK);
@@ -50,7 +50,7 @@ Physics::RigidBody::RigidBody(uint32_t id, double m, std::unique_ptr<Bounding::I
 }
 
 Physics::RigidBody::RigidBody(uint32_t id, std::unique_ptr<Bounding::ICollider> col, glm::vec3 pos, bool bodyStatic) : PhysicsBody(id) {
-    std::lock_guard<std::mutex> lock(stateMutex);
+    auto lock = lockState();
     collider = std::move(col);
     setIsStatic(bodyStatic, BodyLock::NOLOCK);
     setPosition(pos, BodyLock::NOLOCK);
@@ -61,15 +61,15 @@ Physics::RigidBody::RigidBody(uint32_t id, std::unique_ptr<Bounding::ICollider>
 void Physics::RigidBody::recordFrame(float t, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
-    frames.push_back( {this, t, getPosition(BodyLock::NOLOCK), getVelocity(BodyLock::NOLOCK), static_cast<float>(getThermalProperties(BodyLock::NOLOCK).tempK)} );
+    frames.push( {t, getPosition(BodyLock::NOLOCK), getVelocity(BodyLock::NOLOCK), static_cast<float>(getThermalProperties(BodyLock::NOLOCK).tempK)} );
 }
 
 void Physics::RigidBody::loadFrame(const ObjectSnapshot &snapshot, BodyLock lock) {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
 
     setPosition(snapshot.position, BodyLock::NOLOCK);
     setVelocity(snapshot.velocity, BodyLock::NOLOCK);
@@ -78,27 +78,51 @@ void Physics::RigidBody::loadFrame(const ObjectSnapshot &snapshot, BodyLock lock
     setThermalProperty(props, BodyLock::NOLOCK);
 }
 
-void Physics::RigidBody::step(float dt, BodyLock lock) {
+std::unique_ptr<Physics::PhysicsBody> Physics::RigidBody::clone(BodyLock lock) const {
     std::unique_lock<std::mutex> maybeLock;
     if (lock == BodyLock::LOCK)
-        maybeLock = std::unique_lock<std::mutex>(stateMutex);
+        maybeLock = lockState();
+
+    auto copy = std::make_unique<RigidBody>(getID(), collider ? collider->clone() : nullptr);
+    copy->copyStateFrom(*this);
+    copy->scale = scale;
+    copy->meshVertices = meshVertices;
+    copy->meshIndices = meshIndices;
+    return copy;
+}
 
-    glm::vec3 acceleration = getNetForce(BodyLock::NOLOCK) / static_cast<float>(getMass(BodyLock::NOLOCK));
-    glm::vec3 posIncrement = getVelocity(BodyLock::NOLOCK) * dt + 0.5f * acceleration * dt * dt;
-    setPosition(getPosition(BodyLock::NOLOCK) + posIncrement, BodyLock::NOLOCK);
-    setWorldTransform(glm::translate(getWorldTransform(BodyLock::NOLOCK), posIncrement), BodyLock::NOLOCK);
-    glm::vec3 newAcceleration = getNetForce(BodyLock::NOLOCK) / static_cast<float>(getMass(BodyLock::NOLOCK)); // if netForce changed during the step
-    setVelocity(getVelocity(BodyLock::NOLOCK) + 0.5f * (acceleration + newAcceleration) * dt, BodyLock::NOLOCK);
+void Physics::RigidBody::step(float dt, BodyLock lock) {
+    std::unique_lock<std::mutex> maybeLock;
+    if (lock == BodyLock::LOCK)
+        maybeLock = lockState();
+
+    const double h = dt;
+    glm::dvec3 acceleration = glm::dvec3(getNetForce(BodyLock::NOLOCK)) / getMass(BodyLock::NOLOCK);
+    glm::dvec3 posIncrement = getVelocityPrecise(BodyLock::NOLOCK) * h + 0.5 * acceleration * h * h;
+    const glm::dvec3 position = getPositionPrecise(BodyLock::NOLOCK) + posIncrement;
+    setPositionPrecise(position, BodyLock::NOLOCK);
+    // Translation rebuilt from the precise position rather than accumulated in float
+    glm::mat4 transform = getWorldTransform(BodyLock::NOLOCK);
+    transform[3] = glm::vec4(glm::vec3(position), 1.0f);
+    setWorldTransform(transform, BodyLock::NOLOCK);
+    glm::dvec3 newAcceleration = glm::dvec3(getNetForce(BodyLock::NOLOCK)) / getMass(BodyLock::NOLOCK); // if netForce changed during the step
+    setVelocityPrecise(getVelocityPrecise(BodyLock::NOLOCK) + 0.5 * (acceleration + newAcceleration) * h, BodyLock::NOLOCK);
 }
 
 bool Physics::RigidBody::collidesWith(const PhysicsBody &other) const {
     return other.collidesWithRigidBody(*this);
 }
 
+std::unique_ptr<Physics::Bounding::ICollider> Physics::RigidBody::relativeCollider() const {
+    glm::mat4 M = getWorldTransform(BodyLock::NOLOCK);
+    M[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    return collider->getTransformed(M);
+}
+
 bool Physics::RigidBody::collidesWithPointMass(const PointMass &pm) const {
-    glm::mat4 M = getWorldTransform(BodyLock::LOCK);
-    auto worldCollider = collider->getTransformed(M);
-    return worldCollider->contains(pm.getPosition(BodyLock::LOCK));
+    const glm::dvec3 offset = pm.getPositionPrecise(BodyLock::LOCK) - getPositionPrecise(BodyLock::LOCK);
+    auto lock = lockState();
+    return relativeCollider()->contains(glm::vec3(offset));
 }
 
 bool Physics::RigidBody::collidesWithRigidBody(const RigidBody &rb) const {
@@ -110,9 +134,9 @@ bool Physics::RigidBody::resolveCollisionWith(float dt, PhysicsBody &other) {
 }
 
 bool Physics::RigidBody::resolveCollisionWithPointMass(float dt, PointMass &pm) {
-    std::lock_guard<std::mutex> lock(stateMutex);
-    auto worldCollider = collider->getTransformed(getWorldTransform(BodyLock::NOLOCK));
-    Bounding::ContactInfo ci = worldCollider->closestPoint(pm.getPosition(BodyLock::NOLOCK));
+    auto lock = lockState();
+    const glm::dvec3 offset = pm.getPositionPrecise(BodyLock::NOLOCK) - getPositionPrecise(BodyLock::NOLOCK);
+    Bounding::ContactInfo ci = relativeCollider()->closestPoint(glm::vec3(offset));
     if (ci.penetration < 0.0f) return false; // no overlap
 
     float vRel = glm::dot(pm.getVelocity(BodyLock::NOLOCK), ci.normal);
@@ -122,12 +146,11 @@ bool Physics::RigidBody::resolveCollisionWithPointMass(float dt, PointMass &pm)
     float j = -(1.0f + e) * vRel * static_cast<float>(pm.getMass(BodyLock::NOLOCK));
 
     pm.applyImpulse(j * ci.normal, BodyLock::NOLOCK);
-    glm::vec3 Fnet(0.0f);
-    for (auto const& [n, f] : pm.getAllForces(BodyLock::NOLOCK)) Fnet += f;
+    glm::vec3 Fnet = pm.getNetForce(BodyLock::NOLOCK);
     glm::vec3 Fn = -glm::dot(Fnet, ci.normal) * ci.normal;
 
-    pm.setForce("Normal", Fn, BodyLock::NOLOCK);
-    pm.setPosition(pm.getPosition(BodyLock::LOCK) + ci.normal * ci.penetration, BodyLock::NOLOCK);
+    pm.setForce(ForceRegistry::Normal, Fn, BodyLock::NOLOCK);
+    pm.setPositionPrecise(pm.getPositionPrecise(BodyLock::NOLOCK) + glm::dvec3(ci.normal * ci.penetration), BodyLock::NOLOCK);
 
     // Friction heat & Contact conduction
     ThermalProperties rbProps = getThermalProperties(BodyLock::NOLOCK);
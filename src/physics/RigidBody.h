@@ -20,6 +20,7 @@ namespace Physics {
 
         void recordFrame(float t, BodyLock lock) override;
         void loadFrame(const ObjectSnapshot &snapshot, BodyLock lock) override;
+        std::unique_ptr<PhysicsBody> clone(BodyLock lock) const override;
 
         Bounding::ICollider *getCollider() const override { return collider.get(); }
 
@@ -40,6 +41,9 @@ namespace Physics {
         std::vector<unsigned int> meshIndices;
 
         void recomputeGeometry();
+        // Collider placed at the origin: contact tests run in body-relative coordinates
+        // so they keep float precision far from the world origin (lock held)
+        std::unique_ptr<Bounding::ICollider> relativeCollider() const;
     };
 
 }
@@ -0,0 +1,26 @@
+#include "SleepIslands.h"
+
+#include <numeric>
+#include <utility>
+
+void Physics::IslandSet::reset(std::size_t count) {
+    parent.resize(count);
+    std::iota(parent.begin(), parent.end(), 0u);
+}
+
+std::uint32_t Physics::IslandSet::find(std::uint32_t slot) {
+    // Path halving keeps the trees flat without recursion
+    while (parent[slot] != slot) {
+        parent[slot] = parent[parent[slot]];
+        slot = parent[slot];
+    }
+    return slot;
+}
+
+void Physics::IslandSet::unite(std::uint32_t a, std::uint32_t b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    if (a > b) std::swap(a, b);
+    parent[b] = a; // lowest slot is the root, so islands come out in a fixed order
+}
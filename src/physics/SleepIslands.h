@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Physics {
+    struct SleepConfig {
+        bool enabled = false;
+        float linearThreshold = 0.05f;       // m/s
+        float accelerationThreshold = 0.05f; // m/s^2, net force over mass
+        double thermalThreshold = 1e-3;      // K/s
+        float timeToSleep = 0.5f;            // seconds below every threshold before a body may sleep
+    };
+
+    /**
+     * @brief Union-find over body slots, grouping bodies that touched this step
+     *
+     * A simulation island is a set of bodies connected through contacts. Islands
+     * fall asleep and wake up as a whole, so a body is never left frozen under one
+     * that keeps moving. Static bodies never join an island, otherwise a shared
+     * floor would tie every pile in the scene together.
+     */
+    class IslandSet {
+    public:
+        void reset(std::size_t count);
+        std::uint32_t find(std::uint32_t slot);
+        void unite(std::uint32_t a, std::uint32_t b);
+
+    private:
+        std::vector<std::uint32_t> parent;
+    };
+}
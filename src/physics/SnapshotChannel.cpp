@@ -0,0 +1,79 @@
+#include "SnapshotChannel.h"
+
+#include <cmath>
+
+std::vector<ObjectSnapshot>& Physics::SnapshotChannel::beginWrite() {
+    std::vector<ObjectSnapshot>& current = frames[back].current;
+    current.clear();
+    return current;
+}
+
+void Physics::SnapshotChannel::publish(std::uint64_t epoch) {
+    Frame& frame = frames[back];
+    frame.epoch = epoch;
+
+    // Never interpolate across an invalidation
+    if (epoch == lastPublishedEpoch) {
+        std::swap(frame.previous, lastPublished);
+    } else {
+        frame.previous.clear();
+    }
+    lastPublished.assign(frame.current.begin(), frame.current.end());
+    lastPublishedEpoch = epoch;
+
+    back = middle.exchange(static_cast<std::uint8_t>(back | kFresh), std::memory_order_acq_rel) & kIndexMask;
+}
+
+bool Physics::SnapshotChannel::read(float renderSimTime, std::uint64_t epoch, std::vector<ObjectSnapshot>& out) {
+    if (middle.load(std::memory_order_relaxed) & kFresh) {
+        front = middle.exchange(front, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    const Frame& frame = frames[front];
+    if (frame.epoch != epoch || frame.current.empty()) {
+        return false;
+    }
+
+    const std::vector<ObjectSnapshot>& previousSnapshots = frame.previous;
+    const std::vector<ObjectSnapshot>& currentSnapshots = frame.current;
+
+    if (previousSnapshots.size() != currentSnapshots.size()) {
+        out.assign(currentSnapshots.begin(), currentSnapshots.end());
+        return true;
+    }
+
+    float t0 = previousSnapshots[0].time;
+    float t1 = currentSnapshots[0].time;
+
+    if (!std::isfinite(t0) || !std::isfinite(t1) || t1 <= t0 || renderSimTime >= t1) {
+        out.assign(currentSnapshots.begin(), currentSnapshots.end());
+        return true;
+    }
+    if (renderSimTime <= t0) {
+        out.assign(previousSnapshots.begin(), previousSnapshots.end());
+        return true;
+    }
+
+    float alpha = (renderSimTime - t0) / (t1 - t0);
+
+    out.clear();
+    for (size_t i = 0; i < currentSnapshots.size(); ++i) {
+        const auto &A = previousSnapshots[i];
+        const auto &B = currentSnapshots[i];
+
+        if (A.body != B.body) {
+            out.push_back(B);
+            continue;
+        }
+
+        ObjectSnapshot C;
+        C.body     = A.body;
+        C.time     = renderSimTime;
+        C.position = glm::mix(A.position, B.position, alpha);
+        C.velocity = glm::mix(A.velocity, B.velocity, alpha);
+        C.temperature = glm::mix(A.temperature, B.temperature, alpha);
+
+        out.push_back(C);
+    }
+    return true;
+}
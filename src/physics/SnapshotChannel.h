@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "physics/PhysicsBody.h"
+
+namespace Physics {
+    /**
+     * @brief Lock-free triple buffer carrying body snapshots from the physics thread to the renderer
+     *
+     * The writer always owns one frame (back) and the reader another (front); the
+     * third sits in the shared middle slot. Publishing and acquiring are a single
+     * atomic exchange each, so neither side can ever block the other. Frame
+     * vectors are recycled, so once capacities have settled neither side allocates.
+     *
+     * Each frame carries the previously published positions too, which lets the
+     * reader interpolate between two physics steps without touching writer state.
+     * Frames are tagged with an epoch; bumping the epoch (body removed, runtime
+     * state cleared) makes the reader ignore every frame written before it.
+     *
+     * Exactly one writer thread and one reader thread may use a channel.
+     */
+    class SnapshotChannel {
+    public:
+        SnapshotChannel() = default;
+        SnapshotChannel(const SnapshotChannel&) = delete;
+        SnapshotChannel& operator=(const SnapshotChannel&) = delete;
+
+        /// Writer: returns the cleared back buffer to fill for the next publish()
+        std::vector<ObjectSnapshot>& beginWrite();
+
+        /// Writer: hands the back buffer to the reader, tagged with the given epoch
+        void publish(std::uint64_t epoch);
+
+        /**
+         * @brief Reader: writes the newest state, interpolated to renderSimTime, into out
+         *
+         * @return false if nothing has been published for this epoch yet (out is left untouched)
+         */
+        bool read(float renderSimTime, std::uint64_t epoch, std::vector<ObjectSnapshot>& out);
+
+    private:
+        struct Frame {
+            std::vector<ObjectSnapshot> previous;
+            std::vector<ObjectSnapshot> current;
+            std::uint64_t epoch = 0;
+        };
+
+        static constexpr std::uint8_t kIndexMask = 0x3;
+        static constexpr std::uint8_t kFresh = 0x4;
+
+        std::array<Frame, 3> frames{};
+        std::atomic<std::uint8_t> middle{1};
+        std::uint8_t back = 0;  // writer only
+        std::uint8_t front = 2; // reader only
+
+        // Writer only: last published frame, becomes the next frame's `previous`
+        std::vector<ObjectSnapshot> lastPublished;
+        std::uint64_t lastPublishedEpoch = 0;
+    };
+}
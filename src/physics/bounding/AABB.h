@@ -9,6 +9,7 @@ namespace Physics::Bounding{
 
         AABB(const glm::vec3& center, const glm::vec3& halfExtents);
         std::unique_ptr<ICollider> getTransformed(const glm::mat4 &modelMatrix) const override;
+        std::unique_ptr<ICollider> clone() const override { return std::make_unique<AABB>(*this); }
 
         bool intersectsAABB(const AABB& other) const;
         std::optional<float> intersectRay(const Math::Ray& ray) const override;
@@ -9,6 +9,7 @@ namespace Physics::Bounding {
         BoxCollider(const glm::vec3& center, const glm::vec3& halfExtents, const glm::quat& rotation);
 
         std::unique_ptr<ICollider> getTransformed(const glm::mat4 &modelMatrix) const override;
+        std::unique_ptr<ICollider> clone() const override { return std::make_unique<BoxCollider>(*this); }
 
         bool contains(const glm::vec3 &p) const override;
 
@@ -120,6 +120,15 @@ namespace Physics::Bounding {
          */
         virtual std::unique_ptr<ICollider> getTransformed(const glm::mat4& modelMatrix) const = 0;
 
+        /**
+         * @brief Creates an exact copy of this collider in its own space
+         *
+         * Used when a PhysicsBody is deep-copied into another PhysicsSystem.
+         *
+         * @return Unique pointer to the copy (ownership transferred)
+         */
+        virtual std::unique_ptr<ICollider> clone() const = 0;
+
         /**
          * @brief Tests ray-collider intersection
          *
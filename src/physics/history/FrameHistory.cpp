@@ -0,0 +1,178 @@
+#include "FrameHistory.h"
+
+#include <algorithm>
+#include <cstring>
+
+Physics::FrameHistory::~FrameHistory() {
+    releaseSpilled();
+}
+
+void Physics::FrameHistory::configure(std::size_t windowFrames, std::shared_ptr<FrameSpillFile> newSpill) {
+    window = windowFrames == 0 ? 0 : std::max(windowFrames, FrameSpillFile::kChunkFrames);
+
+    if (newSpill != spill) {
+        // Chunks belong to the old file, copy them over or give up on them
+        std::vector<FrameRecord*> moved;
+        while (newSpill && moved.size() < spilled.size()) {
+            FrameRecord* target = newSpill->allocateChunk();
+            if (!target) break;
+            moved.push_back(target);
+        }
+
+        // Keep the newest chunks so they stay contiguous with the in-memory frames
+        const std::size_t lost = spilled.size() - moved.size();
+        if (lost > 0) {
+            if (!origin) origin = at(0);
+            dropped += lost * FrameSpillFile::kChunkFrames;
+        }
+        for (std::size_t i = 0; i < moved.size(); ++i) {
+            std::memcpy(moved[i], spilled[lost + i], FrameSpillFile::kChunkBytes);
+        }
+        releaseSpilled();
+        spilled.assign(moved.begin(), moved.end());
+        spill = std::move(newSpill);
+    }
+
+    if (window == 0 && size() > 0) {
+        // History off: everything but the pinned first frame goes, spilled frames first
+        if (!origin) origin = at(0);
+        dropped += spilledFrames() + hot.size();
+        releaseSpilled();
+        hot.clear();
+    }
+    while (hot.size() > window) {
+        evictOldestChunk();
+    }
+}
+
+void Physics::FrameHistory::push(const FrameRecord& record) {
+    if (window == 0) {
+        // History off: pin the first frame and only count the rest
+        if (!origin) origin = record;
+        ++dropped;
+        return;
+    }
+    hot.push_back(record);
+    if (hot.size() >= window + FrameSpillFile::kChunkFrames) {
+        evictOldestChunk();
+    }
+}
+
+void Physics::FrameHistory::clear() {
+    releaseSpilled();
+    hot.clear();
+    origin.reset();
+    dropped = 0;
+}
+
+void Physics::FrameHistory::assign(const FrameHistory& other) {
+    if (&other == this) return;
+    clear();
+    std::size_t first = 0;
+    if (other.origin) {
+        // Dropped frames stay dropped, but keep their count so recordedFrames() matches
+        origin = other.origin;
+        dropped = other.dropped;
+        first = 1;
+    }
+    for (std::size_t i = first; i < other.size(); ++i) {
+        push(other.at(i));
+    }
+}
+
+void Physics::FrameHistory::truncate(std::size_t recordedCount) {
+    if (recordedCount >= recordedFrames()) return;
+    if (recordedCount == 0) {
+        clear();
+        return;
+    }
+    if (recordedCount <= dropped) {
+        // Everything kept was already dropped, only the pinned origin is left
+        releaseSpilled();
+        hot.clear();
+        dropped = recordedCount;
+        return;
+    }
+
+    const std::size_t keep = recordedCount - dropped; // frames after the dropped ones
+    const std::size_t spilledCount = spilledFrames();
+    if (keep >= spilledCount) {
+        hot.erase(hot.begin() + static_cast<std::ptrdiff_t>(keep - spilledCount), hot.end());
+        return;
+    }
+
+    const std::size_t fullChunks = keep / FrameSpillFile::kChunkFrames;
+    const std::size_t partial = keep % FrameSpillFile::kChunkFrames;
+    hot.clear();
+    if (partial > 0) {
+        hot.assign(spilled[fullChunks], spilled[fullChunks] + partial);
+    }
+    for (std::size_t i = fullChunks; i < spilled.size(); ++i) {
+        spill->releaseChunk(spilled[i]);
+    }
+    spilled.resize(fullChunks);
+}
+
+std::size_t Physics::FrameHistory::size() const {
+    return (origin ? 1 : 0) + spilledFrames() + hot.size();
+}
+
+Physics::FrameHistory::View Physics::FrameHistory::view(PhysicsBody* owner) const {
+    return View(this, owner);
+}
+
+const Physics::FrameRecord& Physics::FrameHistory::at(std::size_t index) const {
+    if (origin) {
+        if (index == 0) return *origin;
+        --index;
+    }
+    const std::size_t spilledCount = spilledFrames();
+    if (index < spilledCount) {
+        return spilled[index / FrameSpillFile::kChunkFrames][index % FrameSpillFile::kChunkFrames];
+    }
+    return hot[index - spilledCount];
+}
+
+void Physics::FrameHistory::evictOldestChunk() {
+    const std::size_t count = std::min(hot.size(), FrameSpillFile::kChunkFrames);
+    FrameRecord* chunk = count == FrameSpillFile::kChunkFrames && spill ? spill->allocateChunk() : nullptr;
+    if (!chunk && count == FrameSpillFile::kChunkFrames && !spilled.empty()) {
+        // Spill full: drop its oldest chunk and reuse it, so dropped frames stay the oldest ones
+        if (!origin) origin = at(0);
+        dropped += FrameSpillFile::kChunkFrames;
+        chunk = spilled.front();
+        spilled.pop_front();
+    }
+
+    if (chunk) {
+        std::copy_n(hot.begin(), count, chunk);
+        spilled.push_back(chunk);
+    } else {
+        if (!origin) origin = at(0);
+        dropped += count;
+    }
+    hot.erase(hot.begin(), hot.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+void Physics::FrameHistory::releaseSpilled() {
+    if (spill) {
+        for (const FrameRecord* chunk : spilled) {
+            spill->releaseChunk(chunk);
+        }
+    }
+    spilled.clear();
+}
+
+ObjectSnapshot Physics::FrameHistory::View::operator[](std::size_t index) const {
+    const FrameRecord& record = history->at(index);
+    return { owner, record.time, record.position, record.velocity, record.temperature };
+}
+
+std::vector<ObjectSnapshot> Physics::FrameHistory::View::toVector() const {
+    std::vector<ObjectSnapshot> out;
+    out.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i) {
+        out.push_back((*this)[i]);
+    }
+    return out;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "physics/history/FrameSpillFile.h"
+
+namespace Physics {
+    class PhysicsBody;
+}
+
+struct ObjectSnapshot {
+    Physics::PhysicsBody* body;
+    float time;
+    glm::vec3 position;
+    glm::vec3 velocity;
+    float temperature;
+};
+
+namespace Physics {
+    struct FrameHistoryConfig {
+        std::size_t windowFrames = 4096;             // frames kept in memory per body, 0 keeps only the first frame
+        bool spillToDisk = true;                     // move older frames to a mapped file instead of dropping them
+        std::filesystem::path spillDirectory;        // empty for the system temp directory
+        std::size_t maxSpillBytes = std::size_t(4) << 30;
+    };
+
+    /**
+     * @brief Per-body recorded trajectory with a bounded in-memory window
+     *
+     * The newest frames live in memory. Once the window is full the oldest
+     * FrameSpillFile::kChunkFrames frames are copied into a spill chunk as one
+     * block, or dropped if there is no spill. A full spill drops its own oldest
+     * chunk to make room, so dropped frames are always the oldest ones. The first
+     * recorded frame is pinned so the reset state of the trajectory survives dropping.
+     *
+     * Reads go through View, which presents [pinned origin] + spilled + in-memory
+     * frames as one time-ordered random-access sequence of ObjectSnapshot.
+     * Like the vector it replaces, the caller must hold the owner's lockState().
+     */
+    class FrameHistory {
+    public:
+        class View;
+
+        FrameHistory() = default;
+        ~FrameHistory();
+
+        FrameHistory(const FrameHistory&) = delete;
+        FrameHistory& operator=(const FrameHistory&) = delete;
+
+        /**
+         * @brief Sets the window and spill target, moving already spilled frames if the spill changes
+         * @param windowFrames 0 records nothing past the pinned first frame, other values are clamped to at least one chunk
+         * @param spill May be null to drop frames past the window
+         */
+        void configure(std::size_t windowFrames, std::shared_ptr<FrameSpillFile> spill);
+
+        void push(const FrameRecord& record);
+        void clear();
+        // Replaces the frames with a copy of other's, kept under this history's own window and spill
+        void assign(const FrameHistory& other);
+        // Keeps the frames recorded before the recordedFrames() value given, pulling a partially
+        // kept spill chunk back into memory. Dropped frames stay counted, so a count taken before
+        // frames were dropped still names the same frame afterwards
+        void truncate(std::size_t recordedCount);
+
+        std::size_t size() const;
+        // Frames pushed since the last clear(), including dropped ones; the index the next push gets
+        std::size_t recordedFrames() const { return dropped + spilledFrames() + hot.size(); }
+        std::size_t residentFrames() const { return hot.size(); }
+        std::size_t spilledFrames() const { return spilled.size() * FrameSpillFile::kChunkFrames; }
+        std::size_t droppedFrames() const { return dropped; }
+
+        View view(PhysicsBody* owner) const;
+
+    private:
+        const FrameRecord& at(std::size_t index) const;
+        void evictOldestChunk();
+        void releaseSpilled();
+
+        std::size_t window = FrameHistoryConfig{}.windowFrames;
+        std::shared_ptr<FrameSpillFile> spill;
+
+        std::deque<FrameRecord> hot;
+        std::deque<FrameRecord*> spilled; // full chunks, oldest first
+        std::optional<FrameRecord> origin;       // set once the first frame has been dropped
+        std::size_t dropped = 0;
+    };
+
+    /**
+     * @brief Read-only, vector-like view of a FrameHistory
+     *
+     * Elements are materialised as ObjectSnapshot by value, so references into
+     * the view are not stable; copy what you need. toVector() copies everything
+     * for consumers that keep the frames past the lock.
+     */
+    class FrameHistory::View {
+    public:
+        class const_iterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = ObjectSnapshot;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = ObjectSnapshot;
+
+            const_iterator() = default;
+
+            ObjectSnapshot operator*() const { return (*view)[index]; }
+            ObjectSnapshot operator[](difference_type n) const { return (*view)[index + n]; }
+
+            const_iterator& operator++() { ++index; return *this; }
+            const_iterator operator++(int) { auto copy = *this; ++index; return copy; }
+            const_iterator& operator--() { --index; return *this; }
+            const_iterator operator--(int) { auto copy = *this; --index; return copy; }
+            const_iterator& operator+=(difference_type n) { index += n; return *this; }
+            const_iterator& operator-=(difference_type n) { index -= n; return *this; }
+            friend const_iterator operator+(const_iterator it, difference_type n) { return it += n; }
+            friend const_iterator operator+(difference_type n, const_iterator it) { return it += n; }
+            friend const_iterator operator-(const_iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const const_iterator& a, const const_iterator& b) {
+                return static_cast<difference_type>(a.index) - static_cast<difference_type>(b.index);
+            }
+            friend auto operator<=>(const const_iterator& a, const const_iterator& b) { return a.index <=> b.index; }
+            friend bool operator==(const const_iterator& a, const const_iterator& b) { return a.index == b.index; }
+
+        private:
+            friend class View;
+            const_iterator(const View* view, std::size_t index) : view(view), index(index) {}
+
+            const View* view = nullptr;
+            std::size_t index = 0;
+        };
+
+        std::size_t size() const { return history->size(); }
+        bool empty() const { return size() == 0; }
+        std::size_t recordedFrames() const { return history->recordedFrames(); }
+
+        ObjectSnapshot operator[](std::size_t index) const;
+        ObjectSnapshot front() const { return (*this)[0]; }
+        ObjectSnapshot back() const { return (*this)[size() - 1]; }
+
+        const_iterator begin() const { return {this, 0}; }
+        const_iterator end() const { return {this, size()}; }
+
+        std::vector<ObjectSnapshot> toVector() const;
+
+    private:
+        friend class FrameHistory;
+        View(const FrameHistory* history, PhysicsBody* owner) : history(history), owner(owner) {}
+
+        const FrameHistory* history;
+        PhysicsBody* owner;
+    };
+}
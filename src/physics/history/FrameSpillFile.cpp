@@ -0,0 +1,147 @@
+#include "FrameSpillFile.h"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr std::size_t kSegmentBytes = Physics::FrameSpillFile::kChunkBytes * Physics::FrameSpillFile::kSegmentChunks;
+
+    std::filesystem::path uniqueSpillPath(const std::filesystem::path& directory) {
+        static std::atomic<unsigned> counter{0};
+#ifdef _WIN32
+        const unsigned long pid = GetCurrentProcessId();
+#else
+        const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+        return directory / ("physics-frames-" + std::to_string(pid) + "-" + std::to_string(counter++) + ".spill");
+    }
+}
+
+Physics::FrameSpillFile::FrameSpillFile(std::filesystem::path dir, std::size_t maxBytes)
+    : directory(std::move(dir)), maxBytes(maxBytes) {}
+
+Physics::FrameSpillFile::~FrameSpillFile() {
+    std::lock_guard<std::mutex> lock(mutex);
+    close();
+}
+
+Physics::FrameRecord* Physics::FrameSpillFile::allocateChunk() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!freeChunks.empty()) {
+        FrameRecord* chunk = freeChunks.back();
+        freeChunks.pop_back();
+        return chunk;
+    }
+
+    if (chunksUsedInLastSegment == kSegmentChunks && !growSegment()) {
+        return nullptr;
+    }
+
+    auto* base = static_cast<FrameRecord*>(segments.back());
+    return base + (chunksUsedInLastSegment++) * kChunkFrames;
+}
+
+void Physics::FrameSpillFile::releaseChunk(const FrameRecord* chunk) {
+    if (!chunk) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    freeChunks.push_back(const_cast<FrameRecord*>(chunk));
+}
+
+std::size_t Physics::FrameSpillFile::mappedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return segments.size() * kSegmentBytes;
+}
+
+bool Physics::FrameSpillFile::open() {
+    std::error_code ec;
+    std::filesystem::path dir = directory.empty() ? std::filesystem::temp_directory_path(ec) : directory;
+    if (ec) return false;
+    path = uniqueSpillPath(dir);
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    fileHandle = handle;
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fileDescriptor < 0) return false;
+    // Nothing else needs the name, drop it now so a crash leaves nothing behind
+    ::unlink(path.c_str());
+#endif
+    return true;
+}
+
+bool Physics::FrameSpillFile::growSegment() {
+    if (failed) return false;
+    const std::size_t newSize = (segments.size() + 1) * kSegmentBytes;
+    if (newSize > maxBytes) return false;
+
+    const bool isOpen =
+#ifdef _WIN32
+        fileHandle != nullptr;
+#else
+        fileDescriptor >= 0;
+#endif
+    if (!isOpen && !open()) {
+        failed = true;
+        std::cerr << "[FrameSpillFile] Warning: could not create spill file, old frames will be dropped.\n";
+        return false;
+    }
+
+    const std::uint64_t offset = static_cast<std::uint64_t>(segments.size()) * kSegmentBytes;
+    void* view = nullptr;
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingW(static_cast<HANDLE>(fileHandle), nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<std::uint64_t>(newSize) >> 32),
+                                        static_cast<DWORD>(newSize & 0xFFFFFFFFu), nullptr);
+    if (mapping) {
+        view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS,
+                             static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset & 0xFFFFFFFFu), kSegmentBytes);
+        CloseHandle(mapping); // the view keeps the mapping alive
+    }
+#else
+    if (::ftruncate(fileDescriptor, static_cast<off_t>(newSize)) == 0) {
+        view = ::mmap(nullptr, kSegmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, static_cast<off_t>(offset));
+        if (view == MAP_FAILED) view = nullptr;
+    }
+#endif
+    if (!view) {
+        failed = true;
+        std::cerr << "[FrameSpillFile] Warning: could not map spill segment, old frames will be dropped.\n";
+        return false;
+    }
+
+    segments.push_back(view);
+    chunksUsedInLastSegment = 0;
+    return true;
+}
+
+void Physics::FrameSpillFile::close() {
+    for (void* segment : segments) {
+#ifdef _WIN32
+        UnmapViewOfFile(segment);
+#else
+        ::munmap(segment, kSegmentBytes);
+#endif
+    }
+    segments.clear();
+    freeChunks.clear();
+
+#ifdef _WIN32
+    if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle)); // FILE_FLAG_DELETE_ON_CLOSE removes it
+    fileHandle = nullptr;
+#else
+    if (fileDescriptor >= 0) ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+}
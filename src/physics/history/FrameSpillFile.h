@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Physics {
+    /**
+     * @brief Compact per-step record of one body, what ObjectSnapshot holds minus the body pointer
+     */
+    struct FrameRecord {
+        float time;
+        glm::vec3 position;
+        glm::vec3 velocity;
+        float temperature;
+    };
+
+    /**
+     * @brief Memory-mapped file that old frame history chunks are spilled into
+     *
+     * The file grows in fixed-size segments, each mapped once and kept mapped
+     * until the spill is destroyed, so a chunk pointer stays valid for as long as
+     * the chunk is allocated and readers never need the spill's lock. Released
+     * chunks are recycled. The file is created lazily on the first allocation and
+     * deleted again in the destructor.
+     *
+     * allocateChunk() is thread-safe; bodies spill concurrently from the parallel
+     * recordFrames phase.
+     */
+    class FrameSpillFile {
+    public:
+        static constexpr std::size_t kChunkFrames = 1024;
+        static constexpr std::size_t kChunkBytes = kChunkFrames * sizeof(FrameRecord);
+        static constexpr std::size_t kSegmentChunks = 1024; // 32 MiB segments
+
+        /**
+         * @param directory Where to create the file, empty for the system temp directory
+         * @param maxBytes Upper bound on the file size, allocation fails beyond it
+         */
+        FrameSpillFile(std::filesystem::path directory, std::size_t maxBytes);
+        ~FrameSpillFile();
+
+        FrameSpillFile(const FrameSpillFile&) = delete;
+        FrameSpillFile& operator=(const FrameSpillFile&) = delete;
+
+        /// Returns storage for kChunkFrames records, or nullptr if the file can't grow
+        FrameRecord* allocateChunk();
+        void releaseChunk(const FrameRecord* chunk);
+
+        std::size_t mappedBytes() const;
+
+    private:
+        bool open();
+        bool growSegment();
+        void close();
+
+        mutable std::mutex mutex;
+        std::filesystem::path directory;
+        std::filesystem::path path;
+        std::size_t maxBytes;
+        bool failed = false;
+
+        std::vector<void*> segments;
+        std::size_t chunksUsedInLastSegment = kSegmentChunks;
+        std::vector<FrameRecord*> freeChunks;
+
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+#else
+        int fileDescriptor = -1;
+#endif
+    };
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace Physics {
+    class PhysicsBody;
+    class PhysicsSystem;
+
+    /**
+     * @brief Complete PhysicsSystem state at one instant, restorable in place
+     *
+     * Every BodyStore column except the owners is held as one flat byte buffer,
+     * next to each body's recorded frame count, simTime and the step counter.
+     * Capturing into the same checkpoint again reuses its buffer, and restoring is
+     * a memcpy per column plus a frame truncation, so a solver can rewind the
+     * scene once per guess without replaying snapshots through the body setters.
+     *
+     * A checkpoint only restores onto the exact body set, in store order, it was
+     * captured from.
+     */
+    class StateCheckpoint {
+    public:
+        bool empty() const { return owners.empty(); }
+        bool matches(const std::vector<PhysicsBody*>& bodies) const { return !owners.empty() && owners == bodies; }
+        std::size_t bytes() const { return state.size(); }
+        double getSimTime() const { return simTime; }
+
+        void clear() {
+            state.clear();
+            owners.clear();
+            frameCounts.clear();
+            simTime = 0.0;
+            stepCount = 0;
+        }
+
+    private:
+        friend class PhysicsSystem;
+
+        std::vector<std::byte> state;
+        std::vector<PhysicsBody*> owners;
+        std::vector<std::size_t> frameCounts;
+        double simTime = 0.0;
+        long long stepCount = 0;
+    };
+}
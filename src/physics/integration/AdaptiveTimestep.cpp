@@ -0,0 +1,33 @@
+#include "AdaptiveTimestep.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double kSafety = 0.9;
+    constexpr double kMinScale = 0.2;
+    constexpr double kMaxScale = 5.0;
+    constexpr float kInitialDt = 1.0f / 1000.0f;
+}
+
+void Physics::StepSizeController::configure(const AdaptiveTimestepConfig& newConfig) {
+    config = newConfig;
+    config.minDt = std::max(config.minDt, 0.0f);
+    config.maxDt = std::max(config.maxDt, config.minDt);
+    next = std::clamp(kInitialDt, config.minDt, config.maxDt);
+}
+
+bool Physics::StepSizeController::update(float dt, double error, int order) {
+    const bool accepted = error <= 1.0 || dt <= config.minDt;
+
+    const double scale = error > 0.0
+        ? std::clamp(kSafety * std::pow(error, -1.0 / static_cast<double>(order + 1)), kMinScale, kMaxScale)
+        : kMaxScale;
+    float wanted = static_cast<float>(dt * scale);
+    if (accepted && dt < next) {
+        // A step cut short by the caller says little about the size that would still fit
+        wanted = std::max(wanted, next);
+    }
+    next = std::clamp(wanted, config.minDt, config.maxDt);
+    return accepted;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+namespace Physics {
+    struct AdaptiveTimestepConfig {
+        bool enabled = false;
+        double relativeTolerance = 1e-6;  // allowed local error per step, as a fraction of how far each body moved in it
+        double absoluteTolerance = 1e-6;  // meters, floor for bodies that barely move
+        float minDt = 1e-6f;              // steps are accepted here even if they miss the tolerance
+        float maxDt = 1.0f;               // seconds, raise it for orbital scenes
+        double maxSceneFraction = 0.05;   // no body moves more than this fraction of the bodies' bounding box diagonal per step, 0 for no limit
+    };
+
+    /**
+     * @brief Picks the next step size from the error of the last one
+     *
+     * PhysicsSystem estimates the local error of a step by step doubling: one step
+     * of dt against two of dt / 2, which for an integrator of order p differ by
+     * about (2^p - 1) times the error of the two half steps. The error is scaled by
+     * the tolerance, so 1 is exactly on it. A step is accepted at <= 1 and the next
+     * one scaled by 0.9 * error^(-1 / (p + 1)), kept within [0.2, 5], so
+     * step sizes track the tolerance instead of the wall clock. Rejected steps are
+     * retried with the shrunk size.
+     */
+    class StepSizeController {
+    public:
+        void configure(const AdaptiveTimestepConfig& config);
+        const AdaptiveTimestepConfig& getConfig() const { return config; }
+
+        /// Size of the next step to try
+        float proposed() const { return next; }
+
+        /**
+         * @brief Takes the scaled error of a step and updates the proposal
+         * @param order integratorOrder() of the integrator that took it
+         * @return true if the step is accepted
+         */
+        bool update(float dt, double error, int order);
+
+    private:
+        AdaptiveTimestepConfig config;
+        float next = 1.0f / 1000.0f;
+    };
+}
@@ -0,0 +1,53 @@
+#include "BlockTimestep.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Enough for dt / 2^20, deeper hierarchies only add empty sub-steps
+    constexpr int kMaxSupportedLevel = 20;
+    constexpr float kMinJerk = 1e-30f;
+}
+
+void Physics::BlockScheduler::configure(const BlockTimestepConfig& newConfig) {
+    config = newConfig;
+    config.maxLevel = std::clamp(config.maxLevel, 0, kMaxSupportedLevel);
+    reset(levels.size());
+}
+
+void Physics::BlockScheduler::reset(std::size_t bodyCount) {
+    levels.assign(bodyCount, static_cast<std::int8_t>(config.maxLevel));
+    openAccelerations.assign(bodyCount, glm::vec3(0.0f));
+    hasOpened.assign(bodyCount, 0);
+}
+
+void Physics::BlockScheduler::open(std::size_t body, const glm::vec3& acceleration) {
+    openAccelerations[body] = acceleration;
+    hasOpened[body] = 1;
+}
+
+void Physics::BlockScheduler::close(std::size_t body, std::uint32_t subStep, const glm::vec3& acceleration, float stepSize, float dt) {
+    if (!hasOpened[body] || stepSize <= 0.0f) return;
+
+    const float jerk = glm::length(acceleration - openAccelerations[body]) / stepSize;
+    const float accel = glm::length(acceleration);
+    // Constant acceleration is integrated exactly by any step
+    const int wanted = jerk > kMinJerk ? levelFor(config.accuracy * accel / jerk, dt) : 0;
+
+    int current = levels[body];
+    if (wanted > current) {
+        current = wanted;
+    } else if (wanted < current) {
+        // Coarsen by one, and only where the doubled step begins
+        const std::uint32_t coarserStride = 1u << (config.maxLevel - current + 1);
+        if (subStep % coarserStride == 0) --current;
+    }
+    levels[body] = static_cast<std::int8_t>(current);
+}
+
+int Physics::BlockScheduler::levelFor(float requested, float dt) const {
+    if (!(requested > 0.0f) || dt <= 0.0f) return config.maxLevel;
+    if (requested >= dt) return 0;
+    const int level = static_cast<int>(std::ceil(std::log2(dt / requested)));
+    return std::clamp(level, 0, config.maxLevel);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Physics {
+    struct BlockTimestepConfig {
+        bool enabled = false;
+        int maxLevel = 8;        // finest body step is dt / 2^maxLevel
+        float accuracy = 0.02f;  // eta in the step criterion dt_i = eta * |a| / |da/dt|
+    };
+
+    /**
+     * @brief Hierarchical power-of-two timestep levels for the bodies of a store
+     *
+     * A step of size dt is split into 2^maxLevel sub-steps. A body on level k
+     * advances dt / 2^k at a time, so it is due every 2^(maxLevel - k) sub-steps
+     * and every level lines up again at the end of dt. The scheduler only does
+     * the bookkeeping; PhysicsSystem kicks and drifts the bodies.
+     *
+     * After each of its steps a body asks for dt_i = eta * |a| / |jerk|, with the
+     * jerk taken from the change in acceleration across that step. It moves to a
+     * finer level at once but to a coarser one only one level at a time and only
+     * where the coarser block starts, which keeps the hierarchy synchronised.
+     * Bodies with no jerk estimate yet start on the finest level.
+     *
+     * Every body writes only its own index, so open() and close() may run in parallel.
+     */
+    class BlockScheduler {
+    public:
+        void configure(const BlockTimestepConfig& config);
+        const BlockTimestepConfig& getConfig() const { return config; }
+
+        /// Forgets every body's level and history, e.g. after bodies were added or removed
+        void reset(std::size_t bodyCount);
+        std::size_t size() const { return levels.size(); }
+
+        std::uint32_t subSteps() const { return 1u << config.maxLevel; }
+        int level(std::size_t body) const { return levels[body]; }
+        /// Sub-steps per step of the body
+        std::uint32_t stride(std::size_t body) const { return 1u << (config.maxLevel - levels[body]); }
+        bool isDue(std::size_t body, std::uint32_t subStep) const { return subStep % stride(body) == 0; }
+
+        /// Marks the start of a body's step with the acceleration it is kicked with
+        void open(std::size_t body, const glm::vec3& acceleration);
+        /**
+         * @brief Ends a body's step at subStep and picks the level of its next step
+         * @param stepSize Length of the step that just ended
+         */
+        void close(std::size_t body, std::uint32_t subStep, const glm::vec3& acceleration, float stepSize, float dt);
+
+        /// Level whose step is the largest power-of-two fraction of dt not above requested
+        int levelFor(float requested, float dt) const;
+
+    private:
+        BlockTimestepConfig config;
+        std::vector<std::int8_t> levels;
+        std::vector<glm::vec3> openAccelerations;
+        std::vector<std::uint8_t> hasOpened;
+    };
+}
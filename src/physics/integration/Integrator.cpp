@@ -0,0 +1,134 @@
+#include "Integrator.h"
+
+#include <cmath>
+
+#include "physics/integration/WisdomHolman.h"
+
+namespace {
+    constexpr std::size_t kIntegrateGrain = 512;
+
+    // Drift weights of a symmetric composition of leapfrog steps, turned into KDK form
+    std::vector<double> kicksFor(const std::vector<double>& drifts) {
+        std::vector<double> kicks(drifts.size() + 1, 0.0);
+        for (std::size_t i = 0; i < drifts.size(); ++i) {
+            kicks[i] += 0.5 * drifts[i];
+            kicks[i + 1] += 0.5 * drifts[i];
+        }
+        return kicks;
+    }
+
+    std::vector<double> tripleJump(const std::vector<double>& inner, double w1, double w0) {
+        std::vector<double> out;
+        for (double w : { w1, w0, w1 }) {
+            for (double d : inner) out.push_back(w * d);
+        }
+        return out;
+    }
+}
+
+const char* Physics::integratorName(IntegratorType type) {
+    switch (type) {
+        case IntegratorType::VelocityVerlet: return "VelocityVerlet";
+        case IntegratorType::LeapfrogKDK: return "LeapfrogKDK";
+        case IntegratorType::Yoshida4: return "Yoshida4";
+        case IntegratorType::Yoshida6: return "Yoshida6";
+        case IntegratorType::WisdomHolman: return "WisdomHolman";
+    }
+    return "Unknown";
+}
+
+int Physics::integratorOrder(IntegratorType type) {
+    switch (type) {
+        case IntegratorType::VelocityVerlet: return 1;
+        case IntegratorType::LeapfrogKDK: return 2;
+        case IntegratorType::Yoshida4: return 4;
+        case IntegratorType::Yoshida6: return 6;
+        case IntegratorType::WisdomHolman: return 2;
+    }
+    return 1;
+}
+
+std::unique_ptr<Physics::IIntegrator> Physics::makeIntegrator(IntegratorType type) {
+    switch (type) {
+        case IntegratorType::VelocityVerlet: return std::make_unique<VelocityVerletIntegrator>();
+        case IntegratorType::LeapfrogKDK: return SplittingIntegrator::leapfrog();
+        case IntegratorType::Yoshida4: return SplittingIntegrator::yoshida4();
+        case IntegratorType::Yoshida6: return SplittingIntegrator::yoshida6();
+        case IntegratorType::WisdomHolman: return std::make_unique<WisdomHolmanIntegrator>();
+    }
+    return std::make_unique<VelocityVerletIntegrator>();
+}
+
+void Physics::VelocityVerletIntegrator::advance(IntegrationContext& ctx, float dt) {
+    BodyStore& store = ctx.store;
+    ctx.pool.parallelFor(store.size(), kIntegrateGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (store.isFrozen(i)) continue;
+
+            // Velocity Verlet with the force held constant across the step
+            const Real h = dt;
+            Vec3 acceleration = Vec3(store.netForces[i]) / static_cast<Real>(store.masses[i]);
+            Vec3 posIncrement = store.velocities[i] * h + Real(0.5) * acceleration * h * h;
+            store.moveTo(i, store.positions[i] + posIncrement);
+            store.velocities[i] += acceleration * h;
+        }
+    });
+}
+
+Physics::SplittingIntegrator::SplittingIntegrator(std::vector<double> drifts, std::vector<double> kicks)
+    : drifts(std::move(drifts)), kicks(std::move(kicks)) {}
+
+std::unique_ptr<Physics::SplittingIntegrator> Physics::SplittingIntegrator::leapfrog() {
+    std::vector<double> drifts{ 1.0 };
+    return std::make_unique<SplittingIntegrator>(drifts, kicksFor(drifts));
+}
+
+std::unique_ptr<Physics::SplittingIntegrator> Physics::SplittingIntegrator::yoshida4() {
+    // Yoshida (1990), triple jump of second-order leapfrog
+    const double cbrt2 = std::cbrt(2.0);
+    const double w1 = 1.0 / (2.0 - cbrt2);
+    const double w0 = -cbrt2 / (2.0 - cbrt2);
+    std::vector<double> drifts = tripleJump({ 1.0 }, w1, w0);
+    return std::make_unique<SplittingIntegrator>(drifts, kicksFor(drifts));
+}
+
+std::unique_ptr<Physics::SplittingIntegrator> Physics::SplittingIntegrator::yoshida6() {
+    // Yoshida (1990) solution A: w3 w2 w1 w0 w1 w2 w3
+    constexpr double w1 = -1.17767998417887;
+    constexpr double w2 = 0.235573213359357;
+    constexpr double w3 = 0.784513610477560;
+    constexpr double w0 = 1.0 - 2.0 * (w1 + w2 + w3);
+    std::vector<double> drifts{ w3, w2, w1, w0, w1, w2, w3 };
+    return std::make_unique<SplittingIntegrator>(drifts, kicksFor(drifts));
+}
+
+void Physics::SplittingIntegrator::advance(IntegrationContext& ctx, float dt) {
+    kick(ctx, kicks[0] * dt);
+    for (std::size_t stage = 0; stage < drifts.size(); ++stage) {
+        drift(ctx, drifts[stage] * dt);
+        ctx.refreshForces();
+        kick(ctx, kicks[stage + 1] * dt);
+    }
+}
+
+void Physics::SplittingIntegrator::kick(IntegrationContext& ctx, double h) {
+    BodyStore& store = ctx.store;
+    ctx.pool.parallelFor(store.size(), kIntegrateGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (store.isFrozen(i)) continue;
+            const glm::dvec3 acceleration = glm::dvec3(store.netForces[i]) / store.masses[i];
+            store.velocities[i] = Vec3(glm::dvec3(store.velocities[i]) + acceleration * h);
+        }
+    });
+}
+
+void Physics::SplittingIntegrator::drift(IntegrationContext& ctx, double h) {
+    BodyStore& store = ctx.store;
+    ctx.pool.parallelFor(store.size(), kIntegrateGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (store.isFrozen(i)) continue;
+            const Vec3 posIncrement(glm::dvec3(store.velocities[i]) * h);
+            store.moveTo(i, store.positions[i] + posIncrement);
+        }
+    });
+}
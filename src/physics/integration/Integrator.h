@@ -0,0 +1,94 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "physics/BodyStore.h"
+#include "physics/utils/ThreadPool.h"
+
+namespace Physics {
+    enum class IntegratorType {
+        VelocityVerlet, // legacy single-force update, the default
+        LeapfrogKDK,
+        Yoshida4,
+        Yoshida6,
+        WisdomHolman
+    };
+
+    const char* integratorName(IntegratorType type);
+    /// Global order of accuracy, the local error of one step shrinks like dt^(order + 1)
+    int integratorOrder(IntegratorType type);
+
+    /**
+     * @brief What an integrator may touch during one step
+     *
+     * Net forces in the store are current for the positions at the start of the
+     * step. refreshForces() rebuilds the tree and recomputes every net force from
+     * the current positions; it is the expensive part, so integrators are compared
+     * by how much accuracy they buy per call. The store lock is held throughout.
+     */
+    struct IntegrationContext {
+        BodyStore& store;
+        ThreadPool& pool;
+        double G;
+        std::function<void()> refreshForces;
+    };
+
+    /**
+     * @brief Advances positions and velocities of every non-static body by one step
+     *
+     * Selected per PhysicsSystem with setIntegrator(). Thermal integration,
+     * collisions and frame recording stay outside and run once per step.
+     */
+    class IIntegrator {
+    public:
+        virtual ~IIntegrator() = default;
+        virtual void advance(IntegrationContext& ctx, float dt) = 0;
+        /// Force evaluations per step beyond the one made before the step
+        virtual int extraForceEvaluations() const = 0;
+    };
+
+    std::unique_ptr<IIntegrator> makeIntegrator(IntegratorType type);
+
+    /**
+     * @brief The original update: x += v dt + a dt^2 / 2, v += a dt with the start-of-step force
+     *
+     * Exact for constant forces but only first order (and not symplectic) once the
+     * force depends on position.
+     */
+    class VelocityVerletIntegrator : public IIntegrator {
+    public:
+        void advance(IntegrationContext& ctx, float dt) override;
+        int extraForceEvaluations() const override { return 0; }
+    };
+
+    /**
+     * @brief Symmetric kick-drift-kick composition of leapfrog steps
+     *
+     * kick(k0 dt) drift(d0 dt) kick(k1 dt) ... drift(dn dt) kick(kn+1 dt), with a
+     * force evaluation before every kick but the first (first-same-as-last).
+     * Leapfrog is one drift, Yoshida's triple-jump (4th order) three and his
+     * solution A (6th order) seven. Subclasses may replace kick/drift with another
+     * splitting of the Hamiltonian and keep the composition.
+     */
+    class SplittingIntegrator : public IIntegrator {
+    public:
+        SplittingIntegrator(std::vector<double> drifts, std::vector<double> kicks);
+
+        static std::unique_ptr<SplittingIntegrator> leapfrog();
+        static std::unique_ptr<SplittingIntegrator> yoshida4();
+        static std::unique_ptr<SplittingIntegrator> yoshida6();
+
+        void advance(IntegrationContext& ctx, float dt) override;
+        int extraForceEvaluations() const override { return static_cast<int>(drifts.size()); }
+
+    protected:
+        virtual void kick(IntegrationContext& ctx, double h);
+        virtual void drift(IntegrationContext& ctx, double h);
+
+    private:
+        std::vector<double> drifts;
+        std::vector<double> kicks;
+    };
+}
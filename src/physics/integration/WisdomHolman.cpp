@@ -0,0 +1,238 @@
+#include "WisdomHolman.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <vector>
+
+#include "physics/Constants.h"
+
+namespace {
+    constexpr int kMaxKeplerIterations = 50;
+    constexpr double kKeplerTolerance = 1e-13;
+
+    void stumpff(double z, double& c2, double& c3) {
+        if (z > 1e-6) {
+            const double s = std::sqrt(z);
+            c2 = (1.0 - std::cos(s)) / z;
+            c3 = (s - std::sin(s)) / (s * z);
+        } else if (z < -1e-6) {
+            const double s = std::sqrt(-z);
+            c2 = (std::cosh(s) - 1.0) / -z;
+            c3 = (std::sinh(s) - s) / (s * -z);
+        } else {
+            c2 = 0.5 - z / 24.0 + z * z / 720.0;
+            c3 = 1.0 / 6.0 - z / 120.0 + z * z / 5040.0;
+        }
+    }
+}
+
+/**
+ * Bodies split into the central mass and the planets that move around it,
+ * in democratic heliocentric coordinates: Q = x - x_central, u = v - V_barycentre.
+ * Static bodies other than the central one take no part.
+ */
+struct Physics::WisdomHolmanIntegrator::Heliocentric {
+    std::size_t central = 0;
+    bool centralStatic = false;
+    double centralMass = 0.0;
+    double totalMass = 0.0;
+    glm::dvec3 barycentre{0.0};
+    glm::dvec3 barycentreVelocity{0.0};
+    std::vector<std::size_t> planets;
+    std::vector<glm::dvec3> Q;
+    std::vector<glm::dvec3> u;
+
+    bool load(const Physics::BodyStore& store) {
+        const std::size_t count = store.size();
+        if (count < 2) return false;
+
+        central = 0;
+        for (std::size_t i = 1; i < count; ++i) {
+            if (store.masses[i] > store.masses[central]) central = i;
+        }
+        centralStatic = store.isFrozen(central);
+        centralMass = store.masses[central];
+        if (!(centralMass > 0.0)) return false;
+
+        planets.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i != central && !store.isFrozen(i)) planets.push_back(i);
+        }
+
+        const glm::dvec3 xc(store.positions[central]);
+        const glm::dvec3 vc = centralStatic ? glm::dvec3(0.0) : glm::dvec3(store.velocities[central]);
+        totalMass = centralMass;
+        barycentre = centralMass * xc;
+        barycentreVelocity = centralMass * vc;
+        for (std::size_t i : planets) {
+            totalMass += store.masses[i];
+            barycentre += store.masses[i] * glm::dvec3(store.positions[i]);
+            barycentreVelocity += store.masses[i] * glm::dvec3(store.velocities[i]);
+        }
+        barycentre /= totalMass;
+        barycentreVelocity /= totalMass;
+        if (centralStatic) barycentreVelocity = glm::dvec3(0.0); // velocities stay heliocentric
+
+        Q.resize(planets.size());
+        u.resize(planets.size());
+        for (std::size_t k = 0; k < planets.size(); ++k) {
+            Q[k] = glm::dvec3(store.positions[planets[k]]) - xc;
+            u[k] = glm::dvec3(store.velocities[planets[k]]) - barycentreVelocity;
+        }
+        return true;
+    }
+
+    glm::dvec3 momentum(const Physics::BodyStore& store) const {
+        glm::dvec3 p(0.0);
+        for (std::size_t k = 0; k < planets.size(); ++k) p += store.masses[planets[k]] * u[k];
+        return p;
+    }
+
+    void save(Physics::BodyStore& store) const {
+        glm::dvec3 xc(store.positions[central]);
+        if (!centralStatic) {
+            glm::dvec3 weighted(0.0);
+            for (std::size_t k = 0; k < planets.size(); ++k) weighted += store.masses[planets[k]] * Q[k];
+            xc = barycentre - weighted / totalMass;
+            setPosition(store, central, xc);
+            store.velocities[central] = Vec3(barycentreVelocity - momentum(store) / centralMass);
+        }
+        for (std::size_t k = 0; k < planets.size(); ++k) {
+            setPosition(store, planets[k], xc + Q[k]);
+            store.velocities[planets[k]] = Vec3(u[k] + barycentreVelocity);
+        }
+    }
+
+    static void setPosition(Physics::BodyStore& store, std::size_t i, const glm::dvec3& position) {
+        store.moveTo(i, Vec3(position));
+    }
+};
+
+void Physics::keplerDrift(glm::dvec3& position, glm::dvec3& velocity, double mu, double dt) {
+    const double r0 = glm::length(position);
+    if (!(mu > 0.0) || r0 == 0.0 || dt == 0.0) {
+        position += velocity * dt;
+        return;
+    }
+
+    const double sqrtMu = std::sqrt(mu);
+    const double rv = glm::dot(position, velocity) / sqrtMu; // r0 * vr0 / sqrt(mu)
+    const double alpha = 2.0 / r0 - glm::dot(velocity, velocity) / mu;
+
+    if (alpha > 0.0) {
+        // Whole revolutions change nothing and only slow the iteration down
+        const double period = 2.0 * std::numbers::pi / (sqrtMu * alpha * std::sqrt(alpha));
+        dt = std::fmod(dt, period);
+    }
+
+    double chi = alpha > 1e-12 ? sqrtMu * dt * alpha : sqrtMu * dt / r0;
+    double c2 = 0.5;
+    double c3 = 1.0 / 6.0;
+    // F rises with chi (dF = r) and the root has the sign of dt. Newton steps that leave
+    // the bracket or stall, as they do down the cosh of a long hyperbolic drift, bisect instead
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    double lo = dt > 0.0 ? 0.0 : -inf;
+    double hi = dt > 0.0 ? inf : 0.0;
+    double step = inf;
+    double stepBefore = inf;
+    for (int iter = 0; iter < kMaxKeplerIterations; ++iter) {
+        const double z = alpha * chi * chi;
+        stumpff(z, c2, c3);
+        const double chi2 = chi * chi;
+        const double F = rv * chi2 * c2 + (1.0 - alpha * r0) * chi2 * chi * c3 + r0 * chi - sqrtMu * dt;
+        const double dF = rv * chi * (1.0 - z * c3) + (1.0 - alpha * r0) * chi2 * c2 + r0;
+
+        double next;
+        if (!std::isfinite(F) || !std::isfinite(dF)) {
+            (chi > 0.0 ? hi : lo) = chi;
+            next = 0.5 * (lo + hi);
+        } else {
+            (F > 0.0 ? hi : lo) = chi;
+            next = chi - F / dF;
+            const bool stalled = std::isfinite(hi - lo) && std::fabs(2.0 * F) > std::fabs(stepBefore * dF);
+            if (!(next >= lo && next <= hi) || stalled) next = 0.5 * (lo + hi);
+        }
+        stepBefore = step;
+        step = chi - next;
+        chi = next;
+        const double tolerance = kKeplerTolerance * std::max(1.0, std::fabs(chi));
+        if (std::fabs(step) <= tolerance || hi - lo <= tolerance) break;
+    }
+    stumpff(alpha * chi * chi, c2, c3);
+
+    const double chi2 = chi * chi;
+    const double f = 1.0 - chi2 / r0 * c2;
+    const double g = dt - chi2 * chi * c3 / sqrtMu;
+    const glm::dvec3 next = f * position + g * velocity;
+    const double r = glm::length(next);
+    const double fDot = sqrtMu / (r * r0) * (alpha * chi2 * chi * c3 - chi);
+    const double gDot = 1.0 - chi2 / r * c2;
+
+    velocity = fDot * position + gDot * velocity;
+    position = next;
+}
+
+Physics::WisdomHolmanIntegrator::WisdomHolmanIntegrator()
+    : SplittingIntegrator({ 1.0 }, { 0.5, 0.5 }), helio(std::make_unique<Heliocentric>()) {}
+
+Physics::WisdomHolmanIntegrator::~WisdomHolmanIntegrator() = default;
+
+void Physics::WisdomHolmanIntegrator::kick(IntegrationContext& ctx, double h) {
+    Heliocentric& helio = *this->helio;
+    BodyStore& store = ctx.store;
+    if (!helio.load(store)) {
+        SplittingIntegrator::kick(ctx, h);
+        return;
+    }
+
+    // Everything except the central pull, which the Kepler drift already covers.
+    // Matches the softened pair force of the octree so the two cancel exactly.
+    const glm::dvec3 xc(store.positions[helio.central]);
+    const double Gmc = ctx.G * helio.centralMass;
+    auto interaction = [&](std::size_t i) {
+        const glm::dvec3 toCentral = xc - glm::dvec3(store.positions[i]);
+        const double distSq = glm::dot(toCentral, toCentral) + Constants::SOFTENING_SQ;
+        const glm::dvec3 centralPull = Gmc / (distSq * std::sqrt(distSq)) * toCentral;
+        return glm::dvec3(store.netForces[i]) / store.masses[i] - centralPull;
+    };
+
+    glm::dvec3 barycentreAccel(0.0);
+    if (!helio.centralStatic) {
+        barycentreAccel = glm::dvec3(store.netForces[helio.central]);
+        for (std::size_t i : helio.planets) barycentreAccel += glm::dvec3(store.netForces[i]);
+        barycentreAccel /= helio.totalMass;
+        helio.barycentreVelocity += barycentreAccel * h;
+    }
+    for (std::size_t k = 0; k < helio.planets.size(); ++k) {
+        helio.u[k] += (interaction(helio.planets[k]) - barycentreAccel) * h;
+    }
+    helio.save(store);
+}
+
+void Physics::WisdomHolmanIntegrator::drift(IntegrationContext& ctx, double h) {
+    Heliocentric& helio = *this->helio;
+    BodyStore& store = ctx.store;
+    if (!helio.load(store)) {
+        SplittingIntegrator::drift(ctx, h);
+        return;
+    }
+
+    const double mu = ctx.G * helio.centralMass;
+    auto jump = [&](double tau) {
+        if (helio.centralStatic) return;
+        const glm::dvec3 shift = helio.momentum(store) / helio.centralMass * tau;
+        for (glm::dvec3& q : helio.Q) q += shift;
+    };
+
+    jump(0.5 * h);
+    ctx.pool.parallelFor(helio.planets.size(), 64, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            keplerDrift(helio.Q[k], helio.u[k], mu, h);
+        }
+    });
+    jump(0.5 * h);
+    helio.barycentre += helio.barycentreVelocity * h;
+    helio.save(store);
+}
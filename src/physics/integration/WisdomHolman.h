@@ -0,0 +1,48 @@
+#pragma once
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "physics/integration/Integrator.h"
+
+namespace Physics {
+    /**
+     * @brief Advances a two-body relative orbit by dt along the exact Kepler solution
+     *
+     * Universal-variable formulation with Stumpff functions, so elliptic, parabolic
+     * and hyperbolic orbits take the same path.
+     *
+     * @param mu G * (mass of the central body)
+     */
+    void keplerDrift(glm::dvec3& position, glm::dvec3& velocity, double mu, double dt);
+
+    /**
+     * @brief Wisdom-Holman map in democratic heliocentric coordinates
+     *
+     * Splits the Hamiltonian into Keplerian motion around the heaviest body, solved
+     * exactly by keplerDrift(), and a small interaction part handled by kicks, so
+     * orbits around a dominant mass take steps that are a sizeable fraction of the
+     * shortest period. Planets drift with heliocentric positions and barycentric
+     * velocities, with the heliocentric "jump" term on either side of the Kepler step.
+     *
+     * The interaction kick is the tree force minus the direct (softened) pull of
+     * the central body, so any other force, including the global field and static
+     * bodies, still applies. The Kepler step itself is unsoftened. A static central
+     * body stays put and the planets then use plain heliocentric velocities.
+     *
+     * Without a dominant body it is still a valid second-order splitting, just
+     * without the gain over leapfrog.
+     */
+    class WisdomHolmanIntegrator : public SplittingIntegrator {
+    public:
+        WisdomHolmanIntegrator();
+        ~WisdomHolmanIntegrator() override;
+
+    protected:
+        void kick(IntegrationContext& ctx, double h) override;
+        void drift(IntegrationContext& ctx, double h) override;
+
+    private:
+        struct Heliocentric;
+        std::unique_ptr<Heliocentric> helio; // scratch, reloaded from the store by every kick and drift
+    };
+}
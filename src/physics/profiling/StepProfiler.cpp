@@ -0,0 +1,115 @@
+#include "StepProfiler.h"
+
+#include <algorithm>
+
+const char* Physics::stepPhaseName(StepPhase phase) {
+    switch (phase) {
+        case StepPhase::LockWait: return "lockWait";
+        case StepPhase::OctreeBuild: return "octreeBuild";
+        case StepPhase::GravityForces: return "gravityForces";
+        case StepPhase::ThermalRadiation: return "thermalRadiation";
+        case StepPhase::ThermalIntegrate: return "thermalIntegrate";
+        case StepPhase::Integrate: return "integrate";
+        case StepPhase::RecordFrames: return "recordFrames";
+        case StepPhase::BroadPhaseBuild: return "broadPhaseBuild";
+        case StepPhase::BroadPhaseQuery: return "broadPhaseQuery";
+        case StepPhase::NarrowPhase: return "narrowPhase";
+        case StepPhase::Count: break;
+    }
+    return "unknown";
+}
+
+const char* Physics::stepCounterName(StepCounter counter) {
+    switch (counter) {
+        case StepCounter::OctreeNodes: return "octreeNodes";
+        case StepCounter::ForceEvaluations: return "forceEvaluations";
+        case StepCounter::ThermalSubSteps: return "thermalSubSteps";
+        case StepCounter::CandidatePairs: return "candidatePairs";
+        case StepCounter::Contacts: return "contacts";
+        case StepCounter::SleepingBodies: return "sleepingBodies";
+        case StepCounter::Count: break;
+    }
+    return "unknown";
+}
+
+Physics::StepProfiler::Scope::Scope(StepProfiler& profiler, StepPhase phase)
+    : profiler(profiler), parent(profiler.activePhase) {
+    profiler.charge(Clock::now());
+    profiler.activePhase = static_cast<int>(phase);
+}
+
+Physics::StepProfiler::Scope::~Scope() {
+    profiler.charge(Clock::now());
+    profiler.activePhase = parent;
+}
+
+void Physics::StepProfiler::charge(Clock::time_point now) {
+    if (activePhase >= 0) {
+        scratchNanos[static_cast<std::size_t>(activePhase)] +=
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - mark).count());
+    }
+    mark = now;
+}
+
+void Physics::StepProfiler::begin() {
+    scratchNanos.fill(0);
+    for (auto& counter : scratchCounters) counter.store(0, std::memory_order_relaxed);
+    activePhase = -1;
+    stepStart = Clock::now();
+    mark = stepStart;
+}
+
+void Physics::StepProfiler::commit(std::uint64_t step) {
+    const auto total = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - stepStart).count();
+
+    const std::uint64_t index = head.load(std::memory_order_relaxed);
+    Slot& slot = ring[index % kHistory];
+    const std::uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::size_t field = 0;
+    slot.fields[field++].store(step, std::memory_order_relaxed);
+    slot.fields[field++].store(static_cast<std::uint64_t>(total), std::memory_order_relaxed);
+    for (std::uint64_t nanos : scratchNanos) slot.fields[field++].store(nanos, std::memory_order_relaxed);
+    for (const auto& counter : scratchCounters) slot.fields[field++].store(counter.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    head.store(index + 1, std::memory_order_release);
+}
+
+bool Physics::StepProfiler::readSlot(std::uint64_t index, StepProfile& out) const {
+    const Slot& slot = ring[index % kHistory];
+    for (;;) {
+        const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) continue; // writer is mid-copy, it never holds the slot for long
+
+        std::size_t field = 0;
+        out.step = slot.fields[field++].load(std::memory_order_relaxed);
+        out.totalNanos = slot.fields[field++].load(std::memory_order_relaxed);
+        for (auto& nanos : out.phaseNanos) nanos = slot.fields[field++].load(std::memory_order_relaxed);
+        for (auto& counter : out.counters) counter = slot.fields[field++].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before) break;
+    }
+    // Overwritten by a newer step while we were behind
+    return head.load(std::memory_order_acquire) - index <= kHistory;
+}
+
+bool Physics::StepProfiler::latest(StepProfile& out) const {
+    const std::uint64_t count = head.load(std::memory_order_acquire);
+    if (count == 0) return false;
+    return readSlot(count - 1, out);
+}
+
+void Physics::StepProfiler::history(std::vector<StepProfile>& out, std::size_t maxSteps) const {
+    out.clear();
+    const std::uint64_t count = head.load(std::memory_order_acquire);
+    const std::uint64_t available = std::min<std::uint64_t>({ count, kHistory, maxSteps });
+    out.reserve(available);
+    for (std::uint64_t index = count - available; index < count; ++index) {
+        StepProfile profile;
+        if (readSlot(index, profile)) out.push_back(profile);
+    }
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Physics {
+    /// Timed sections of PhysicsSystem::advancePhysics. Times are exclusive: a nested phase pauses its parent
+    enum class StepPhase : std::uint8_t {
+        LockWait,          // waiting for the body store lock
+        OctreeBuild,
+        GravityForces,     // Octree::computeForce for every body
+        ThermalRadiation,  // Octree::computeHeat for every body
+        ThermalIntegrate,  // integrateTemperature for every body
+        Integrate,         // motion integrator, minus the force refreshes it triggers
+        RecordFrames,
+        BroadPhaseBuild,   // BVH::build
+        BroadPhaseQuery,   // BVH::getPotentialCollisions
+        NarrowPhase,
+        Count
+    };
+
+    enum class StepCounter : std::uint8_t {
+        OctreeNodes,       // nodes allocated over every octree build of the step
+        ForceEvaluations,  // bodies whose gravity was evaluated
+        ThermalSubSteps,   // integrateTemperature sub-steps over all bodies
+        CandidatePairs,    // broad phase pairs handed to the narrow phase
+        Contacts,          // pairs that actually collided
+        SleepingBodies,    // bodies skipped because their island is asleep
+        Count
+    };
+
+    constexpr std::size_t kStepPhaseCount = static_cast<std::size_t>(StepPhase::Count);
+    constexpr std::size_t kStepCounterCount = static_cast<std::size_t>(StepCounter::Count);
+
+    const char* stepPhaseName(StepPhase phase);
+    const char* stepCounterName(StepCounter counter);
+
+    /// Timings and counters of one physics step
+    struct StepProfile {
+        std::uint64_t step = 0;
+        std::uint64_t totalNanos = 0;
+        std::array<std::uint64_t, kStepPhaseCount> phaseNanos{};
+        std::array<std::uint64_t, kStepCounterCount> counters{};
+
+        double milliseconds(StepPhase phase) const { return static_cast<double>(phaseNanos[static_cast<std::size_t>(phase)]) * 1e-6; }
+        double totalMilliseconds() const { return static_cast<double>(totalNanos) * 1e-6; }
+        std::uint64_t count(StepCounter counter) const { return counters[static_cast<std::size_t>(counter)]; }
+    };
+
+    /**
+     * @brief Per-phase timers and counters for PhysicsSystem steps
+     *
+     * The physics thread fills a scratch profile during a step (Scope for times,
+     * count() for counters, which workers may call too) and commit() publishes it
+     * into a ring of the last kHistory steps. Ring slots are seqlocked, so any
+     * number of readers (UI status bar, headless runner) can copy profiles out at
+     * any time without ever blocking the physics thread.
+     *
+     * Instrumentation goes through the PHYSICS_PROFILE_* macros, which compile to
+     * nothing unless PHYSICS_PROFILING is defined (CMake option
+     * PHYSICS_ENABLE_PROFILING). The ring then simply stays empty.
+     */
+    class StepProfiler {
+    public:
+        using Clock = std::chrono::steady_clock;
+        static constexpr std::size_t kHistory = 256;
+
+#ifdef PHYSICS_PROFILING
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+
+        StepProfiler() = default;
+        StepProfiler(const StepProfiler&) = delete;
+        StepProfiler& operator=(const StepProfiler&) = delete;
+
+        /// RAII timer charging its lifetime, minus nested scopes, to one phase. Physics thread only
+        class Scope {
+        public:
+            Scope(StepProfiler& profiler, StepPhase phase);
+            ~Scope();
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            StepProfiler& profiler;
+            int parent;
+        };
+
+        /// Physics thread: starts a fresh scratch profile
+        void begin();
+
+        /// Thread-safe: adds n to a counter of the current step
+        void count(StepCounter counter, std::uint64_t n) {
+            scratchCounters[static_cast<std::size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+        }
+
+        /// Physics thread: closes the scratch profile and publishes it as the given step
+        void commit(std::uint64_t step);
+
+        /// Number of steps committed so far, including those already overwritten in the ring
+        std::uint64_t committed() const { return head.load(std::memory_order_acquire); }
+
+        /// Copies the newest profile; false until the first commit
+        bool latest(StepProfile& out) const;
+
+        /// Replaces out with up to maxSteps of the newest profiles, oldest first
+        void history(std::vector<StepProfile>& out, std::size_t maxSteps = kHistory) const;
+
+    private:
+        static constexpr std::size_t kFields = 2 + kStepPhaseCount + kStepCounterCount;
+
+        struct Slot {
+            std::atomic<std::uint64_t> sequence{0}; // odd while being written
+            std::array<std::atomic<std::uint64_t>, kFields> fields{};
+        };
+
+        void charge(Clock::time_point now);
+        bool readSlot(std::uint64_t index, StepProfile& out) const;
+
+        // Scratch, physics thread only (apart from the counters)
+        std::array<std::uint64_t, kStepPhaseCount> scratchNanos{};
+        std::array<std::atomic<std::uint64_t>, kStepCounterCount> scratchCounters{};
+        Clock::time_point stepStart{};
+        Clock::time_point mark{};
+        int activePhase = -1;
+
+        std::array<Slot, kHistory> ring{};
+        std::atomic<std::uint64_t> head{0};
+    };
+}
+
+#ifdef PHYSICS_PROFILING
+#define PHYSICS_PROFILE_CONCAT_INNER(a, b) a##b
+#define PHYSICS_PROFILE_CONCAT(a, b) PHYSICS_PROFILE_CONCAT_INNER(a, b)
+#define PHYSICS_PROFILE_SCOPE(profiler, phase) \
+    ::Physics::StepProfiler::Scope PHYSICS_PROFILE_CONCAT(profileScope_, __LINE__)((profiler), (phase))
+#define PHYSICS_PROFILE_COUNT(profiler, counter, n) (profiler).count((counter), static_cast<std::uint64_t>(n))
+#define PHYSICS_PROFILE_BEGIN(profiler) (profiler).begin()
+#define PHYSICS_PROFILE_COMMIT(profiler, step) (profiler).commit(step)
+#else
+#define PHYSICS_PROFILE_SCOPE(profiler, phase) ((void)0)
+#define PHYSICS_PROFILE_COUNT(profiler, counter, n) ((void)0)
+#define PHYSICS_PROFILE_BEGIN(profiler) ((void)0)
+#define PHYSICS_PROFILE_COMMIT(profiler, step) ((void)0)
+#endif
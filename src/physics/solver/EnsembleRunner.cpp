@@ -0,0 +1,136 @@
+#include "EnsembleRunner.h"
+#include <algorithm>
+#include <cmath>
+
+#include "physics/CloneRunner.h"
+#include "physics/PhysicsSystem.h"
+
+namespace {
+constexpr std::size_t kMembersPerThread = 4;
+
+glm::dvec3 gaussianVector(std::mt19937_64& rng, double sigma) {
+    if (sigma <= 0.0) return glm::dvec3(0.0);
+    std::normal_distribution<double> normal(0.0, sigma);
+    return glm::dvec3(normal(rng), normal(rng), normal(rng));
+}
+}
+
+void RunningStat::add(double x) {
+    ++count;
+    const double delta = x - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta * (x - mean);
+    min = std::min(min, x);
+    max = std::max(max, x);
+}
+
+double RunningStat::stddev() const {
+    return std::sqrt(variance());
+}
+
+double EnsembleStats::hitProbabilityStdError() const {
+    if (runs == 0) return 0.0;
+    const double p = hitProbability();
+    return std::sqrt(p * (1.0 - p) / static_cast<double>(runs));
+}
+
+EnsembleRunner::EnsembleRunner(const Physics::PhysicsSystem& baseScene, Physics::CloneRunner& cloneRunner)
+    : base(baseScene), runner(cloneRunner) {}
+
+EnsembleRunner::EnsembleRunner(const Physics::PhysicsSystem& baseScene)
+    : EnsembleRunner(baseScene, Physics::CloneRunner::shared()) {}
+
+EnsembleStats EnsembleRunner::run(const EnsembleConfig& config, const StopMonitor& stop, const ProgressCallback& progress) const {
+    return run(config, [stop](const Physics::PhysicsSystem& member) { return stop.bind(member); }, progress);
+}
+
+EnsembleStats EnsembleRunner::run(const EnsembleConfig& config, const MonitorFactory& monitor, const ProgressCallback& progress) const {
+    EnsembleStats stats;
+    const std::size_t batchSize = config.batchSize > 0 ? config.batchSize : kMembersPerThread * runner.size();
+
+    std::vector<MemberResult> results;
+    for (std::size_t first = 0; first < config.members; first += batchSize) {
+        const std::size_t count = std::min(batchSize, config.members - first);
+        results.assign(count, MemberResult{});
+        runner.forEach(count, [&](std::size_t i) {
+            results[i] = runMember(config, monitor, first + i);
+        });
+
+        // Folded in member order, so the totals are the same for any batch size
+        for (const MemberResult& result : results) {
+            ++stats.runs;
+            stats.closestApproach.add(result.closest);
+            if (result.hit) {
+                ++stats.hits;
+                stats.eventTime.add(result.eventTime);
+            }
+        }
+        if (progress && !progress(stats)) break;
+    }
+    return stats;
+}
+
+EnsembleRunner::MemberResult EnsembleRunner::runMember(const EnsembleConfig& config, const MonitorFactory& monitor, std::size_t index) const {
+    std::unique_ptr<Physics::PhysicsSystem> member = base.clone();
+    Physics::FrameHistoryConfig history;
+    history.windowFrames = 0;
+    history.spillToDisk = false;
+    member->setFrameHistoryConfig(history);
+
+    std::seed_seq seed{
+        static_cast<std::uint32_t>(config.seed), static_cast<std::uint32_t>(config.seed >> 32),
+        static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(static_cast<std::uint64_t>(index) >> 32)
+    };
+    std::mt19937_64 rng(seed);
+    for (const Perturbation& perturb : perturbations) perturb(*member, rng);
+
+    const std::function<float()> distance = monitor(*member);
+    const double startTime = member->simTime;
+    const double endTime = startTime + config.maxTime;
+
+    MemberResult result;
+    double previousTime = member->simTime;
+    float previous = distance();
+    result.closest = previous;
+    while (previous > 0.0f && member->simTime < endTime) {
+        member->step(config.dt);
+        const float current = distance();
+        result.closest = std::min(result.closest, static_cast<double>(current));
+        if (current <= 0.0f) {
+            // Linear interpolation of the crossing inside the last step
+            const double fraction = static_cast<double>(previous) / (static_cast<double>(previous) - static_cast<double>(current));
+            result.hit = true;
+            result.eventTime = previousTime + fraction * (member->simTime - previousTime) - startTime;
+            return result;
+        }
+        previous = current;
+        previousTime = member->simTime;
+    }
+    result.hit = previous <= 0.0f; // already past the event at the start
+    return result;
+}
+
+EnsembleRunner::Perturbation EnsembleRunner::velocityNoise(uint32_t bodyID, double relativeSigma) {
+    return [=](Physics::PhysicsSystem& member, std::mt19937_64& rng) {
+        Physics::PhysicsBody* body = member.getBodyById(bodyID);
+        if (!body) return;
+        const glm::dvec3 velocity = body->getVelocityPrecise(BodyLock::LOCK);
+        body->setVelocityPrecise(velocity + gaussianVector(rng, relativeSigma * glm::length(velocity)), BodyLock::LOCK);
+    };
+}
+
+EnsembleRunner::Perturbation EnsembleRunner::positionNoise(uint32_t bodyID, double sigma) {
+    return [=](Physics::PhysicsSystem& member, std::mt19937_64& rng) {
+        Physics::PhysicsBody* body = member.getBodyById(bodyID);
+        if (!body) return;
+        body->setPositionPrecise(body->getPositionPrecise(BodyLock::LOCK) + gaussianVector(rng, sigma), BodyLock::LOCK);
+    };
+}
+
+EnsembleRunner::Perturbation EnsembleRunner::globalAccelerationNoise(double relativeSigma) {
+    return [=](Physics::PhysicsSystem& member, std::mt19937_64& rng) {
+        if (relativeSigma <= 0.0) return;
+        std::normal_distribution<double> normal(1.0, relativeSigma);
+        member.setGlobalAcceleration(member.getGlobalAcceleration() * static_cast<float>(normal(rng)));
+    };
+}
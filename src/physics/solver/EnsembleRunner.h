@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "ProblemRouter.h"
+
+namespace Physics {
+    class CloneRunner;
+    class PhysicsSystem;
+}
+
+// Streaming mean and spread of one quantity (Welford)
+struct RunningStat {
+    std::size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void add(double x);
+    double variance() const { return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0; }
+    double stddev() const;
+};
+
+struct EnsembleStats {
+    std::size_t runs = 0;
+    std::size_t hits = 0;         // members whose stop event happened within maxTime
+    RunningStat eventTime;        // seconds after the base scene's time, hits only
+    RunningStat closestApproach;  // smallest monitor value each member reached, the miss distance for distance stops
+
+    double hitProbability() const { return runs ? static_cast<double>(hits) / static_cast<double>(runs) : 0.0; }
+    double hitProbabilityStdError() const;
+};
+
+struct EnsembleConfig {
+    std::size_t members = 1000;
+    float dt = 1.0f / 1000.0f;
+    double maxTime = 10.0;        // simulated seconds a member runs before it counts as a miss
+    std::uint64_t seed = 0;
+    std::size_t batchSize = 0;    // members alive at once, 0 for four per runner thread
+};
+
+/**
+ * @brief Monte Carlo runs of a base scene under random perturbations
+ *
+ * Every member is a clone of the base scene, perturbed by the registered
+ * Perturbations with its own generator, then stepped on a CloneRunner until its
+ * stop monitor drops to <= 0 (a hit) or maxTime passes (a miss). Members run a
+ * batch at a time with a zero frame window, which keeps only each body's first
+ * frame, so memory stays flat for any member count and run length, and the
+ * statistics are handed to a progress callback after every batch.
+ *
+ * Each member's generator is seeded from the seed and its index alone, so results
+ * do not depend on the batch size or thread count.
+ */
+class EnsembleRunner {
+public:
+    // Draws one member's parameters, e.g. adds noise to a body's state or the globals
+    using Perturbation = std::function<void(Physics::PhysicsSystem& member, std::mt19937_64& rng)>;
+    // Builds the stop monitor for a member, see StopMonitor::bind
+    using MonitorFactory = std::function<std::function<float()>(const Physics::PhysicsSystem& member)>;
+    // Called after every batch with the totals so far, return false to stop early
+    using ProgressCallback = std::function<bool(const EnsembleStats& stats)>;
+
+    /**
+     * @param base Scene every member is cloned from, left untouched. It may keep stepping meanwhile
+     * @param runner Pool the members run on
+     */
+    explicit EnsembleRunner(const Physics::PhysicsSystem& base, Physics::CloneRunner& runner);
+    explicit EnsembleRunner(const Physics::PhysicsSystem& base);
+
+    void addPerturbation(Perturbation perturbation) { perturbations.push_back(std::move(perturbation)); }
+
+    // Blocks until every member has run or progress returned false
+    EnsembleStats run(const EnsembleConfig& config, const MonitorFactory& monitor, const ProgressCallback& progress = nullptr) const;
+    EnsembleStats run(const EnsembleConfig& config, const StopMonitor& stop, const ProgressCallback& progress = nullptr) const;
+
+    // Gaussian noise on the velocity, isotropic with sigma relative to the body's speed
+    static Perturbation velocityNoise(uint32_t bodyID, double relativeSigma);
+    // Gaussian noise on the position, isotropic with sigma in meters
+    static Perturbation positionNoise(uint32_t bodyID, double sigma);
+    // Gaussian scale on the global acceleration, sigma relative
+    static Perturbation globalAccelerationNoise(double relativeSigma);
+
+private:
+    struct MemberResult {
+        bool hit = false;
+        double eventTime = 0.0;
+        double closest = 0.0;
+    };
+
+    MemberResult runMember(const EnsembleConfig& config, const MonitorFactory& monitor, std::size_t index) const;
+
+    const Physics::PhysicsSystem& base;
+    Physics::CloneRunner& runner;
+    std::vector<Perturbation> perturbations;
+};
@@ -35,7 +35,7 @@
  * ## Implementations
  *
  * - InterceptSolver: Forward problems (monitors until condition met)
- * - VectorRootSolver: Inverse problems (Newton's method for vector unknowns)
+ * - VectorRootSolver: Inverse problems (Newton or Broyden iterations for vector unknowns)
  *
  * @see InterceptSolver, VectorRootSolver
  * @see ProblemRouter for automatic solver selection
@@ -5,6 +5,12 @@
 InterceptSolver::InterceptSolver(MonitorFunction monitor, TimeoutCondition timeout) :
       monitorFunc(std::move(monitor)), timeoutFunc(std::move(timeout)) {}
 
+void InterceptSolver::setRewind(Rewind newRewind, double tolerance) {
+      rewind = std::move(newRewind);
+      timeTolerance = tolerance;
+      savedTime.reset();
+}
+
 bool InterceptSolver::stepFrame() {
       // Check limits
       if (timeoutFunc && timeoutFunc()) {
@@ -16,9 +22,41 @@ bool InterceptSolver::stepFrame() {
       if (monitorFunc) {
             float val = monitorFunc();
             if (val <= 0.0f) {
+                  if (rewind.save && savedTime) {
+                        localiseCrossing();
+                  }
                   return true; // Stop (Success exit)
             }
       }
 
+      if (rewind.save) {
+            // The state before the next step, where a bisection would start from
+            rewind.save();
+            savedTime = rewind.time();
+      }
       return false; // Keep running
 }
+
+void InterceptSolver::localiseCrossing() {
+      // The monitor was > 0 at the saved state and is <= 0 one step later
+      double lo = 0.0;
+      double hi = rewind.time() - *savedTime;
+      while (hi - lo > timeTolerance) {
+            const double mid = 0.5 * (lo + hi);
+            if (mid <= lo || mid >= hi) break; // bracket below double resolution
+
+            rewind.restore();
+            rewind.advance(mid);
+            if (monitorFunc() <= 0.0f) {
+                  hi = mid;
+            } else {
+                  lo = mid;
+            }
+      }
+
+      // Finish on the stopping side so the last recorded frame is the event
+      rewind.restore();
+      rewind.advance(hi);
+      eventTime = rewind.time();
+      std::cout << "[InterceptSolver] Event localised at t=" << *eventTime << std::endl;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "ISolver.h"
 #include <functional>
+#include <optional>
 
 /**
  * @brief A linear "monitor" solver that stops simulation when a condition is met.
@@ -11,6 +12,11 @@
  *
  * Unlike VectorRootSolver, this does NOT iterate or reset the simulation repeatedly.
  * It runs a single trajectory and returns 'true' when the event is detected.
+ *
+ * Without a Rewind the event is only as accurate as the step size. With one, the
+ * state before every step is saved, and once the monitor changes sign the crossing
+ * inside the last step is bisected by rewinding and re-stepping shorter intervals,
+ * so large steps still give precise event times.
  */
 class InterceptSolver : public ISolver {
 public:
@@ -20,6 +26,14 @@ public:
     // Returns true to abort (fail/timeout).
     using TimeoutCondition = std::function<bool()>;
 
+    // Lets the solver bisect the last step. All four act on the simulation the monitor reads
+    struct Rewind {
+        std::function<void()> save;          // Remember the current state
+        std::function<void()> restore;       // Go back to the last saved state
+        std::function<void(double)> advance; // Step forward by the given seconds
+        std::function<double()> time;        // Current simulation time
+    };
+
     /**
      * @brief Construct a new Intercept Solver
      *
@@ -28,15 +42,36 @@ public:
      */
     explicit InterceptSolver(MonitorFunction monitorFunc, TimeoutCondition timeoutFunc = nullptr);
 
+    /**
+     * @brief Enables sub-step event localisation
+     *
+     * @param rewind Hooks into the simulation, see Rewind
+     * @param timeTolerance Width of the bracket the crossing is narrowed down to, in seconds
+     */
+    void setRewind(Rewind rewind, double timeTolerance = 1.0e-9);
+
     /**
      * @brief Checks the current simulation state against the intercept conditions.
      *
+     * With a Rewind, a detected crossing is localised first and the simulation is left
+     * at the first state found on the stopping side of it.
+     *
      * @return true if the intercept event occurred (metric <= 0), success condition met, or timeout.
      * @return false otherwise.
      */
     bool stepFrame() override;
 
+    // Simulation time of the event, set once it has been detected with a Rewind
+    std::optional<double> getEventTime() const { return eventTime; }
+
 private:
+    void localiseCrossing();
+
     MonitorFunction monitorFunc;
     TimeoutCondition timeoutFunc;
-};
\ No newline at end of file
+
+    Rewind rewind;
+    double timeTolerance = 1.0e-9;
+    std::optional<double> savedTime; // time of the state rewind.save() last stored
+    std::optional<double> eventTime;
+};
@@ -1,8 +1,12 @@
 #include "ProblemRouter.h"
+#include <array>
+#include <atomic>
+#include <future>
 #include <iostream>
 #include <set>
 
 #include "InterceptSolver.h"
+#include "physics/CloneRunner.h"
 #include "physics/PhysicsSystem.h"
 
 namespace {
@@ -11,6 +15,7 @@ constexpr double kVelocitySolverTolerance = 1.0e-3;
 constexpr int kVelocitySolverMaxIterations = 30;
 constexpr double kVelocitySolverJacobianStep = 0.01;
 constexpr double kVelocitySolverDamping = 1.0;
+constexpr std::size_t kForkMaxSteps = 1000000; // a forked guess that never meets its stop condition gives up here
 }
 
 ProblemRouter::ProblemRouter(Physics::PhysicsSystem& physics) : physicsSystem(physics) {
@@ -64,6 +69,74 @@ std::unique_ptr<ISolver> ProblemRouter::makeSolver(Physics::PhysicsBody* body, c
     return nullptr;
 }
 
+StopMonitor StopMonitor::fromKnowns(const std::unordered_map<std::string, double>& knowns) {
+    StopMonitor stop;
+    stop.subjectID = (int)knowns.at("Stop_SubjectID");
+    stop.prop = (int)knowns.at("Stop_Prop");
+    stop.op = (int)knowns.at("Stop_Op");
+    stop.val = (float)knowns.at("Stop_Val");
+    stop.targetID = (int)knowns.at("Stop_TargetID");
+    stop.targetPoint = glm::vec3(knowns.at("Stop_Val_X"), knowns.at("Stop_Val_Y"), knowns.at("Stop_Val_Z"));
+    return stop;
+}
+
+std::function<float()> StopMonitor::bind(const Physics::PhysicsSystem& sim) const {
+    Physics::PhysicsBody* subject = sim.getBodyById(subjectID);
+    if (!subject) return []() { return -1.0f; };
+    Physics::PhysicsBody* targetBody = sim.getBodyById(targetID);
+
+    return [stop = *this, &sim, subject, targetBody]() -> float {
+        float currentVal = 0.0f;
+
+        switch (stop.prop) {
+        case 0: // Pos Y
+            currentVal = subject->getPosition(BodyLock::LOCK).y;
+            break;
+
+        case 1: // Vel Y
+            currentVal = subject->getVelocity(BodyLock::LOCK).y;
+            break;
+
+        case 2: // Distance to Object
+        {
+            if (targetBody) {
+                auto getClosestOnBody = [&](Physics::PhysicsBody* b, const glm::vec3& targetPos) -> glm::vec3 {
+                    if (auto* col = b->getCollider()) {
+                        return col->closestPoint(targetPos).point;
+                    } else {
+                        return b->getPosition(BodyLock::LOCK);
+                    }
+                };
+
+                glm::vec3 centerSubject = subject->getPosition(BodyLock::LOCK);
+                glm::vec3 pTarget = getClosestOnBody(targetBody, centerSubject);
+                glm::vec3 pSubject = getClosestOnBody(subject, pTarget);
+
+                currentVal = glm::distance(pSubject, pTarget);
+            } else {
+                currentVal = kMissingTargetDistance;
+            }
+            break;
+        }
+
+        case 3: // Distance to Point
+            currentVal = glm::distance(subject->getPosition(BodyLock::LOCK), stop.targetPoint);
+            break;
+
+        case 4: // Time
+            currentVal = sim.simTime;
+            break;
+        }
+
+        if (stop.op == 0) {
+            return (currentVal - stop.val);
+        }
+        else {
+            return (stop.val - currentVal);
+        }
+    };
+}
+
 void ProblemRouter::registerKinematicsProblems() {
     constexpr double maxSimTime = 10.0; // Seconds
 
@@ -158,79 +231,29 @@ void ProblemRouter::registerKinematicsProblems() {
         body->setPosition(r0, BodyLock::LOCK);
         body->setVelocity(v0, BodyLock::LOCK);
 
-        int subjectID = (int)knowns.at("Stop_SubjectID");
-        int prop      = (int)knowns.at("Stop_Prop");
-        int op        = (int)knowns.at("Stop_Op");
-        float val     = (float)knowns.at("Stop_Val");
-
-        if (subjectID == -1) {
+        const StopMonitor stop = StopMonitor::fromKnowns(knowns);
+        if (stop.subjectID == -1) {
             std::cout << "Solver Error: No subject selected." << std::endl;
             auto dummyMonitor = []() { return -1.0f; };
             auto dummyTimeout = []() { return true; };
             return std::make_unique<InterceptSolver>(dummyMonitor, dummyTimeout);
         }
 
-        Physics::PhysicsBody* subject = physicsSystem.getBodyById(subjectID);
-        if (!subject) { /* Handle missing subject safely if needed */ }
-
-        int targetID = (int)knowns.at("Stop_TargetID");
-        glm::vec3 targetPoint(knowns.at("Stop_Val_X"), knowns.at("Stop_Val_Y"), knowns.at("Stop_Val_Z"));
-        Physics::PhysicsBody* targetBody = physicsSystem.getBodyById(targetID);
-
-        auto monitor = [=, this]() -> float {
-            float currentVal = 0.0f;
-
-            switch (prop) {
-            case 0: // Pos Y
-                currentVal = subject->getPosition(BodyLock::LOCK).y;
-                break;
-
-            case 1: // Vel Y
-                currentVal = subject->getVelocity(BodyLock::LOCK).y;
-                break;
-
-            case 2: // Distance to Object
-            {
-                if (targetBody) {
-                    auto getClosestOnBody = [&](Physics::PhysicsBody* b, const glm::vec3& targetPos) -> glm::vec3 {
-                        if (auto* col = b->getCollider()) {
-                            return col->closestPoint(targetPos).point;
-                        } else {
-                            return b->getPosition(BodyLock::LOCK);
-                        }
-                    };
-
-                    glm::vec3 centerSubject = subject->getPosition(BodyLock::LOCK);
-                    glm::vec3 pTarget = getClosestOnBody(targetBody, centerSubject);
-                    glm::vec3 pSubject = getClosestOnBody(subject, pTarget);
-
-                    currentVal = glm::distance(pSubject, pTarget);
-                } else {
-                    currentVal = kMissingTargetDistance;
-                }
-                break;
-            }
-
-            case 3: // Distance to Point
-                currentVal = glm::distance(subject->getPosition(BodyLock::LOCK), targetPoint);
-                break;
-
-            case 4: // Time
-                currentVal = physicsSystem.simTime;
-                break;
-            }
-
-            if (op == 0) {
-                return (currentVal - val);
-            }
-            else {
-                return (val - currentVal);
-            }
-        };
+        auto monitor = stop.bind(physicsSystem);
 
         auto timeout = [=]() { return false; }; // TODO: temporary no timeout
 
-        return std::make_unique<InterceptSolver>(monitor, timeout);
+        auto solver = std::make_unique<InterceptSolver>(monitor, timeout);
+
+        // Bisect the crossing inside the last step, so the event time does not depend on dt
+        auto checkpoint = std::make_shared<Physics::StateCheckpoint>();
+        solver->setRewind({
+            [this, checkpoint]() { physicsSystem.captureCheckpoint(*checkpoint); },
+            [this, checkpoint]() { physicsSystem.restoreCheckpoint(*checkpoint); },
+            [this](double dt) { physicsSystem.advancePhysics(static_cast<float>(dt)); },
+            [this]() { return physicsSystem.simTime; }
+        });
+        return solver;
     };
     solverMap["Event"].push_back(eventEntry);
 
@@ -270,9 +293,10 @@ void ProblemRouter::registerKinematicsProblems() {
             body->setVelocity(guess_v0, BodyLock::LOCK);
         };
 
-        auto stopCondition = [=, this]() -> bool {
+        // Shared by the live run and the forked runs, which pass their own copies of the bodies
+        auto stopWhen = [=](const Physics::PhysicsSystem& sim, Physics::PhysicsBody* subjectBody, Physics::PhysicsBody* targetBody) -> bool {
             if (targetTime > 0.0f) {
-                return physicsSystem.simTime >= targetTime;
+                return sim.simTime >= targetTime;
             }
             if (!subjectBody) return true; // Safety check
 
@@ -301,17 +325,78 @@ void ProblemRouter::registerKinematicsProblems() {
             else return (currentVal >= val);
         };
 
+        auto stopCondition = [=, this]() -> bool {
+            return stopWhen(physicsSystem, subjectBody, targetBody);
+        };
+
         auto extractor = [=]() -> glm::vec3 {
             return body->getPosition(BodyLock::LOCK);
         };
 
-        return std::make_unique<VectorRootSolver<glm::vec3, glm::vec3>>(
+        auto solver = std::make_unique<VectorRootSolver<glm::vec3, glm::vec3>>(
             setter, stopCondition, extractor, targetPos,
             kVelocitySolverTolerance,
             kVelocitySolverMaxIterations,
             kVelocitySolverJacobianStep,
             kVelocitySolverDamping
         );
+        // One fork per iteration once the first Jacobian is known, instead of four
+        solver->setJacobianUpdate(JacobianUpdate::Broyden);
+
+        // Base and perturbed guesses of each Newton iteration run concurrently on forks of the t=0 scene.
+        // The forks are stepped off the physics thread, which keeps publishing snapshots of the live
+        // scene running the base guess meanwhile, and the converged fork's run is adopted as it is
+        struct ForkBatch {
+            std::vector<std::unique_ptr<Physics::PhysicsSystem>> systems;
+            std::vector<std::array<Physics::PhysicsBody*, 3>> bodies; // body, stop subject, stop target
+        };
+        struct ForkState {
+            std::shared_ptr<ForkBatch> lastBatch;
+            std::shared_ptr<Physics::ThreadPool> lonePool; // Broyden iterations after the first run a single fork, on this pool of the live size
+            std::atomic<bool> cancelled{false};            // set once the solver goes away, forks stop at their next step
+        };
+        auto forks = std::make_shared<ForkState>();
+        const uint32_t bodyID = body->getID();
+        solver->setBatchEvaluator([=, this](const std::vector<glm::vec3>& guesses) {
+            setter(guesses[0]);
+            std::shared_ptr<Physics::ThreadPool> forkPool;
+            if (guesses.size() == 1) {
+                if (!forks->lonePool) forks->lonePool = std::make_shared<Physics::ThreadPool>(physicsSystem.pool->size());
+                forkPool = forks->lonePool;
+            }
+            auto batch = std::make_shared<ForkBatch>();
+            for (const glm::vec3& guess : guesses) {
+                batch->systems.push_back(physicsSystem.cloneUnlocked(forkPool));
+                Physics::PhysicsSystem& fork = *batch->systems.back();
+                batch->bodies.push_back({ fork.getBodyById(bodyID), fork.getBodyById(subjectID), fork.getBodyById(stopTargetID) });
+                batch->bodies.back()[0]->setVelocity(guess, BodyLock::LOCK);
+            }
+            forks->lastBatch = batch;
+
+            const float dt = physicsSystem.getLastStepDt();
+            return std::async(std::launch::async, [batch, forks, dt, stopWhen]() {
+                std::vector<Physics::PhysicsSystem*> runs;
+                for (const auto& fork : batch->systems) runs.push_back(fork.get());
+                Physics::CloneRunner::shared().run(runs, dt,
+                    [&](const Physics::PhysicsSystem& fork, std::size_t i) {
+                        return forks->cancelled.load(std::memory_order_relaxed) || stopWhen(fork, batch->bodies[i][1], batch->bodies[i][2]);
+                    }, kForkMaxSteps);
+
+                std::vector<glm::vec3> results;
+                for (const auto& bodies : batch->bodies) {
+                    results.push_back(bodies[0]->getPosition(BodyLock::LOCK));
+                }
+                return results;
+            });
+        });
+        solver->setBatchAdopter([=, this](std::size_t index) {
+            if (forks->lastBatch) physicsSystem.adoptState(*forks->lastBatch->systems[index]);
+            forks->lastBatch.reset();
+        });
+        solver->setBatchCanceller([forks] {
+            forks->cancelled.store(true, std::memory_order_relaxed);
+        });
+        return solver;
     };
 
     solverMap["v0"].push_back(v0Entry);
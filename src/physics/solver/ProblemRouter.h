@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
+#include <functional>
 #include <memory>
+#include <unordered_map>
 #include "OneUnknownSolver.h"
 #include "VectorRootSolver.h"
 
@@ -14,6 +16,27 @@ enum class SolverMode {
     SOLVE // unknown must be solved using VectorRootSolver
 };
 
+/**
+ * @brief The Stop_* knowns of a problem, evaluated on any PhysicsSystem
+ *
+ * Shared by the Event solver and EnsembleRunner, so the live scene, a clone and
+ * every ensemble member stop on the same event.
+ */
+struct StopMonitor {
+    int subjectID = -1;
+    int prop = 0;     // 0 pos Y, 1 vel Y, 2 distance to the target body, 3 distance to targetPoint, 4 time
+    int op = 0;       // 0 stops once the property falls to val, otherwise once it rises to it
+    float val = 0.0f;
+    int targetID = -1;
+    glm::vec3 targetPoint{0.0f};
+
+    static StopMonitor fromKnowns(const std::unordered_map<std::string, double>& knowns);
+
+    // Reads sim's own bodies: > 0 to continue, <= 0 once the event happened, as InterceptSolver expects.
+    // A missing subject stops straight away
+    std::function<float()> bind(const Physics::PhysicsSystem& sim) const;
+};
+
 struct SolverDecision {
     SolverMode mode;
     std::unique_ptr<ISolver> solver; // nullptr if direct simulation
@@ -1,33 +1,80 @@
 #include "VectorRootSolver.h"
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <utility>
 
 namespace {
-constexpr float kSingularJacobianDeterminant = 1.0e-8f;
-constexpr float kSingularJacobianNudgeFactor = 0.01f;
+constexpr double kSingularJacobianDeterminant = 1.0e-8;
+constexpr double kSingularJacobianNudgeFactor = 0.01;
+
+// Solves A x = b in place (A is n x n, row-major) with partial pivoting, returns det(A)
+double solveLinear(std::vector<double>& A, std::vector<double>& b) {
+    const std::size_t n = b.size();
+    double det = 1.0;
+    for (std::size_t col = 0; col < n; ++col) {
+        std::size_t pivot = col;
+        for (std::size_t row = col + 1; row < n; ++row) {
+            if (std::abs(A[row * n + col]) > std::abs(A[pivot * n + col])) pivot = row;
+        }
+        if (pivot != col) {
+            for (std::size_t k = 0; k < n; ++k) std::swap(A[col * n + k], A[pivot * n + k]);
+            std::swap(b[col], b[pivot]);
+            det = -det;
+        }
+        det *= A[col * n + col];
+        if (A[col * n + col] == 0.0) return 0.0;
+
+        for (std::size_t row = col + 1; row < n; ++row) {
+            const double factor = A[row * n + col] / A[col * n + col];
+            for (std::size_t k = col; k < n; ++k) A[row * n + k] -= factor * A[col * n + k];
+            b[row] -= factor * b[col];
+        }
+    }
+    for (std::size_t col = n; col-- > 0;) {
+        for (std::size_t k = col + 1; k < n; ++k) b[col] -= A[col * n + k] * b[k];
+        b[col] /= A[col * n + col];
+    }
+    return det;
+}
 }
 
 template<typename InputT, typename OutputT>
-VectorRootSolver<InputT, OutputT>::VectorRootSolver(InitialGuessSetter initialGuessSetter, StopCondition stopCondition, ResultExtractor extractResult, const OutputT &tgt, double tol, int maxIter, double jacobianStep, double damping)
-    : setGuess(std::move(initialGuessSetter)), stopCondition(std::move(stopCondition)), extract(std::move(extractResult)), target(tgt), current(static_cast<InputT>(0)), maxIterations(maxIter), h(jacobianStep), tolerance(tol), alpha(damping) {
-    current = glm::vec3(0.0f); // Our initial guess is all zeroes
-    fPerturbed.fill(glm::vec3(0.0f));
+VectorRootSolver<InputT, OutputT>::VectorRootSolver(InitialGuessSetter initialGuessSetter, StopCondition stopCondition, ResultExtractor extractResult, const OutputT &tgt, double tol, int maxIter, double jacobianStep, double damping, const InputT& initialGuess)
+    : setGuess(std::move(initialGuessSetter)), stopCondition(std::move(stopCondition)), extract(std::move(extractResult)), current(initialGuess), target(tgt), baseOutput(tgt), maxIterations(maxIter), h(jacobianStep), tolerance(tol), alpha(damping) {
+    unknowns = RootVectorTraits<InputT>::size(current);
+    outputs = RootVectorTraits<OutputT>::size(target);
+    fPerturbed.assign(unknowns, target);
+    jacobian.assign(outputs * unknowns, 0.0);
     state = SolverState::WaitingForBase;
+    if (unknowns == 0) {
+        std::cerr << "[VectorRootSolver] Empty initial guess, nothing to solve for." << std::endl;
+    }
+}
+
+template<typename InputT, typename OutputT>
+VectorRootSolver<InputT, OutputT>::~VectorRootSolver() {
+    if (pendingBatch.valid() && cancelBatch) cancelBatch();
 }
 
 template<typename InputT, typename OutputT>
 bool VectorRootSolver<InputT, OutputT>::stepFrame() {
+    if (unknowns == 0) return true;
+
     switch (state) {
         case SolverState::WaitingForBase:
             // Wait until the simulation has run for the current guess.
             // This ensures we have the base output for the current input.
             if (!stopCondition()) return false;
 
-            baseOutput = extract();
-            if (glm::length(baseOutput - target) < tolerance) {
+            if (acceptBase(extract())) {
                 return true;
             }
-            if (iterationCount >= maxIterations) {
-                return true;
+            if (jacobianValid) {
+                // Broyden already updated the Jacobian, no perturbed runs needed
+                newtonStep();
+                setGuess(current);
+                return false;
             }
 
             currentPerturbation = 0;
@@ -36,10 +83,7 @@ bool VectorRootSolver<InputT, OutputT>::stepFrame() {
 
         case SolverState::PerturbComponent:
             // Create a perturbed input by slightly incrementing the current component
-            xPerturbed = current;
-            xPerturbed[currentPerturbation] += h;
-
-            setGuess(xPerturbed); // resets simulation with perturbed guess
+            setGuess(perturbed(currentPerturbation)); // resets simulation with perturbed guess
             state = SolverState::WaitingForPerturbed; // Wait for the simulation to finish with this perturbed guess
             return false;
 
@@ -48,47 +92,212 @@ bool VectorRootSolver<InputT, OutputT>::stepFrame() {
             if (!stopCondition()) return false;
 
             fPerturbed[currentPerturbation] = extract();
+            ++evaluationCount;
 
             currentPerturbation++;
             // Move to the next component to perturb
-            if (currentPerturbation < 3) // TODO: currently only works for F: R^3 -> R^3
+            if (currentPerturbation < unknowns)
                 state = SolverState::PerturbComponent;
             else
                 state = SolverState::ComputeJacobian;
 
             return false;
 
-        case SolverState::ComputeJacobian: {
-            glm::mat3 J(0.0f);
-            for (int j = 0; j < 3; ++j)
-                for (int i = 0; i < 3; ++i) {
-                    // This is an approximation for the partial derivative for small h
-                    J[i][j] = (fPerturbed[j][i] - baseOutput[i]) / h;
-                }
-
-            glm::vec3 error = baseOutput - target;
+        case SolverState::ComputeJacobian:
+            buildJacobian();
+            newtonStep();
+            setGuess(current);
+            state = SolverState::WaitingForBase;
 
-            float detJ = glm::determinant(J);
-            glm::vec3 dx;
+            // Go back to WaitingForBase to check if new guess works
+            return false;
 
-            if (std::abs(detJ) < kSingularJacobianDeterminant) {
-                // Jacobian nearly singular, apply a small nudge in direction of negative error
-                dx = -kSingularJacobianNudgeFactor * error;
-            } else {
-                // Normal Newton step with damping
-                dx = -alpha * glm::inverse(J) * error;
+        case SolverState::EvaluateBatch: {
+            // Base guess, plus one perturbation per unknown whenever a fresh Jacobian is needed, simulated side by side
+            batchHasPerturbations = !jacobianValid || jacobianUpdate == JacobianUpdate::FiniteDifference;
+            std::vector<InputT> guesses{ current };
+            if (batchHasPerturbations) {
+                for (std::size_t j = 0; j < unknowns; ++j) guesses.push_back(perturbed(j));
             }
+            pendingBatch = evaluateBatch(guesses);
+            state = SolverState::WaitingForBatch;
+            return false;
+        }
 
-            current += dx;
-            ++iterationCount;
-            setGuess(current);
-            state = SolverState::WaitingForBase;
+        case SolverState::WaitingForBatch: {
+            if (pendingBatch.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+            const std::vector<OutputT> results = pendingBatch.get();
+            state = SolverState::EvaluateBatch;
 
-            // Go back to WaitingForBase to check if new guess works
+            if (acceptBase(results[0])) {
+                if (adoptBatchResult) {
+                    adoptBatchResult(0);
+                    return true;
+                }
+                // Replay the final guess on the live simulation so its trajectory is kept
+                setGuess(current);
+                state = SolverState::WaitingForFinal;
+                return false;
+            }
+            if (batchHasPerturbations) {
+                for (std::size_t j = 0; j < unknowns; ++j) fPerturbed[j] = results[j + 1];
+                evaluationCount += static_cast<int>(unknowns);
+                buildJacobian();
+            }
+            // Without a valid Jacobian the next batch re-evaluates this guess with perturbations
+            if (jacobianValid) newtonStep();
             return false;
         }
+
+        case SolverState::WaitingForFinal:
+            return stopCondition();
         }
         return false;
 }
 
+template<typename InputT, typename OutputT>
+void VectorRootSolver<InputT, OutputT>::setBatchEvaluator(BatchEvaluator evaluator) {
+    evaluateBatch = std::move(evaluator);
+    state = evaluateBatch ? SolverState::EvaluateBatch : SolverState::WaitingForBase;
+}
+
+template<typename InputT, typename OutputT>
+bool VectorRootSolver<InputT, OutputT>::acceptBase(const OutputT& output) {
+    using Out = RootVectorTraits<OutputT>;
+    using In = RootVectorTraits<InputT>;
+
+    baseOutput = output;
+    ++evaluationCount;
+
+    double errorSq = 0.0;
+    for (std::size_t i = 0; i < outputs; ++i) {
+        const double e = Out::get(baseOutput, i) - Out::get(target, i);
+        errorSq += e * e;
+    }
+    const double error = std::sqrt(errorSq);
+    if (error < tolerance) {
+        return true;
+    }
+    if (iterationCount >= maxIterations) {
+        return true;
+    }
+
+    if (jacobianUpdate == JacobianUpdate::FiniteDifference) {
+        jacobianValid = false;
+    } else if (jacobianValid && !previousGuess.empty()) {
+        if (error >= previousError) {
+            // The last step did not help, start over from finite differences here
+            jacobianValid = false;
+        } else {
+            // Broyden rank-1 update: J += (df - J dx) dx^T / (dx^T dx)
+            std::vector<double> dx(unknowns);
+            double dxSq = 0.0;
+            for (std::size_t j = 0; j < unknowns; ++j) {
+                dx[j] = In::get(current, j) - previousGuess[j];
+                dxSq += dx[j] * dx[j];
+            }
+            if (dxSq > 0.0) {
+                for (std::size_t i = 0; i < outputs; ++i) {
+                    double residual = Out::get(baseOutput, i) - previousOutput[i];
+                    for (std::size_t j = 0; j < unknowns; ++j) residual -= jacobian[i * unknowns + j] * dx[j];
+                    for (std::size_t j = 0; j < unknowns; ++j) jacobian[i * unknowns + j] += residual * dx[j] / dxSq;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+template<typename InputT, typename OutputT>
+InputT VectorRootSolver<InputT, OutputT>::perturbed(std::size_t component) const {
+    using In = RootVectorTraits<InputT>;
+    InputT x = current;
+    In::set(x, component, In::get(x, component) + h);
+    return x;
+}
+
+template<typename InputT, typename OutputT>
+void VectorRootSolver<InputT, OutputT>::buildJacobian() {
+    using Out = RootVectorTraits<OutputT>;
+    for (std::size_t j = 0; j < unknowns; ++j)
+        for (std::size_t i = 0; i < outputs; ++i) {
+            // This is an approximation for the partial derivative for small h
+            jacobian[i * unknowns + j] = (Out::get(fPerturbed[j], i) - Out::get(baseOutput, i)) / h;
+        }
+    jacobianValid = true;
+}
+
+template<typename InputT, typename OutputT>
+void VectorRootSolver<InputT, OutputT>::newtonStep() {
+    using Out = RootVectorTraits<OutputT>;
+    using In = RootVectorTraits<InputT>;
+    const std::size_t m = outputs;
+    const std::size_t n = unknowns;
+
+    std::vector<double> error(m);
+    double errorSq = 0.0;
+    for (std::size_t i = 0; i < m; ++i) {
+        error[i] = Out::get(baseOutput, i) - Out::get(target, i);
+        errorSq += error[i] * error[i];
+    }
+    auto J = [&](std::size_t i, std::size_t j) { return jacobian[i * n + j]; };
+
+    // Square: J dx = -e. Over-determined: (J^T J) dx = -J^T e. Under-determined: dx = -J^T (J J^T)^-1 e
+    std::vector<double> dx(n, 0.0);
+    double detJ;
+    if (m >= n) {
+        std::vector<double> A(n * n, 0.0);
+        for (std::size_t r = 0; r < n; ++r) {
+            for (std::size_t c = 0; c < n; ++c) {
+                if (m == n) {
+                    A[r * n + c] = J(r, c);
+                } else {
+                    for (std::size_t i = 0; i < m; ++i) A[r * n + c] += J(i, r) * J(i, c);
+                }
+            }
+            if (m == n) {
+                dx[r] = -error[r];
+            } else {
+                for (std::size_t i = 0; i < m; ++i) dx[r] -= J(i, r) * error[i];
+            }
+        }
+        detJ = solveLinear(A, dx);
+    } else {
+        std::vector<double> A(m * m, 0.0);
+        std::vector<double> y = error;
+        for (std::size_t r = 0; r < m; ++r)
+            for (std::size_t c = 0; c < m; ++c)
+                for (std::size_t j = 0; j < n; ++j) A[r * m + c] += J(r, j) * J(c, j);
+        detJ = solveLinear(A, y);
+        for (std::size_t j = 0; j < n; ++j)
+            for (std::size_t i = 0; i < m; ++i) dx[j] -= J(i, j) * y[i];
+    }
+
+    if (std::abs(detJ) < kSingularJacobianDeterminant) {
+        // Jacobian nearly singular, apply a small nudge in direction of negative error
+        for (std::size_t j = 0; j < n; ++j) {
+            double downhill = 0.0;
+            if (m == n) {
+                downhill = error[j];
+            } else {
+                for (std::size_t i = 0; i < m; ++i) downhill += J(i, j) * error[i];
+            }
+            dx[j] = -kSingularJacobianNudgeFactor * downhill;
+        }
+    } else {
+        // Normal Newton step with damping
+        for (double& step : dx) step *= alpha;
+    }
+
+    previousGuess.resize(n);
+    previousOutput.resize(m);
+    for (std::size_t j = 0; j < n; ++j) previousGuess[j] = In::get(current, j);
+    for (std::size_t i = 0; i < m; ++i) previousOutput[i] = Out::get(baseOutput, i);
+    previousError = std::sqrt(errorSq);
+
+    for (std::size_t j = 0; j < n; ++j) In::set(current, j, In::get(current, j) + dx[j]);
+    ++iterationCount;
+}
+
 template class VectorRootSolver<glm::vec3, glm::vec3>;
+template class VectorRootSolver<std::vector<double>, std::vector<double>>;
@@ -1,21 +1,71 @@
 #pragma once
-#include <array>
+#include <cstddef>
 #include <functional>
+#include <future>
+#include <utility>
+#include <vector>
 #include <glm/glm.hpp>
 
 #include "ISolver.h"
 
+/**
+ * @brief Element access for the vector types VectorRootSolver works on
+ *
+ * Specialised for glm::vec3 and std::vector<double> (size taken from the value,
+ * for an arbitrary number of unknowns). fixedSize tells whether a default
+ * constructed value already has the right number of elements.
+ */
+template<typename T>
+struct RootVectorTraits;
+
+template<>
+struct RootVectorTraits<glm::vec3> {
+    static constexpr bool fixedSize = true;
+    static std::size_t size(const glm::vec3&) { return 3; }
+    static double get(const glm::vec3& v, std::size_t i) { return static_cast<double>(v[static_cast<int>(i)]); }
+    static void set(glm::vec3& v, std::size_t i, double value) { v[static_cast<int>(i)] = static_cast<float>(value); }
+};
+
+template<>
+struct RootVectorTraits<std::vector<double>> {
+    static constexpr bool fixedSize = false;
+    static std::size_t size(const std::vector<double>& v) { return v.size(); }
+    static double get(const std::vector<double>& v, std::size_t i) { return v[i]; }
+    static void set(std::vector<double>& v, std::size_t i, double value) { v[i] = value; }
+};
+
+/**
+ * @brief Selects how VectorRootSolver keeps its Jacobian between iterations
+ */
+enum class JacobianUpdate {
+    FiniteDifference, // N extra simulations every iteration
+    Broyden           // finite differences once, then a rank-1 update from each new result
+};
+
 /**
  * @brief A vector-valued root solver using Newton's method.
  *
  * This class attempts to find the input vector `current` such that
  * the output of a function (extracted via `ResultExtractor`) matches
- * a given target vector. It works in n-dimensional space (TODO: currently specialized for 3D vectors),
- * using finite-difference approximations for the Jacobian.
+ * a given target vector. It works with N unknowns and M outputs, using
+ * finite-difference approximations for the Jacobian. Square systems take a
+ * Newton step, M > N a Gauss-Newton least-squares step and M < N the
+ * minimum-norm step.
+ *
+ * With JacobianUpdate::Broyden the finite-difference Jacobian is only built for
+ * the first iteration, and again whenever an iteration fails to reduce the error.
+ * In between it is corrected by Broyden's rank-1 update, so an iteration costs
+ * one simulation instead of N + 1.
  *
  * The solver is designed to work asynchronously with a simulation loop:
  * - It does not advance the simulation internally.
  * - External code calls `stepFrame()` repeatedly after the simulation has advanced.
+ *
+ * With a BatchEvaluator the base and perturbed guesses of an iteration are instead
+ * handed over together, to be simulated concurrently on forked scenes. The evaluator
+ * returns a future and `stepFrame()` only polls it, so a batch never blocks the
+ * caller. Once the base guess converges, a BatchAdopter lets the caller keep that
+ * evaluation's run; without one the final guess is replayed on the live simulation.
  */
 template<typename InputT, typename OutputT>
 class VectorRootSolver : public ISolver {
@@ -23,6 +73,9 @@ public:
     using InitialGuessSetter = std::function<void(const InputT&)>; // Sets the value for the unknown parameter we are solving for
     using StopCondition = std::function<bool()>; // Runs the simulation up until a stop condition is reached
     using ResultExtractor = std::function<OutputT()>; // Gets a value to compare to the target value after an iteration
+    using BatchEvaluator = std::function<std::future<std::vector<OutputT>>(const std::vector<InputT>&)>; // Runs every guess to the stop condition independently, results in order
+    using BatchAdopter = std::function<void(std::size_t)>; // Keeps the run of the given guess of the last batch as the solution
+    using BatchCanceller = std::function<void()>; // Asks the batch in flight to finish early, its results are dropped
 
     /**
      * @brief Construct a new VectorRootSolver object
@@ -35,7 +88,19 @@ public:
      * @param maxIterations Maximum number of Newton iterations before giving up
      * @param jacobianStep Step size for finite-difference Jacobian approximation
      * @param damping Damping factor (alpha) for Newton step
+     * @param initialGuess Starting point, also fixes the number of unknowns for std::vector inputs
      */
+    VectorRootSolver(InitialGuessSetter initialGuessSetter,
+                     StopCondition stopCondition,
+                     ResultExtractor extractResult,
+                     const OutputT& target,
+                     double tolerance,
+                     int maxIterations,
+                     double jacobianStep,
+                     double damping,
+                     const InputT& initialGuess);
+
+    // Starts from zero; only for fixed-size inputs, a std::vector has to be given its initial guess
     VectorRootSolver(InitialGuessSetter initialGuessSetter,
                      StopCondition stopCondition,
                      ResultExtractor extractResult,
@@ -43,7 +108,12 @@ public:
                      double tolerance = 1e-3,
                      int maxIterations = 30,
                      double jacobianStep = 0.01,
-                     double damping = 1.0);
+                     double damping = 1.0) requires RootVectorTraits<InputT>::fixedSize
+        : VectorRootSolver(std::move(initialGuessSetter), std::move(stopCondition), std::move(extractResult), target,
+                           tolerance, maxIterations, jacobianStep, damping, InputT(0)) {}
+
+    // Cancels a batch still in flight, so destroying the solver does not wait for it to run out
+    ~VectorRootSolver() override;
 
     /**
      * @brief Performs one iteration of the vector root-finding solver.
@@ -67,26 +137,66 @@ public:
      */
     bool stepFrame() override;
 
+    /**
+     * @brief Evaluates the base and perturbed guesses of each iteration together
+     *
+     * Must be set before the first `stepFrame()`. The evaluator may reset the live
+     * simulation. Without an adopter the final guess is applied through `setGuess()`
+     * afterwards and run to the stop condition once more.
+     */
+    void setBatchEvaluator(BatchEvaluator evaluator);
+    // Called with the index of the converged guess in the last batch instead of replaying it
+    void setBatchAdopter(BatchAdopter adopter) { adoptBatchResult = std::move(adopter); }
+    void setBatchCanceller(BatchCanceller canceller) { cancelBatch = std::move(canceller); }
+
+    // Defaults to FiniteDifference. Set before the first `stepFrame()`
+    void setJacobianUpdate(JacobianUpdate mode) { jacobianUpdate = mode; }
+
+    const InputT& getCurrentGuess() const { return current; }
+    int getIterationCount() const { return iterationCount; }
+    int getEvaluationCount() const { return evaluationCount; } // simulations run so far, perturbed ones included
+
 private:
     enum class SolverState {
-        WaitingForBase, PerturbComponent, WaitingForPerturbed, ComputeJacobian
+        WaitingForBase, PerturbComponent, WaitingForPerturbed, ComputeJacobian, EvaluateBatch, WaitingForBatch, WaitingForFinal
     };
     SolverState state;
 
+    // Takes the base output of the current guess; true once converged or out of iterations
+    bool acceptBase(const OutputT& output);
+    InputT perturbed(std::size_t component) const;
+    void buildJacobian();
+    // Updates current from baseOutput and the Jacobian
+    void newtonStep();
+
     InitialGuessSetter setGuess;
     StopCondition stopCondition;
     ResultExtractor extract;
+    BatchEvaluator evaluateBatch;
+    BatchAdopter adoptBatchResult;
+    BatchCanceller cancelBatch;
+    std::future<std::vector<OutputT>> pendingBatch;
+    bool batchHasPerturbations = false;
+    JacobianUpdate jacobianUpdate = JacobianUpdate::FiniteDifference;
 
     InputT current;   // current guess for unknown(s)
-    glm::vec3 target;
-    glm::vec3 baseOutput;
-    glm::vec3 xPerturbed;
-    std::array<glm::vec3, 3> fPerturbed;
+    OutputT target;
+    OutputT baseOutput;
+    std::vector<OutputT> fPerturbed;
+    std::size_t unknowns;
+    std::size_t outputs;
+
+    std::vector<double> jacobian; // outputs x unknowns, row-major
+    bool jacobianValid = false;
+    std::vector<double> previousGuess;
+    std::vector<double> previousOutput;
+    double previousError = 0.0;
 
-    int currentPerturbation = -1;
+    std::size_t currentPerturbation = 0;
     int iterationCount = 0;
+    int evaluationCount = 0;
     int maxIterations;
-    float h;
-    float tolerance;
-    float alpha;
+    double h;
+    double tolerance;
+    double alpha;
 };
@@ -8,6 +8,10 @@ void BVH::clear() {
     nodes.clear();
 }
 
+glm::vec3 BVH::relativePosition(const Physics::PhysicsBody* body) const {
+    return glm::vec3(body->getPositionPrecise(BodyLock::NOLOCK) - origin);
+}
+
 NodeIndex BVH::allocateNode() {
     nodes.push_back(BVHNode());
     return NodeIndex{static_cast<int>(nodes.size() - 1)};
@@ -17,6 +21,11 @@ void BVH::build(std::vector<Physics::PhysicsBody*> bodies) {
     BVH::clear();
     if (bodies.empty()) return;
     nodes.reserve(bodies.size() * 2);
+
+    origin = glm::dvec3(0.0);
+    for (const Physics::PhysicsBody* body : bodies) origin += body->getPositionPrecise(BodyLock::NOLOCK);
+    origin /= static_cast<double>(bodies.size());
+
     build(bodies, NodeIndex{0}, NodeIndex{static_cast<int>(bodies.size())});
 }
 
@@ -27,11 +36,12 @@ NodeIndex BVH::build(std::vector<Physics::PhysicsBody*>& bodies, NodeIndex start
     // Base case, leaf node has a body and its own bounds
     if (end.val - start.val == 1) {
         Physics::PhysicsBody* body              = bodies[start.val];
-        glm::vec3 pos                           = body->getPosition(BodyLock::NOLOCK);
         Physics::Bounding::ICollider* collider  = body->getCollider();
 
-        std::unique_ptr<Physics::Bounding::ICollider> worldCollider = 
-            collider->getTransformed(body->getWorldTransform(BodyLock::NOLOCK));
+        // The float transform only keeps orientation and scale, the translation comes from the precise position
+        glm::mat4 transform = body->getWorldTransform(BodyLock::NOLOCK);
+        transform[3] = glm::vec4(relativePosition(body), 1.0f);
+        std::unique_ptr<Physics::Bounding::ICollider> worldCollider = collider->getTransformed(transform);
 
         glm::vec3 minCorner = worldCollider->getAABBMin();
         glm::vec3 maxCorner = worldCollider->getAABBMax();
@@ -45,10 +55,10 @@ NodeIndex BVH::build(std::vector<Physics::PhysicsBody*>& bodies, NodeIndex start
         return nodeIdx;
     }
 
-    glm::vec3 centroidMin = bodies[start.val]->getPosition(BodyLock::NOLOCK);
-    glm::vec3 centroidMax = bodies[start.val]->getPosition(BodyLock::NOLOCK);
+    glm::vec3 centroidMin = relativePosition(bodies[start.val]);
+    glm::vec3 centroidMax = centroidMin;
     for (int i = start.val + 1; i < end.val; i++) {
-        glm::vec3 pos = bodies[i]->getPosition(BodyLock::NOLOCK);
+        glm::vec3 pos = relativePosition(bodies[i]);
         centroidMin = glm::min(centroidMin, pos);
         centroidMax = glm::max(centroidMax, pos);
     }
@@ -66,8 +76,8 @@ NodeIndex BVH::build(std::vector<Physics::PhysicsBody*>& bodies, NodeIndex start
         bodies.begin() + mid,
         bodies.begin() + end.val,
         [splitAxis](Physics::PhysicsBody* a, Physics::PhysicsBody* b) {
-            return a->getPosition(BodyLock::NOLOCK)[splitAxis] < 
-                    b->getPosition(BodyLock::NOLOCK)[splitAxis];
+            return a->getPositionPrecise(BodyLock::NOLOCK)[splitAxis] <
+                    b->getPositionPrecise(BodyLock::NOLOCK)[splitAxis];
         }
     );
     NodeIndex leftIdx = build(bodies, start, NodeIndex{mid});
@@ -162,4 +172,70 @@ std::vector<std::pair<Physics::PhysicsBody*, Physics::PhysicsBody*>> BVH::getPot
     return potentialCollisions;
 }
 
+std::vector<std::pair<Physics::PhysicsBody*, Physics::PhysicsBody*>> BVH::getPotentialCollisions(const BVH& other) const {
+    std::vector<std::pair<Physics::PhysicsBody*, Physics::PhysicsBody*>> potentialCollisions;
+    if (nodes.empty() || other.nodes.empty()) return potentialCollisions;
+
+    // other's bounds are moved into this tree's frame before every test
+    const glm::vec3 offset(other.origin - origin);
+    auto overlaps = [&offset](const Physics::Bounding::AABB& a, const Physics::Bounding::AABB& b) {
+        const glm::vec3 bMin = b.getAABBMin() + offset;
+        const glm::vec3 bMax = b.getAABBMax() + offset;
+        const glm::vec3 aMin = a.getAABBMin();
+        const glm::vec3 aMax = a.getAABBMax();
+        return aMin.x <= bMax.x && aMax.x >= bMin.x
+            && aMin.y <= bMax.y && aMax.y >= bMin.y
+            && aMin.z <= bMax.z && aMax.z >= bMin.z;
+    };
+
+    const BVHNode& rootA = nodes[NodeIndex::rootIndex().val];
+    const BVHNode& rootB = other.nodes[NodeIndex::rootIndex().val];
+    if (!overlaps(rootA.bounds, rootB.bounds)) return potentialCollisions;
+
+    // Same descent as the self query, but the two indices always address different trees
+    std::vector<std::pair<NodeIndex, NodeIndex>> stack;
+    stack.reserve(512);
+    stack.emplace_back(NodeIndex::rootIndex(), NodeIndex::rootIndex());
+
+    while (!stack.empty()) {
+        auto [idxA, idxB] = stack.back();
+        stack.pop_back();
 
+        const BVHNode& a = nodes[idxA.val];
+        const BVHNode& b = other.nodes[idxB.val];
+
+        if (a.isLeaf() && b.isLeaf()) {
+            potentialCollisions.emplace_back(a.body, b.body);
+            continue;
+        }
+
+        bool splitA;
+        if (a.isLeaf()) {
+            splitA = false;
+        } else if (b.isLeaf()) {
+            splitA = true;
+        } else {
+            glm::vec3 extentA = a.bounds.getAABBMax() - a.bounds.getAABBMin();
+            glm::vec3 extentB = b.bounds.getAABBMax() - b.bounds.getAABBMin();
+            splitA = glm::compMul(extentA) > glm::compMul(extentB);
+        }
+
+        if (splitA) {
+            if (overlaps(nodes[a.left.val].bounds, b.bounds)) {
+                stack.emplace_back(a.left, idxB);
+            }
+            if (overlaps(nodes[a.right.val].bounds, b.bounds)) {
+                stack.emplace_back(a.right, idxB);
+            }
+        } else {
+            if (overlaps(a.bounds, other.nodes[b.left.val].bounds)) {
+                stack.emplace_back(idxA, b.left);
+            }
+            if (overlaps(a.bounds, other.nodes[b.right.val].bounds)) {
+                stack.emplace_back(idxA, b.right);
+            }
+        }
+    }
+
+    return potentialCollisions;
+}
@@ -17,15 +17,25 @@ struct BVHNode {
     }
 };
 
+/**
+ * Bounds are stored relative to the mean position of the bodies the tree was built from,
+ * so float AABBs keep their precision in scenes far from the world origin.
+ */
 class BVH {
 private:
     std::vector<BVHNode> nodes;
+    glm::dvec3 origin{0.0};
 
     void clear();
     NodeIndex allocateNode();
+    glm::vec3 relativePosition(const Physics::PhysicsBody* body) const;
     NodeIndex build(std::vector<Physics::PhysicsBody*>& bodies, NodeIndex start, NodeIndex end);
 public:
     BVH() = default;
     void build(std::vector<Physics::PhysicsBody*> bodies);
     std::vector<std::pair<Physics::PhysicsBody*, Physics::PhysicsBody*>> getPotentialCollisions() const;
+    // Pairs with the first body from this tree and the second from other
+    std::vector<std::pair<Physics::PhysicsBody*, Physics::PhysicsBody*>> getPotentialCollisions(const BVH& other) const;
+    bool empty() const { return nodes.empty(); }
+    const glm::dvec3& getOrigin() const { return origin; }
 };
@@ -0,0 +1,334 @@
+#include "FastMultipole.h"
+#include "physics/Constants.h"
+#include "physics/utils/ThreadPool.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+constexpr std::size_t kCellGrain = 64;
+constexpr std::uint32_t kLeafBodies = 16;  // nodes with at most this many bodies are not split
+constexpr std::uint64_t kDirectPairs = 64; // closer pairs with at most this many body pairs skip straight to P2P
+
+template <typename Fn>
+void forRange(Physics::ThreadPool* pool, std::size_t count, std::size_t grain, Fn&& fn) {
+    if (pool) {
+        pool->parallelFor(count, grain, fn);
+    } else if (count > 0) {
+        fn(std::size_t{0}, count);
+    }
+}
+
+template <typename Fn>
+void forEachChild(const OctreeNode& node, Fn&& fn) {
+    std::uint8_t childMask = node.childMask;
+    while (childMask) {
+        fn(static_cast<std::uint32_t>(node.children[std::countr_zero(childMask)].val));
+        childMask &= (childMask - 1);
+    }
+}
+}
+
+void FastMultipole::assignRoles(const Octree& tree) {
+    const std::vector<OctreeNode>& nodes = tree.nodes;
+    auto roleOf = [&](std::uint32_t n) {
+        return nodes[n].isLeaf() || nodes[n].bodyCount <= kLeafBodies ? Role::Leaf : Role::Internal;
+    };
+
+    // Children always come after their parent
+    roles.assign(nodes.size(), Role::Unused);
+    leaves.clear();
+    roles[0] = roleOf(0);
+    for (std::size_t n = 0; n < nodes.size(); ++n) {
+        if (roles[n] == Role::Leaf) leaves.push_back(static_cast<std::uint32_t>(n));
+        if (roles[n] != Role::Internal) continue;
+        forEachChild(nodes[n], [&](std::uint32_t c) { roles[c] = roleOf(c); });
+    }
+}
+
+void FastMultipole::buildMultipoles(const Octree& tree, Physics::ThreadPool* pool) {
+    const std::vector<OctreeNode>& nodes = tree.nodes;
+    cells.resize(nodes.size());
+
+    // P2M, each leaf over its own range
+    forRange(pool, leaves.size(), kCellGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t l = begin; l < end; ++l) {
+            const OctreeNode& node = nodes[leaves[l]];
+            Cell cell;
+            cell.center = glm::dvec3(node.massCenter);
+            cell.mass = node.totalMass;
+            for (std::uint32_t k = node.firstBody; k < node.firstBody + node.bodyCount; ++k) {
+                const OctreeBody& body = tree.packed[k];
+                const glm::dvec3 s = glm::dvec3(body.position) - cell.center;
+                cell.quadrupole.xx += body.mass * s.x * s.x;
+                cell.quadrupole.xy += body.mass * s.x * s.y;
+                cell.quadrupole.xz += body.mass * s.x * s.z;
+                cell.quadrupole.yy += body.mass * s.y * s.y;
+                cell.quadrupole.yz += body.mass * s.y * s.z;
+                cell.quadrupole.zz += body.mass * s.z * s.z;
+                cell.radius = std::max(cell.radius, glm::length(s));
+            }
+            cells[leaves[l]] = cell;
+        }
+    });
+
+    // M2M, in reverse so children are summed first
+    for (std::size_t n = nodes.size(); n-- > 0;) {
+        if (roles[n] != Role::Internal) continue;
+        const OctreeNode& node = nodes[n];
+
+        Cell cell;
+        cell.center = glm::dvec3(node.massCenter);
+        cell.mass = node.totalMass;
+        forEachChild(node, [&](std::uint32_t c) {
+            const Cell& child = cells[c];
+            const glm::dvec3 d = child.center - cell.center;
+            cell.quadrupole.xx += child.quadrupole.xx + child.mass * d.x * d.x;
+            cell.quadrupole.xy += child.quadrupole.xy + child.mass * d.x * d.y;
+            cell.quadrupole.xz += child.quadrupole.xz + child.mass * d.x * d.z;
+            cell.quadrupole.yy += child.quadrupole.yy + child.mass * d.y * d.y;
+            cell.quadrupole.yz += child.quadrupole.yz + child.mass * d.y * d.z;
+            cell.quadrupole.zz += child.quadrupole.zz + child.mass * d.z * d.z;
+            cell.radius = std::max(cell.radius, glm::length(d) + child.radius);
+        });
+        cells[n] = cell;
+    }
+}
+
+void FastMultipole::addNear(const Octree& tree, std::uint32_t sink, std::uint32_t source) {
+    // Bodies only ever receive through their leaf, so leaves can be summed side by side
+    leafStack.clear();
+    leafStack.push_back(sink);
+    while (!leafStack.empty()) {
+        const std::uint32_t n = leafStack.back();
+        leafStack.pop_back();
+        if (roles[n] == Role::Leaf) {
+            nearPairs.emplace_back(n, source);
+        } else {
+            forEachChild(tree.nodes[n], [&](std::uint32_t c) { leafStack.push_back(c); });
+        }
+    }
+}
+
+void FastMultipole::walk(const Octree& tree) {
+    farPairs.clear();
+    nearPairs.clear();
+    stack.clear();
+    stack.emplace_back(0u, 0u);
+
+    while (!stack.empty()) {
+        const auto [a, b] = stack.back();
+        stack.pop_back();
+        const OctreeNode& nodeA = tree.nodes[a];
+        const bool leafA = roles[a] == Role::Leaf;
+
+        // A cell with itself: its children with themselves and with each other
+        if (a == b) {
+            if (leafA) {
+                nearPairs.emplace_back(a, a);
+                continue;
+            }
+            std::uint32_t children[8];
+            int childCount = 0;
+            forEachChild(nodeA, [&](std::uint32_t c) { children[childCount++] = c; });
+            for (int i = 0; i < childCount; ++i) {
+                stack.emplace_back(children[i], children[i]);
+                for (int j = i + 1; j < childCount; ++j) stack.emplace_back(children[i], children[j]);
+            }
+            continue;
+        }
+
+        const OctreeNode& nodeB = tree.nodes[b];
+        const bool leafB = roles[b] == Role::Leaf;
+        const Cell& cellA = cells[a];
+        const Cell& cellB = cells[b];
+        if (cellA.mass == 0.0 && cellB.mass == 0.0) continue;
+
+        const glm::dvec3 d = cellA.center - cellB.center;
+        const double reach = theta * theta * glm::dot(d, d);
+        const double radii = cellA.radius + cellB.radius;
+        if (radii * radii < reach) {
+            farPairs.emplace_back(a, b);
+            farPairs.emplace_back(b, a);
+            continue;
+        }
+
+        const std::uint64_t bodyPairs = static_cast<std::uint64_t>(nodeA.bodyCount) * nodeB.bodyCount;
+        if ((leafA && leafB) || bodyPairs <= kDirectPairs) {
+            addNear(tree, a, b);
+            addNear(tree, b, a);
+            continue;
+        }
+
+        // Split the bigger cell
+        const bool splitA = !leafA && (leafB || cellA.radius >= cellB.radius);
+        if (splitA) {
+            forEachChild(nodeA, [&](std::uint32_t c) { stack.emplace_back(c, b); });
+        } else {
+            forEachChild(nodeB, [&](std::uint32_t c) { stack.emplace_back(a, c); });
+        }
+    }
+}
+
+void FastMultipole::groupBySink(const std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs, std::size_t cellCount,
+                                std::vector<std::uint32_t>& offsets, std::vector<std::uint32_t>& sources) {
+    // Stable counting sort, so every sink sums its sources in walk order
+    offsets.assign(cellCount + 1, 0);
+    for (const auto& pair : pairs) ++offsets[pair.first + 1];
+    for (std::size_t n = 0; n < cellCount; ++n) offsets[n + 1] += offsets[n];
+
+    sources.resize(pairs.size());
+    for (const auto& pair : pairs) sources[offsets[pair.first]++] = pair.second;
+    for (std::size_t n = cellCount; n > 0; --n) offsets[n] = offsets[n - 1];
+    offsets[0] = 0;
+}
+
+void FastMultipole::addFarField(const Cell& sink, const Cell& source, Local& local) {
+    // Derivatives of the softened kernel 1 / sqrt(r^2 + eps^2) at r, contracted with
+    // the source's mass and second moment. Terms up to third order in (r_sink + r_source) / r
+    // are kept, so the force error falls as theta^3
+    const glm::dvec3 r = sink.center - source.center;
+    const double invR2 = 1.0 / (glm::dot(r, r) + Constants::SOFTENING_SQ);
+    const double invR = std::sqrt(invR2);
+    const double d1 = -invR * invR2;
+    const double d2 = -3.0 * d1 * invR2;
+    const double d3 = -5.0 * d2 * invR2;
+    const double d4 = -7.0 * d3 * invR2;
+
+    const Sym3& q = source.quadrupole;
+    const glm::dvec3 qr(q.xx * r.x + q.xy * r.y + q.xz * r.z,
+                        q.xy * r.x + q.yy * r.y + q.yz * r.z,
+                        q.xz * r.x + q.yz * r.y + q.zz * r.z);
+    const double rqr = glm::dot(r, qr);
+    const double trace = q.xx + q.yy + q.zz;
+    const double m = source.mass;
+
+    const double diagonal = m * d1 + 0.5 * (d3 * rqr + d2 * trace);
+    local.field += diagonal * r + d2 * qr;
+
+    // Symmetric, so only the upper triangle
+    const double rr = m * d2 + 0.5 * (d4 * rqr + d3 * trace);
+    auto entry = [&](double ri, double rj, double qri, double qrj, double qij) {
+        return rr * ri * rj + d3 * (ri * qrj + rj * qri) + d2 * qij;
+    };
+    local.gradient.xx += diagonal + entry(r.x, r.x, qr.x, qr.x, q.xx);
+    local.gradient.xy += entry(r.x, r.y, qr.x, qr.y, q.xy);
+    local.gradient.xz += entry(r.x, r.z, qr.x, qr.z, q.xz);
+    local.gradient.yy += diagonal + entry(r.y, r.y, qr.y, qr.y, q.yy);
+    local.gradient.yz += entry(r.y, r.z, qr.y, qr.z, q.yz);
+    local.gradient.zz += diagonal + entry(r.z, r.z, qr.z, qr.z, q.zz);
+
+    // Monopole only, the second moment would be fourth order here
+    const double a = m * d3;
+    const double b = m * d2;
+    Sym33& c = local.curvature;
+    c.xxx += a * r.x * r.x * r.x + 3.0 * b * r.x;
+    c.xxy += a * r.x * r.x * r.y + b * r.y;
+    c.xxz += a * r.x * r.x * r.z + b * r.z;
+    c.xyy += a * r.x * r.y * r.y + b * r.x;
+    c.xyz += a * r.x * r.y * r.z;
+    c.xzz += a * r.x * r.z * r.z + b * r.x;
+    c.yyy += a * r.y * r.y * r.y + 3.0 * b * r.y;
+    c.yyz += a * r.y * r.y * r.z + b * r.z;
+    c.yzz += a * r.y * r.z * r.z + b * r.y;
+    c.zzz += a * r.z * r.z * r.z + 3.0 * b * r.z;
+}
+
+glm::dvec3 FastMultipole::evaluate(const Local& local, const glm::dvec3& y) {
+    const Sym3& g = local.gradient;
+    const Sym33& c = local.curvature;
+    const glm::dvec3 yy(y.x * y.x, y.y * y.y, y.z * y.z);
+    const glm::dvec3 cross(y.x * y.y, y.x * y.z, y.y * y.z);
+    return local.field
+        + glm::dvec3(g.xx * y.x + g.xy * y.y + g.xz * y.z,
+                     g.xy * y.x + g.yy * y.y + g.yz * y.z,
+                     g.xz * y.x + g.yz * y.y + g.zz * y.z)
+        + 0.5 * glm::dvec3(c.xxx * yy.x + c.xyy * yy.y + c.xzz * yy.z + 2.0 * (c.xxy * cross.x + c.xxz * cross.y + c.xyz * cross.z),
+                           c.xxy * yy.x + c.yyy * yy.y + c.yzz * yy.z + 2.0 * (c.xyy * cross.x + c.xyz * cross.y + c.yyz * cross.z),
+                           c.xxz * yy.x + c.yyz * yy.y + c.zzz * yy.z + 2.0 * (c.xyz * cross.x + c.xzz * cross.y + c.yzz * cross.z));
+}
+
+void FastMultipole::addShifted(const Local& local, const glm::dvec3& y, Local& into) {
+    const Sym33& c = local.curvature;
+    into.field += evaluate(local, y);
+    into.gradient.xx += local.gradient.xx + c.xxx * y.x + c.xxy * y.y + c.xxz * y.z;
+    into.gradient.xy += local.gradient.xy + c.xxy * y.x + c.xyy * y.y + c.xyz * y.z;
+    into.gradient.xz += local.gradient.xz + c.xxz * y.x + c.xyz * y.y + c.xzz * y.z;
+    into.gradient.yy += local.gradient.yy + c.xyy * y.x + c.yyy * y.y + c.yyz * y.z;
+    into.gradient.yz += local.gradient.yz + c.xyz * y.x + c.yyz * y.y + c.yzz * y.z;
+    into.gradient.zz += local.gradient.zz + c.xzz * y.x + c.yzz * y.y + c.zzz * y.z;
+    into.curvature.xxx += c.xxx;
+    into.curvature.xxy += c.xxy;
+    into.curvature.xxz += c.xxz;
+    into.curvature.xyy += c.xyy;
+    into.curvature.xyz += c.xyz;
+    into.curvature.xzz += c.xzz;
+    into.curvature.yyy += c.yyy;
+    into.curvature.yyz += c.yyz;
+    into.curvature.yzz += c.yzz;
+    into.curvature.zzz += c.zzz;
+}
+
+void FastMultipole::computeForces(const Octree& tree, double G, std::vector<glm::vec3>& forces, Physics::ThreadPool* pool) {
+    const std::size_t count = tree.packed.size();
+    forces.resize(count);
+    farSources.clear();
+    nearSources.clear();
+    if (tree.nodes.empty() || count == 0) return;
+
+    assignRoles(tree);
+    buildMultipoles(tree, pool);
+    walk(tree);
+    const std::size_t cellCount = cells.size();
+    groupBySink(farPairs, cellCount, farOffsets, farSources);
+    groupBySink(nearPairs, cellCount, nearOffsets, nearSources);
+
+    // M2L, each cell sums what it receives
+    locals.resize(cellCount);
+    forRange(pool, cellCount, kCellGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t n = begin; n < end; ++n) {
+            Local local;
+            for (std::uint32_t s = farOffsets[n]; s < farOffsets[n + 1]; ++s) {
+                addFarField(cells[n], cells[farSources[s]], local);
+            }
+            locals[n] = local;
+        }
+    });
+
+    // L2L, parents before children
+    for (std::size_t n = 0; n < cellCount; ++n) {
+        if (roles[n] != Role::Internal) continue;
+        forEachChild(tree.nodes[n], [&](std::uint32_t c) {
+            addShifted(locals[n], cells[c].center - cells[n].center, locals[c]);
+        });
+    }
+
+    // L2P and P2P, leaves own disjoint ranges of bodies
+    accelerations.resize(count);
+    forRange(pool, leaves.size(), kCellGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t l = begin; l < end; ++l) {
+            const std::uint32_t n = leaves[l];
+            const OctreeNode& node = tree.nodes[n];
+            for (std::uint32_t k = node.firstBody; k < node.firstBody + node.bodyCount; ++k) {
+                const glm::dvec3 position(tree.packed[k].position);
+                glm::dvec3 acceleration = evaluate(locals[n], position - cells[n].center);
+                for (std::uint32_t s = nearOffsets[n]; s < nearOffsets[n + 1]; ++s) {
+                    const OctreeNode& source = tree.nodes[nearSources[s]];
+                    for (std::uint32_t j = source.firstBody; j < source.firstBody + source.bodyCount; ++j) {
+                        if (j == k) continue;
+                        const glm::dvec3 pairDist = glm::dvec3(tree.packed[j].position) - position;
+                        const double invDistSq = 1.0 / (glm::dot(pairDist, pairDist) + Constants::SOFTENING_SQ);
+                        acceleration += (tree.packed[j].mass * invDistSq * std::sqrt(invDistSq)) * pairDist;
+                    }
+                }
+                accelerations[k] = acceleration;
+            }
+        }
+    });
+
+    forRange(pool, count, kCellGrain * 16, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            forces[tree.order[k]] = glm::vec3((G * tree.packed[k].mass) * accelerations[k]);
+        }
+    });
+}
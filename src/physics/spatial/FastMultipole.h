@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Octree.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Physics {
+    class ThreadPool;
+
+    enum class GravitySolver : std::uint8_t {
+        BarnesHut,     // one octree walk per body, O(N log N)
+        FastMultipole  // one dual-tree walk for every body at once, O(N)
+    };
+
+    struct GravityConfig {
+        GravitySolver solver = GravitySolver::BarnesHut;
+        // Barnes-Hut opening criterion, see Octree. Quadrupoles halve the force error at the default
+        // thetaSq and quarter it at 0.25, for about 1.5x the cost per opened node: at 100k bodies, 0.5
+        // with quadrupoles matches the error of 0.25 without in half the time. BM_Octree_ComputeForceAccuracy
+        // measures the trade-off per scene
+        double barnesHutThetaSq = Constants::THETA_SQ;
+        bool quadrupoles = false;
+        // Opening angle of the fast multipole method, in (0, 1), the counterpart of Constants::THETA_SQ.
+        // Two cells interact through their expansions once (rA + rB) < theta * d, r being the radius
+        // around a cell's mass centre that holds all its bodies and d the distance between the centres.
+        // The force error falls about as theta^3: on the benchmark scenes 0.6 gives a mean relative
+        // error of 2e-3 to 4e-3, against 5e-3 to 1e-2 for Barnes-Hut, and 0.8 about matches it.
+        // Scenes dominated by one mass are the exception, Barnes-Hut sums that body exactly
+        double fmmTheta = 0.6;
+    };
+}
+
+/**
+ * @brief Fast multipole gravity over a built Octree
+ *
+ * Every cell carries a multipole expansion about its mass centre (mass and
+ * second moment, the dipole vanishes there), summed bottom-up from the leaves
+ * (P2M, M2M). A single dual-tree walk from the root pairs cells: well separated
+ * pairs add each other's field to a local expansion, the field and its first
+ * two derivatives about the cell's mass centre (M2L); pairs that are too close are
+ * split further, and few bodies or leaves interact body by body (P2P). Local
+ * expansions are then shifted down to the leaves (L2L) and evaluated at each
+ * body (L2P).
+ *
+ * Any octree node with few enough bodies is a leaf here, since the octree
+ * itself splits down to single bodies.
+ *
+ * The walk visits O(N) pairs, against one O(log N) walk per body for
+ * Octree::computeForce. Both use the same Plummer softening. Far interactions
+ * are summed per receiving cell in walk order, so the forces do not depend on
+ * the pool.
+ */
+class FastMultipole {
+public:
+    void setTheta(double theta) { this->theta = theta; }
+    double getTheta() const { return theta; }
+
+    /**
+     * @brief Gravity on every body tree was built from
+     * @param forces resized and filled in the order of the list given to Octree::build
+     */
+    void computeForces(const Octree& tree, double G, std::vector<glm::vec3>& forces, Physics::ThreadPool* pool = nullptr);
+
+    // Pairs of the last walk, each counted once per receiving side
+    std::size_t farInteractionCount() const { return farSources.size(); }
+    std::size_t nearInteractionCount() const { return nearSources.size(); }
+
+private:
+    // Symmetric 3x3 tensor
+    struct Sym3 {
+        double xx = 0.0, xy = 0.0, xz = 0.0, yy = 0.0, yz = 0.0, zz = 0.0;
+    };
+
+    // Symmetric 3x3x3 tensor
+    struct Sym33 {
+        double xxx = 0.0, xxy = 0.0, xxz = 0.0, xyy = 0.0, xyz = 0.0;
+        double xzz = 0.0, yyy = 0.0, yyz = 0.0, yzz = 0.0, zzz = 0.0;
+    };
+
+    struct Cell {
+        glm::dvec3 center{0.0}; // mass centre, where both expansions are taken
+        double mass = 0.0;
+        double radius = 0.0;    // every body of the cell lies within this of center
+        Sym3 quadrupole;        // sum of m * s s^T, s relative to center
+    };
+
+    // Taylor series of the field about the cell's mass centre,
+    // field(center + y) = field + gradient y + curvature y y / 2
+    struct Local {
+        glm::dvec3 field{0.0}; // acceleration at center, without G
+        Sym3 gradient;
+        Sym33 curvature;
+    };
+
+    enum class Role : std::uint8_t { Unused, Internal, Leaf };
+
+    double theta = 0.6;
+
+    // Reused between calls
+    std::vector<Role> roles;            // per node, nodes below a leaf are not used
+    std::vector<std::uint32_t> leaves;
+    std::vector<Cell> cells;
+    std::vector<Local> locals;
+    std::vector<glm::dvec3> accelerations; // per packed body
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> stack;
+    std::vector<std::uint32_t> leafStack;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> farPairs;  // (sink, source), walk order
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> nearPairs; // (sink leaf, source cell)
+    std::vector<std::uint32_t> farOffsets;
+    std::vector<std::uint32_t> farSources;  // farPairs grouped by sink
+    std::vector<std::uint32_t> nearOffsets;
+    std::vector<std::uint32_t> nearSources;
+
+    void assignRoles(const Octree& tree);
+    void buildMultipoles(const Octree& tree, Physics::ThreadPool* pool);
+    void walk(const Octree& tree);
+    void addNear(const Octree& tree, std::uint32_t sink, std::uint32_t source);
+    static void groupBySink(const std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs, std::size_t cellCount,
+                            std::vector<std::uint32_t>& offsets, std::vector<std::uint32_t>& sources);
+    static void addFarField(const Cell& sink, const Cell& source, Local& local);
+    static glm::dvec3 evaluate(const Local& local, const glm::dvec3& y);
+    static void addShifted(const Local& local, const glm::dvec3& y, Local& into); // the same series about center + y
+};
@@ -0,0 +1,117 @@
+#include "LeafKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+
+#if defined(PHYSICS_X86_KERNELS) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+using Physics::LeafKernels::Level;
+
+Level detect() {
+#if !defined(PHYSICS_X86_KERNELS)
+    return Level::Scalar;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return Level::Scalar;
+    __cpuid(info, 1);
+    const bool osSavesAvx = (info[2] & (1 << 27)) != 0; // OSXSAVE
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osSavesAvx) return Level::Scalar;
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0;
+    const bool avx512 = (info[1] & (1 << 16)) != 0;
+    if (avx512 && (xcr0 & 0xe6) == 0xe6) return Level::Avx512;
+    if (avx2 && fma && (xcr0 & 0x6) == 0x6) return Level::Avx2;
+    return Level::Scalar;
+#else
+    // Checks OS support for the wider registers as well
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Level::Avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Level::Avx2;
+    return Level::Scalar;
+#endif
+}
+
+const Level kDetected = detect();
+std::atomic<Level> active{kDetected};
+}
+
+Physics::LeafKernels::Level Physics::LeafKernels::detectedLevel() {
+    return kDetected;
+}
+
+Physics::LeafKernels::Level Physics::LeafKernels::activeLevel() {
+    return active.load(std::memory_order_relaxed);
+}
+
+void Physics::LeafKernels::setLevel(Level level) {
+    active.store(std::min(level, kDetected), std::memory_order_relaxed);
+}
+
+const char* Physics::LeafKernels::levelName(Level level) {
+    switch (level) {
+        case Level::Scalar: return "Scalar";
+        case Level::Avx2: return "AVX2";
+        case Level::Avx512: return "AVX-512";
+    }
+    return "Unknown";
+}
+
+void Physics::LeafKernels::gravity(const Real target[3], const GravitySources& sources, Real softeningSq, Real out[3]) {
+    switch (activeLevel()) {
+#if defined(PHYSICS_X86_KERNELS)
+        case Level::Avx512: return detail::gravityAvx512(target, sources, softeningSq, out);
+        case Level::Avx2: return detail::gravityAvx2(target, sources, softeningSq, out);
+#endif
+        default: return detail::gravityScalar(target, sources, softeningSq, out);
+    }
+}
+
+double Physics::LeafKernels::radiation(const Real target[3], const RadiationSources& sources, double projectedArea, double minDistSq) {
+    switch (activeLevel()) {
+#if defined(PHYSICS_X86_KERNELS)
+        case Level::Avx512: return detail::radiationAvx512(target, sources, projectedArea, minDistSq);
+        case Level::Avx2: return detail::radiationAvx2(target, sources, projectedArea, minDistSq);
+#endif
+        default: return detail::radiationScalar(target, sources, projectedArea, minDistSq);
+    }
+}
+
+void Physics::LeafKernels::detail::gravityScalar(const Real target[3], const GravitySources& sources, Real softeningSq, Real out[3]) {
+    Real sum[3] = { Real(0), Real(0), Real(0) };
+    for (std::size_t i = 0; i < sources.count; ++i) {
+        const Real dx = sources.x[i] - target[0];
+        const Real dy = sources.y[i] - target[1];
+        const Real dz = sources.z[i] - target[2];
+        const Real distSq = dx * dx + dy * dy + dz * dz + softeningSq;
+        const Real invDist = Real(1) / std::sqrt(distSq);
+        const Real scale = sources.mass[i] * invDist * invDist * invDist;
+        sum[0] += scale * dx;
+        sum[1] += scale * dy;
+        sum[2] += scale * dz;
+    }
+    out[0] += sum[0];
+    out[1] += sum[1];
+    out[2] += sum[2];
+}
+
+double Physics::LeafKernels::detail::radiationScalar(const Real target[3], const RadiationSources& sources, double projectedArea, double minDistSq) {
+    const double viewScale = projectedArea / (4.0 * std::numbers::pi);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < sources.count; ++i) {
+        const double dx = static_cast<double>(sources.x[i]) - static_cast<double>(target[0]);
+        const double dy = static_cast<double>(sources.y[i]) - static_cast<double>(target[1]);
+        const double dz = static_cast<double>(sources.z[i]) - static_cast<double>(target[2]);
+        const double distSq = std::max(dx * dx + dy * dy + dz * dz, minDistSq);
+        sum += sources.emission[i] * std::min(viewScale * sources.area[i] / distSq, projectedArea);
+    }
+    return sum;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "physics/Precision.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Batched pairwise kernels for the octree's leaf interactions
+ *
+ * Octree queries gather the bodies and nodes they interact with into flat
+ * structure-of-arrays batches and hand the whole batch to one kernel call, so
+ * the arithmetic runs over 8 or 16 sources per instruction instead of one
+ * pair at a time.
+ *
+ * Every kernel has a scalar version and, on x86-64 builds, AVX2 and AVX-512
+ * versions compiled in their own translation units. The best level the CPU
+ * supports is picked on first use. In single precision the vector gravity
+ * kernels take 1/sqrt from rsqrt refined by one Newton step (relative error
+ * around 1e-7, like the float sqrt and divide it replaces); double precision
+ * uses a full sqrt and divide. Lanes are summed in a fixed order, so results
+ * are the same on every run and worker count, but differ in the last bits
+ * between levels.
+ */
+namespace Physics::LeafKernels {
+    enum class Level : std::uint8_t {
+        Scalar,
+        Avx2,   // 8 floats or 4 doubles per instruction, with FMA
+        Avx512  // 16 floats or 8 doubles per instruction
+    };
+
+    struct GravitySources {
+        const Real* x = nullptr;
+        const Real* y = nullptr;
+        const Real* z = nullptr;
+        const Real* mass = nullptr;
+        std::size_t count = 0;
+    };
+
+    struct RadiationSources {
+        const Real* x = nullptr;
+        const Real* y = nullptr;
+        const Real* z = nullptr;
+        const double* area = nullptr;
+        const double* emission = nullptr; // effective emissivity * T^4
+        std::size_t count = 0;
+    };
+
+    /**
+     * @brief Adds sum(mass * d / (|d|^2 + softeningSq)^(3/2)) to out, d = source - target
+     *
+     * Multiply by G and the target's mass for the force. A source at the target contributes nothing.
+     */
+    void gravity(const Real target[3], const GravitySources& sources, Real softeningSq, Real out[3]);
+
+    /**
+     * @brief sum(emission * min(projectedArea * area / (4 pi d^2), projectedArea)), d^2 floored at minDistSq
+     *
+     * Multiply by the Stefan-Boltzmann constant and the target's absorptivity for the absorbed power.
+     */
+    double radiation(const Real target[3], const RadiationSources& sources, double projectedArea, double minDistSq);
+
+    Level detectedLevel(); // best level this build and CPU support
+    Level activeLevel();
+    void setLevel(Level level); // clamped to detectedLevel(), for benchmarks and tests comparing levels
+    const char* levelName(Level level);
+
+    // One definition per level, the vector ones only on x86-64 builds
+    namespace detail {
+        void gravityScalar(const Real target[3], const GravitySources& sources, Real softeningSq, Real out[3]);
+        double radiationScalar(const Real target[3], const RadiationSources& sources, double projectedArea, double minDistSq);
+        void gravityAvx2(const Real target[3], const GravitySources& sources, Real softeningSq, Real out[3]);
+        double radiationAvx2(const Real target[3], const RadiationSources& sources, double projectedArea, double minDistSq);
+        void gravityAvx512(const Real target[3], const GravitySources& sources, Real softeningSq, Real out[3]);
+        double radiationAvx512(const Real target[3], const RadiationSources& sources, double projectedArea, double minDistSq);
+    }
+}
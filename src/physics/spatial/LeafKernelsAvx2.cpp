@@ -0,0 +1,172 @@
+// Compiled with AVX2 and FMA enabled, only called once the CPU is known to support them.
+// Keep standard and glm calls out of this file: inline functions instantiated here could
+// be the copy the linker keeps for the whole program
+#include "LeafKernels.h"
+
+#include <immintrin.h>
+
+namespace {
+using Physics::Real;
+
+constexpr double kInvFourPi = 0.07957747154594767;
+
+// Sums lanes in a fixed order
+template <typename T, int N>
+T sumLanes(const T (&lanes)[N]) {
+    T sum = lanes[0];
+    for (int i = 1; i < N; ++i) sum += lanes[i];
+    return sum;
+}
+
+#ifdef PHYSICS_DOUBLE_PRECISION
+constexpr std::size_t kGravityLanes = 4;
+
+__m256i tailMask(std::size_t lanes) {
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(lanes)), _mm256_setr_epi64x(0, 1, 2, 3));
+}
+
+struct GravityAccumulator {
+    __m256d tx, ty, tz, eps;
+    __m256d ax = _mm256_setzero_pd();
+    __m256d ay = _mm256_setzero_pd();
+    __m256d az = _mm256_setzero_pd();
+
+    void add(__m256d x, __m256d y, __m256d z, __m256d m) {
+        const __m256d dx = _mm256_sub_pd(x, tx);
+        const __m256d dy = _mm256_sub_pd(y, ty);
+        const __m256d dz = _mm256_sub_pd(z, tz);
+        const __m256d distSq = _mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_fmadd_pd(dx, dx, eps)));
+        const __m256d dist = _mm256_sqrt_pd(distSq);
+        const __m256d scale = _mm256_div_pd(m, _mm256_mul_pd(distSq, dist));
+        ax = _mm256_fmadd_pd(scale, dx, ax);
+        ay = _mm256_fmadd_pd(scale, dy, ay);
+        az = _mm256_fmadd_pd(scale, dz, az);
+    }
+};
+#else
+constexpr std::size_t kGravityLanes = 8;
+
+__m256i tailMask(std::size_t lanes) {
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(lanes)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+struct GravityAccumulator {
+    __m256 tx, ty, tz, eps;
+    __m256 ax = _mm256_setzero_ps();
+    __m256 ay = _mm256_setzero_ps();
+    __m256 az = _mm256_setzero_ps();
+
+    void add(__m256 x, __m256 y, __m256 z, __m256 m) {
+        const __m256 dx = _mm256_sub_ps(x, tx);
+        const __m256 dy = _mm256_sub_ps(y, ty);
+        const __m256 dz = _mm256_sub_ps(z, tz);
+        const __m256 distSq = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_fmadd_ps(dx, dx, eps)));
+        // 12-bit estimate, one Newton step: y * (1.5 - 0.5 * x * y^2)
+        const __m256 estimate = _mm256_rsqrt_ps(distSq);
+        const __m256 halfDistSq = _mm256_mul_ps(distSq, _mm256_set1_ps(0.5f));
+        const __m256 invDist = _mm256_mul_ps(estimate,
+            _mm256_fnmadd_ps(halfDistSq, _mm256_mul_ps(estimate, estimate), _mm256_set1_ps(1.5f)));
+        const __m256 scale = _mm256_mul_ps(m, _mm256_mul_ps(invDist, _mm256_mul_ps(invDist, invDist)));
+        ax = _mm256_fmadd_ps(scale, dx, ax);
+        ay = _mm256_fmadd_ps(scale, dy, ay);
+        az = _mm256_fmadd_ps(scale, dz, az);
+    }
+};
+#endif
+
+// Four positions widened to double
+__m256d loadPosition(const Real* p) {
+#ifdef PHYSICS_DOUBLE_PRECISION
+    return _mm256_loadu_pd(p);
+#else
+    return _mm256_cvtps_pd(_mm_loadu_ps(p));
+#endif
+}
+
+__m256d loadPositionMasked(const Real* p, __m256i mask) {
+#ifdef PHYSICS_DOUBLE_PRECISION
+    return _mm256_maskload_pd(p, mask);
+#else
+    // The low half of each 64-bit lane mask is the 32-bit lane mask
+    const __m128i narrow = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(mask, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+    return _mm256_cvtps_pd(_mm_maskload_ps(p, narrow));
+#endif
+}
+}
+
+void Physics::LeafKernels::detail::gravityAvx2(const Real target[3], const GravitySources& sources, Real softeningSq, Real out[3]) {
+    GravityAccumulator acc;
+#ifdef PHYSICS_DOUBLE_PRECISION
+    acc.tx = _mm256_set1_pd(target[0]);
+    acc.ty = _mm256_set1_pd(target[1]);
+    acc.tz = _mm256_set1_pd(target[2]);
+    acc.eps = _mm256_set1_pd(softeningSq);
+    #define LOAD(p) _mm256_loadu_pd(p)
+    #define LOAD_MASKED(p, mask) _mm256_maskload_pd(p, mask)
+    #define STORE(p, v) _mm256_storeu_pd(p, v)
+#else
+    acc.tx = _mm256_set1_ps(target[0]);
+    acc.ty = _mm256_set1_ps(target[1]);
+    acc.tz = _mm256_set1_ps(target[2]);
+    acc.eps = _mm256_set1_ps(softeningSq);
+    #define LOAD(p) _mm256_loadu_ps(p)
+    #define LOAD_MASKED(p, mask) _mm256_maskload_ps(p, mask)
+    #define STORE(p, v) _mm256_storeu_ps(p, v)
+#endif
+
+    std::size_t i = 0;
+    for (; i + kGravityLanes <= sources.count; i += kGravityLanes) {
+        acc.add(LOAD(sources.x + i), LOAD(sources.y + i), LOAD(sources.z + i), LOAD(sources.mass + i));
+    }
+    if (i < sources.count) {
+        // Masked lanes load zero mass and add nothing
+        const __m256i mask = tailMask(sources.count - i);
+        acc.add(LOAD_MASKED(sources.x + i, mask), LOAD_MASKED(sources.y + i, mask),
+                LOAD_MASKED(sources.z + i, mask), LOAD_MASKED(sources.mass + i, mask));
+    }
+
+    Real lanes[3][kGravityLanes];
+    STORE(lanes[0], acc.ax);
+    STORE(lanes[1], acc.ay);
+    STORE(lanes[2], acc.az);
+    out[0] += sumLanes(lanes[0]);
+    out[1] += sumLanes(lanes[1]);
+    out[2] += sumLanes(lanes[2]);
+    #undef LOAD
+    #undef LOAD_MASKED
+    #undef STORE
+}
+
+double Physics::LeafKernels::detail::radiationAvx2(const Real target[3], const RadiationSources& sources, double projectedArea, double minDistSq) {
+    const __m256d tx = _mm256_set1_pd(static_cast<double>(target[0]));
+    const __m256d ty = _mm256_set1_pd(static_cast<double>(target[1]));
+    const __m256d tz = _mm256_set1_pd(static_cast<double>(target[2]));
+    const __m256d floor = _mm256_set1_pd(minDistSq);
+    const __m256d cap = _mm256_set1_pd(projectedArea);
+    const __m256d viewScale = _mm256_set1_pd(projectedArea * kInvFourPi);
+    __m256d sum = _mm256_setzero_pd();
+
+    auto add = [&](__m256d x, __m256d y, __m256d z, __m256d area, __m256d emission) {
+        const __m256d dx = _mm256_sub_pd(x, tx);
+        const __m256d dy = _mm256_sub_pd(y, ty);
+        const __m256d dz = _mm256_sub_pd(z, tz);
+        const __m256d distSq = _mm256_max_pd(_mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dx, dx))), floor);
+        const __m256d viewFactor = _mm256_min_pd(_mm256_div_pd(_mm256_mul_pd(viewScale, area), distSq), cap);
+        sum = _mm256_fmadd_pd(emission, viewFactor, sum);
+    };
+
+    std::size_t i = 0;
+    for (; i + 4 <= sources.count; i += 4) {
+        add(loadPosition(sources.x + i), loadPosition(sources.y + i), loadPosition(sources.z + i),
+            _mm256_loadu_pd(sources.area + i), _mm256_loadu_pd(sources.emission + i));
+    }
+    if (i < sources.count) {
+        const __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(sources.count - i)), _mm256_setr_epi64x(0, 1, 2, 3));
+        add(loadPositionMasked(sources.x + i, mask), loadPositionMasked(sources.y + i, mask), loadPositionMasked(sources.z + i, mask),
+            _mm256_maskload_pd(sources.area + i, mask), _mm256_maskload_pd(sources.emission + i, mask));
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum);
+    return sumLanes(lanes);
+}
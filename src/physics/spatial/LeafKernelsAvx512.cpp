@@ -0,0 +1,159 @@
+// Compiled with AVX-512F enabled, only called once the CPU is known to support it.
+// Keep standard and glm calls out of this file: inline functions instantiated here could
+// be the copy the linker keeps for the whole program
+#include "LeafKernels.h"
+
+// GCC 12's AVX-512 header warns about its own undefined-value helpers (GCC bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#else
+#include <immintrin.h>
+#endif
+
+namespace {
+using Physics::Real;
+
+constexpr double kInvFourPi = 0.07957747154594767;
+
+// Sums lanes in a fixed order
+template <typename T, int N>
+T sumLanes(const T (&lanes)[N]) {
+    T sum = lanes[0];
+    for (int i = 1; i < N; ++i) sum += lanes[i];
+    return sum;
+}
+
+#ifdef PHYSICS_DOUBLE_PRECISION
+constexpr std::size_t kGravityLanes = 8;
+
+struct GravityAccumulator {
+    __m512d tx, ty, tz, eps;
+    __m512d ax = _mm512_setzero_pd();
+    __m512d ay = _mm512_setzero_pd();
+    __m512d az = _mm512_setzero_pd();
+
+    void add(__m512d x, __m512d y, __m512d z, __m512d m) {
+        const __m512d dx = _mm512_sub_pd(x, tx);
+        const __m512d dy = _mm512_sub_pd(y, ty);
+        const __m512d dz = _mm512_sub_pd(z, tz);
+        const __m512d distSq = _mm512_fmadd_pd(dz, dz, _mm512_fmadd_pd(dy, dy, _mm512_fmadd_pd(dx, dx, eps)));
+        const __m512d dist = _mm512_sqrt_pd(distSq);
+        const __m512d scale = _mm512_div_pd(m, _mm512_mul_pd(distSq, dist));
+        ax = _mm512_fmadd_pd(scale, dx, ax);
+        ay = _mm512_fmadd_pd(scale, dy, ay);
+        az = _mm512_fmadd_pd(scale, dz, az);
+    }
+};
+#else
+constexpr std::size_t kGravityLanes = 16;
+
+struct GravityAccumulator {
+    __m512 tx, ty, tz, eps;
+    __m512 ax = _mm512_setzero_ps();
+    __m512 ay = _mm512_setzero_ps();
+    __m512 az = _mm512_setzero_ps();
+
+    void add(__m512 x, __m512 y, __m512 z, __m512 m) {
+        const __m512 dx = _mm512_sub_ps(x, tx);
+        const __m512 dy = _mm512_sub_ps(y, ty);
+        const __m512 dz = _mm512_sub_ps(z, tz);
+        const __m512 distSq = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_fmadd_ps(dx, dx, eps)));
+        // 14-bit estimate, one Newton step: y * (1.5 - 0.5 * x * y^2)
+        const __m512 estimate = _mm512_rsqrt14_ps(distSq);
+        const __m512 halfDistSq = _mm512_mul_ps(distSq, _mm512_set1_ps(0.5f));
+        const __m512 invDist = _mm512_mul_ps(estimate,
+            _mm512_fnmadd_ps(halfDistSq, _mm512_mul_ps(estimate, estimate), _mm512_set1_ps(1.5f)));
+        const __m512 scale = _mm512_mul_ps(m, _mm512_mul_ps(invDist, _mm512_mul_ps(invDist, invDist)));
+        ax = _mm512_fmadd_ps(scale, dx, ax);
+        ay = _mm512_fmadd_ps(scale, dy, ay);
+        az = _mm512_fmadd_ps(scale, dz, az);
+    }
+};
+#endif
+
+// Eight positions widened to double, lanes outside mask are zero
+__m512d loadPosition(const Real* p, __mmask8 mask) {
+#ifdef PHYSICS_DOUBLE_PRECISION
+    return _mm512_maskz_loadu_pd(mask, p);
+#else
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(static_cast<__mmask16>(mask), p)));
+#endif
+}
+}
+
+void Physics::LeafKernels::detail::gravityAvx512(const Real target[3], const GravitySources& sources, Real softeningSq, Real out[3]) {
+    GravityAccumulator acc;
+#ifdef PHYSICS_DOUBLE_PRECISION
+    using Mask = __mmask8;
+    acc.tx = _mm512_set1_pd(target[0]);
+    acc.ty = _mm512_set1_pd(target[1]);
+    acc.tz = _mm512_set1_pd(target[2]);
+    acc.eps = _mm512_set1_pd(softeningSq);
+    #define LOAD(p) _mm512_loadu_pd(p)
+    #define LOAD_MASKED(p, mask) _mm512_maskz_loadu_pd(mask, p)
+    #define STORE(p, v) _mm512_storeu_pd(p, v)
+#else
+    using Mask = __mmask16;
+    acc.tx = _mm512_set1_ps(target[0]);
+    acc.ty = _mm512_set1_ps(target[1]);
+    acc.tz = _mm512_set1_ps(target[2]);
+    acc.eps = _mm512_set1_ps(softeningSq);
+    #define LOAD(p) _mm512_loadu_ps(p)
+    #define LOAD_MASKED(p, mask) _mm512_maskz_loadu_ps(mask, p)
+    #define STORE(p, v) _mm512_storeu_ps(p, v)
+#endif
+
+    std::size_t i = 0;
+    for (; i + kGravityLanes <= sources.count; i += kGravityLanes) {
+        acc.add(LOAD(sources.x + i), LOAD(sources.y + i), LOAD(sources.z + i), LOAD(sources.mass + i));
+    }
+    if (i < sources.count) {
+        // Masked lanes load zero mass and add nothing
+        const Mask mask = static_cast<Mask>((1u << (sources.count - i)) - 1u);
+        acc.add(LOAD_MASKED(sources.x + i, mask), LOAD_MASKED(sources.y + i, mask),
+                LOAD_MASKED(sources.z + i, mask), LOAD_MASKED(sources.mass + i, mask));
+    }
+
+    Real lanes[3][kGravityLanes];
+    STORE(lanes[0], acc.ax);
+    STORE(lanes[1], acc.ay);
+    STORE(lanes[2], acc.az);
+    out[0] += sumLanes(lanes[0]);
+    out[1] += sumLanes(lanes[1]);
+    out[2] += sumLanes(lanes[2]);
+    #undef LOAD
+    #undef LOAD_MASKED
+    #undef STORE
+}
+
+double Physics::LeafKernels::detail::radiationAvx512(const Real target[3], const RadiationSources& sources, double projectedArea, double minDistSq) {
+    const __m512d tx = _mm512_set1_pd(static_cast<double>(target[0]));
+    const __m512d ty = _mm512_set1_pd(static_cast<double>(target[1]));
+    const __m512d tz = _mm512_set1_pd(static_cast<double>(target[2]));
+    const __m512d floor = _mm512_set1_pd(minDistSq);
+    const __m512d cap = _mm512_set1_pd(projectedArea);
+    const __m512d viewScale = _mm512_set1_pd(projectedArea * kInvFourPi);
+    __m512d sum = _mm512_setzero_pd();
+
+    auto add = [&](__mmask8 mask, std::size_t i) {
+        const __m512d dx = _mm512_sub_pd(loadPosition(sources.x + i, mask), tx);
+        const __m512d dy = _mm512_sub_pd(loadPosition(sources.y + i, mask), ty);
+        const __m512d dz = _mm512_sub_pd(loadPosition(sources.z + i, mask), tz);
+        const __m512d area = _mm512_maskz_loadu_pd(mask, sources.area + i);
+        const __m512d emission = _mm512_maskz_loadu_pd(mask, sources.emission + i);
+        const __m512d distSq = _mm512_max_pd(_mm512_fmadd_pd(dz, dz, _mm512_fmadd_pd(dy, dy, _mm512_mul_pd(dx, dx))), floor);
+        const __m512d viewFactor = _mm512_min_pd(_mm512_div_pd(_mm512_mul_pd(viewScale, area), distSq), cap);
+        sum = _mm512_fmadd_pd(emission, viewFactor, sum);
+    };
+
+    std::size_t i = 0;
+    for (; i + 8 <= sources.count; i += 8) add(static_cast<__mmask8>(0xff), i);
+    if (i < sources.count) add(static_cast<__mmask8>((1u << (sources.count - i)) - 1u), i);
+
+    double lanes[8];
+    _mm512_storeu_pd(lanes, sum);
+    return sumLanes(lanes);
+}
@@ -1,135 +1,455 @@
 #include "Octree.h"
+#include "LeafKernels.h"
 #include "physics/Constants.h"
 #include "physics/PhysicsSystem.h"
 #include "physics/utils/ThermalUtils.h"
+#include "physics/utils/ThreadPool.h"
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <glm/gtx/component_wise.hpp>
 #include <cstdint>
 
 namespace {
-constexpr float kMinNodeHalfSize = 0.001f;
+using Physics::Real;
+using Physics::Vec3;
+
+constexpr Real kMinNodeHalfSize = Real(0.001);
 constexpr std::size_t kTraversalStackReserve = 512;
 constexpr double kMinRadiationDistanceSq = 0.0001;
 
-bool containsPosition(const OctreeNode& node, const glm::vec3& position) {
-    const glm::vec3 delta = glm::abs(position - node.center);
+constexpr int kMortonBits = 21; // per axis, 63 bits in all
+constexpr double kMortonCells = static_cast<double>(1u << kMortonBits);
+constexpr int kRadixBits = 8;
+constexpr std::size_t kSortBlock = 16384;  // keys per radix sort block, fixed so the passes do not depend on the pool
+constexpr std::size_t kGatherGrain = 1024;
+constexpr std::size_t kAggregateGrain = 256;
+constexpr int kSubtreeLevel = 2;           // nodes at this level are roots of separately built subtrees
+constexpr std::size_t kSubtreeMinBodies = 4096;
+constexpr std::size_t kParallelMinBodies = 4096; // below this the pool costs more than the build
+constexpr std::size_t kRadixMinKeys = 512;       // below this a comparison sort wins
+
+// Interaction lists of one query, per thread since queries run side by side on pool workers
+struct QueryScratch {
+    std::vector<NodeIndex> stack;
+    std::vector<Real> x, y, z, mass;
+    std::vector<double> area, emission;
+
+    void reset() {
+        stack.clear();
+        stack.reserve(kTraversalStackReserve);
+        x.clear();
+        y.clear();
+        z.clear();
+        mass.clear();
+        area.clear();
+        emission.clear();
+    }
+
+    void addSource(const Vec3& position) {
+        x.push_back(position.x);
+        y.push_back(position.y);
+        z.push_back(position.z);
+    }
+};
+thread_local QueryScratch queryScratch;
+
+Vec3 positionOf(const Physics::PhysicsBody* body) {
+    return Vec3(body->getPositionPrecise(BodyLock::NOLOCK));
+}
+
+bool containsPosition(const OctreeNode& node, const Vec3& position) {
+    const Vec3 delta = glm::abs(position - node.center);
     return delta.x <= node.halfSize && delta.y <= node.halfSize && delta.z <= node.halfSize;
 }
+
+// Adds weight * v v^T to a symmetric tensor stored as xx, xy, xz, yy, yz, zz
+void addOuterProduct(std::array<double, 6>& tensor, double weight, const glm::dvec3& v) {
+    tensor[0] += weight * v.x * v.x;
+    tensor[1] += weight * v.x * v.y;
+    tensor[2] += weight * v.x * v.z;
+    tensor[3] += weight * v.y * v.y;
+    tensor[4] += weight * v.y * v.z;
+    tensor[5] += weight * v.z * v.z;
 }
 
-void Octree::clear() {
-    nodes.clear();
+template <typename Fn>
+void forRange(Physics::ThreadPool* pool, std::size_t count, std::size_t grain, Fn&& fn) {
+    if (pool) {
+        pool->parallelFor(count, grain, fn);
+    } else if (count > 0) {
+        fn(std::size_t{0}, count);
+    }
 }
 
-Octant Octree::getOctant(NodeIndex nodeIdx, const glm::vec3& pos) const {
-    const glm::vec3& center = nodes[nodeIdx.val].center;
+// Spaces the low 21 bits of v three bits apart
+std::uint64_t spreadBits(std::uint32_t v) {
+    std::uint64_t x = v & 0x1fffffu;
+    x = (x | x << 32) & 0x1f00000000ffffull;
+    x = (x | x << 16) & 0x1f0000ff0000ffull;
+    x = (x | x << 8) & 0x100f00f00f00f00full;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+    x = (x | x << 2) & 0x1249249249249249ull;
+    return x;
+}
+
+std::uint32_t quantise(double offset, double scale) {
+    const double cell = offset * scale;
+    if (!(cell > 0.0)) return 0;
+    return static_cast<std::uint32_t>(std::min(cell, kMortonCells - 1.0));
+}
 
-    return Octant{static_cast<std::uint8_t>(
+std::uint8_t octantOf(const Vec3& pos, const Vec3& center) {
+    return static_cast<std::uint8_t>(
         (pos.x >= center.x ? Octant::X_MASK : 0) |
         (pos.y >= center.y ? Octant::Y_MASK : 0) |
         (pos.z >= center.z ? Octant::Z_MASK : 0)
-    )};
+    );
 }
 
-NodeIndex Octree::allocateNode(const glm::vec3& center, float halfSize) {
-    nodes.push_back({center, halfSize});
-    return NodeIndex{static_cast<int>(nodes.size() - 1)};
+// Cuts nodes out of a Morton-sorted range, children right after their parent
+template <typename Subtree>
+struct RangeBuilder {
+    const std::vector<std::uint64_t>& keys;
+    std::vector<std::uint32_t>& order;      // sorted body indices, refined in place below the key resolution
+    std::vector<std::uint32_t>& scratch;    // same size as order, for that refinement
+    const std::vector<OctreeBody>& bodies;  // input order
+    std::vector<OctreeNode>& out;
+    std::vector<Subtree>* deferred;         // collects the subtree roots at kSubtreeLevel, null inside a subtree
+
+    const Vec3& positionAt(std::uint32_t k) const { return bodies[order[k]].position; }
+
+    bool coincident(std::uint32_t begin, std::uint32_t end) const {
+        const Vec3& first = positionAt(begin);
+        for (std::uint32_t k = begin + 1; k < end; ++k) {
+            if (positionAt(k) != first) return false;
+        }
+        return true;
+    }
+
+    int build(std::uint32_t begin, std::uint32_t end, int level, const Vec3& center, Real halfSize) {
+        const int index = static_cast<int>(out.size());
+        OctreeNode& node = out.emplace_back();
+        node.center = center;
+        node.halfSize = halfSize;
+        node.firstBody = begin;
+        node.bodyCount = end - begin;
+
+        const Real childHalfSize = halfSize * Real(0.5);
+        if (end - begin == 1 || childHalfSize <= kMinNodeHalfSize || coincident(begin, end)) return index;
+
+        auto addChild = [&](std::uint8_t octant, std::uint32_t childBegin, std::uint32_t childEnd) {
+            const Vec3 childCenter = center + childHalfSize * Vec3(
+                (octant & Octant::X_MASK) ? 1 : -1,
+                (octant & Octant::Y_MASK) ? 1 : -1,
+                (octant & Octant::Z_MASK) ? 1 : -1
+            );
+            out[index].childMask |= static_cast<std::uint8_t>(1u << octant);
+            if (deferred && level + 1 == kSubtreeLevel) {
+                deferred->push_back({ index, octant, childBegin, childEnd, childCenter, childHalfSize });
+                return;
+            }
+            const int child = build(childBegin, childEnd, level + 1, childCenter, childHalfSize);
+            out[index].children[octant] = NodeIndex{child}; // out may have grown, index again
+        };
+
+        if (level < kMortonBits) {
+            // Keys sharing this node's prefix are ordered by their next octant digit
+            const int shift = 3 * (kMortonBits - 1 - level);
+            auto digit = [shift](std::uint64_t key) { return static_cast<std::uint8_t>((key >> shift) & 7u); };
+            std::uint32_t childBegin = begin;
+            while (childBegin < end) {
+                const std::uint8_t octant = digit(keys[childBegin]);
+                const auto last = std::partition_point(keys.begin() + childBegin, keys.begin() + end,
+                    [&](std::uint64_t key) { return digit(key) <= octant; });
+                const auto childEnd = static_cast<std::uint32_t>(last - keys.begin());
+                addChild(octant, childBegin, childEnd);
+                childBegin = childEnd;
+            }
+            return index;
+        }
+
+        // Past the key resolution every key in the range is equal, split on the exact centre
+        // with a counting sort by octant, stable and without allocating
+        std::array<std::uint32_t, 9> starts{};
+        for (std::uint32_t k = begin; k < end; ++k) ++starts[octantOf(positionAt(k), center) + 1];
+        for (std::size_t octant = 0; octant < 8; ++octant) starts[octant + 1] += starts[octant];
+        std::array<std::uint32_t, 8> cursor;
+        std::copy(starts.begin(), starts.begin() + 8, cursor.begin());
+        for (std::uint32_t k = begin; k < end; ++k) scratch[begin + cursor[octantOf(positionAt(k), center)]++] = order[k];
+        std::copy(scratch.begin() + begin, scratch.begin() + end, order.begin() + begin);
+
+        for (std::uint8_t octant = 0; octant < 8; ++octant) {
+            if (starts[octant] != starts[octant + 1]) addChild(octant, begin + starts[octant], begin + starts[octant + 1]);
+        }
+        return index;
+    }
+};
 }
 
-void Octree::insert(NodeIndex nodeIndex, Physics::PhysicsBody* body) {
-    OctreeNode* node        = &nodes[nodeIndex.val];
-    glm::vec3 nodeCenter    = node->center;
-    glm::vec3 bodyPos       = body->getPosition(BodyLock::NOLOCK);
-    double bodyMass          = body->getMass(BodyLock::NOLOCK);
-    float childHalfSize     = node->halfSize * 0.5f;
+void Octree::clear() {
+    nodes.clear();
+    packed.clear();
+}
 
-    ThermalProperties props = body->getThermalProperties(BodyLock::NOLOCK);
-    double area = body->getSurfaceArea();
-    double epsArea = Physics::Thermal::effectiveEmissivity(props, props.tempK) * area;
-    double emission = epsArea * Physics::Thermal::fourthPower(Physics::Thermal::clampTemperature(props.tempK));
-
-    // Node is empty, put the body here
-    if (node->bodies.empty() && node->totalMass == 0.0) {
-        node->bodies.push_back(body);
-        node->massCenter = bodyPos;
-        node->totalMass  = bodyMass;
-        node->totalEffectiveArea = epsArea;
-        node->totalEmission = emission;
+void Octree::sortByKey(Physics::ThreadPool* pool) {
+    // LSD radix sort of (key, body) pairs. Each block counts its digits, then
+    // scatters in its own order after all earlier blocks, so the sort is stable
+    // and the same for any pool.
+    static_assert((std::size_t{1} << kRadixBits) == kRadixBuckets);
+    const std::size_t count = keys.size();
+    if (count < kRadixMinKeys) {
+        // order is still the identity, so ties fall back to the body index as in the radix sort
+        std::sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+            return keys[a] != keys[b] ? keys[a] < keys[b] : a < b;
+        });
+        keyScratch.resize(count);
+        for (std::size_t k = 0; k < count; ++k) keyScratch[k] = keys[order[k]];
+        keys.swap(keyScratch);
         return;
     }
 
-    // Since this node now contains this body, update
-    double newMass       = node->totalMass + bodyMass;
-    node->massCenter += (bodyPos - node->massCenter) * static_cast<float>(bodyMass / newMass);
-    node->totalMass     = newMass;
-    node->totalEffectiveArea += epsArea;
-    node->totalEmission += emission;
-
-    auto insertBody = [&](Physics::PhysicsBody* b) {
-        glm::vec3 bPos = b->getPosition(BodyLock::NOLOCK);
-        Octant bOct = Octree::getOctant(nodeIndex, bPos);
-
-        // Could change due to vector resize during recursion
-        node = &nodes[nodeIndex.val];
-        if (node->children[bOct.val].isEmpty()) {
-            glm::vec3 childCenter = nodeCenter + childHalfSize * glm::vec3(
-                (bOct.val & Octant::X_MASK) ? 1.0f : -1.0f,
-                (bOct.val & Octant::Y_MASK) ? 1.0f : -1.0f,
-                (bOct.val & Octant::Z_MASK) ? 1.0f : -1.0f
-            );
-            NodeIndex childNode = allocateNode(childCenter, childHalfSize);
-            node = &nodes[nodeIndex.val]; // Refresh reference after potential vector resize
-            node->children[bOct.val] = childNode;
-            node->childMask |= (1 << bOct.val);
-        }
-        insert(node->children[bOct.val], b);
-    };
-
-    if (node->isLeaf() && !node->bodies.empty()) {
-        const bool hasCoincidentBody = std::any_of(node->bodies.begin(), node->bodies.end(),
-            [&](Physics::PhysicsBody* existing) {
-                return existing->getPosition(BodyLock::NOLOCK) == bodyPos;
-            });
-
-        if (childHalfSize <= kMinNodeHalfSize || hasCoincidentBody) {
-            node->bodies.push_back(body);
-            return;
+    const std::size_t blocks = (count + kSortBlock - 1) / kSortBlock;
+    keyScratch.resize(count);
+    orderScratch.resize(count);
+    radixCounts.resize(blocks);
+
+    for (int shift = 0; shift < 64; shift += kRadixBits) {
+        forRange(pool, blocks, 1, [&](std::size_t firstBlock, std::size_t lastBlock) {
+            for (std::size_t block = firstBlock; block < lastBlock; ++block) {
+                std::array<std::uint32_t, kRadixBuckets>& counts = radixCounts[block];
+                counts.fill(0);
+                const std::size_t end = std::min(count, (block + 1) * kSortBlock);
+                for (std::size_t i = block * kSortBlock; i < end; ++i) ++counts[(keys[i] >> shift) & (kRadixBuckets - 1)];
+            }
+        });
+
+        // A digit every key shares leaves the order as it is
+        std::uint32_t running = 0;
+        bool trivial = false;
+        for (std::size_t digit = 0; digit < kRadixBuckets; ++digit) {
+            std::uint32_t digitTotal = 0;
+            for (std::size_t block = 0; block < blocks; ++block) {
+                const std::uint32_t blockCount = radixCounts[block][digit];
+                radixCounts[block][digit] = running + digitTotal;
+                digitTotal += blockCount;
+            }
+            trivial = trivial || digitTotal == count;
+            running += digitTotal;
         }
+        if (trivial) continue;
+
+        forRange(pool, blocks, 1, [&](std::size_t firstBlock, std::size_t lastBlock) {
+            for (std::size_t block = firstBlock; block < lastBlock; ++block) {
+                std::array<std::uint32_t, kRadixBuckets>& offsets = radixCounts[block];
+                const std::size_t end = std::min(count, (block + 1) * kSortBlock);
+                for (std::size_t i = block * kSortBlock; i < end; ++i) {
+                    const std::uint32_t dst = offsets[(keys[i] >> shift) & (kRadixBuckets - 1)]++;
+                    keyScratch[dst] = keys[i];
+                    orderScratch[dst] = order[i];
+                }
+            }
+        });
+        keys.swap(keyScratch);
+        order.swap(orderScratch);
+    }
+}
 
-        std::vector<Physics::PhysicsBody*> existingBodies = std::move(node->bodies);
-        node->bodies.clear();
-        for (Physics::PhysicsBody* existing : existingBodies) {
-            insertBody(existing);
+void Octree::aggregate(Physics::ThreadPool* pool) {
+    massMoments.resize(nodes.size());
+
+    // Leaves sum their own bodies, each touching only its own range
+    forRange(pool, nodes.size(), kAggregateGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t n = begin; n < end; ++n) {
+            OctreeNode& node = nodes[n];
+            if (!node.isLeaf()) continue;
+
+            // Offsets from the first body keep a lone or coincident body's centre exact
+            const Vec3& first = packed[node.firstBody].position;
+            const glm::dvec3 origin(first);
+            glm::dvec3 offsetMoment(0.0);
+            std::array<double, 6> offsetQuadrupole{};
+            double mass = 0.0;
+            double effectiveArea = 0.0;
+            double emission = 0.0;
+            for (std::uint32_t k = node.firstBody; k < node.firstBody + node.bodyCount; ++k) {
+                const OctreeBody& body = packed[k];
+                const double epsArea = body.emissivity * body.area;
+                const glm::dvec3 u = glm::dvec3(body.position) - origin;
+                mass += body.mass;
+                offsetMoment += body.mass * u;
+                if (useQuadrupoles) addOuterProduct(offsetQuadrupole, body.mass, u);
+                effectiveArea += epsArea;
+                emission += epsArea * body.tempPow4;
+            }
+            const glm::dvec3 offset = mass > 0.0 ? offsetMoment / mass : glm::dvec3(0.0);
+            if (useQuadrupoles) {
+                // Parallel axis theorem, from the first body to the mass centre
+                addOuterProduct(offsetQuadrupole, -mass, offset);
+                node.quadrupole = offsetQuadrupole;
+            }
+            node.massCenter = first + Vec3(offset);
+            node.totalMass = mass;
+            node.totalEffectiveArea = effectiveArea;
+            node.totalEmission = emission;
+            massMoments[n] = mass * (origin + offset);
+        }
+    });
+
+    // Children always come after their parent, so a reverse sweep finds them summed
+    for (std::size_t n = nodes.size(); n-- > 0;) {
+        OctreeNode& node = nodes[n];
+        if (node.isLeaf()) continue;
+
+        glm::dvec3 moment(0.0);
+        double mass = 0.0;
+        double effectiveArea = 0.0;
+        double emission = 0.0;
+        std::uint8_t childMask = node.childMask;
+        while (childMask) {
+            const OctreeNode& child = nodes[node.children[std::countr_zero(childMask)].val];
+            moment += massMoments[node.children[std::countr_zero(childMask)].val];
+            mass += child.totalMass;
+            effectiveArea += child.totalEffectiveArea;
+            emission += child.totalEmission;
+            childMask &= (childMask - 1);
+        }
+        node.massCenter = mass > 0.0 ? Vec3(moment / mass) : node.center;
+        node.totalMass = mass;
+        node.totalEffectiveArea = effectiveArea;
+        node.totalEmission = emission;
+        massMoments[n] = moment;
+
+        if (useQuadrupoles && mass > 0.0) {
+            const glm::dvec3 center = moment / mass;
+            std::array<double, 6> quadrupole{};
+            childMask = node.childMask;
+            while (childMask) {
+                const int c = node.children[std::countr_zero(childMask)].val;
+                const OctreeNode& child = nodes[c];
+                if (child.totalMass > 0.0) {
+                    for (std::size_t e = 0; e < quadrupole.size(); ++e) quadrupole[e] += child.quadrupole[e];
+                    addOuterProduct(quadrupole, child.totalMass, massMoments[c] / child.totalMass - center);
+                }
+                childMask &= (childMask - 1);
+            }
+            node.quadrupole = quadrupole;
         }
-        insertBody(body);
-        return;
     }
-    insertBody(body);
 }
 
-void Octree::build(const std::vector<Physics::PhysicsBody*>& bodies) {
+void Octree::build(const std::vector<Physics::PhysicsBody*>& bodies, Physics::ThreadPool* pool) {
     Octree::clear();
     if (bodies.empty()) return;
-    nodes.reserve(bodies.size() * 2);
+    const std::size_t count = bodies.size();
+    if (count < kParallelMinBodies) pool = nullptr;
+
+    // One pass of virtual getters per body, the rest of the build and every query work on these
+    gathered.resize(count);
+    forRange(pool, count, kGatherGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const Physics::PhysicsBody* body = bodies[i];
+            const ThermalProperties props = body->getThermalProperties(BodyLock::NOLOCK);
+            OctreeBody& out = gathered[i];
+            out.position = positionOf(body);
+            out.mass = body->getMass(BodyLock::NOLOCK);
+            out.area = body->getSurfaceArea();
+            out.emissivity = Physics::Thermal::effectiveEmissivity(props, props.tempK);
+            out.tempPow4 = Physics::Thermal::fourthPower(Physics::Thermal::clampTemperature(props.tempK));
+            out.body = body;
+        }
+    });
 
     // Find the center
-    glm::vec3 min = bodies[0]->getPosition(BodyLock::NOLOCK);
-    glm::vec3 max = bodies[0]->getPosition(BodyLock::NOLOCK);
-    for (const auto& body : bodies) {
-        glm::vec3 pos = body->getPosition(BodyLock::NOLOCK);
-        min = glm::min(min, pos);
-        max = glm::max(max, pos);
+    Vec3 min = gathered[0].position;
+    Vec3 max = gathered[0].position;
+    for (const OctreeBody& body : gathered) {
+        min = glm::min(min, body.position);
+        max = glm::max(max, body.position);
     }
 
-    glm::vec3 center = (min + max) * 0.5f;
-    float halfSize = glm::compMax(max - center) + 1.0f; // Avoid points right on the edge
+    Vec3 center = (min + max) * Real(0.5);
+    Real halfSize = glm::compMax(max - center) + Real(1); // Avoid points right on the edge
+
+    const glm::dvec3 origin = glm::dvec3(center) - glm::dvec3(static_cast<double>(halfSize));
+    const double scale = kMortonCells / (2.0 * static_cast<double>(halfSize));
+    keys.resize(count);
+    order.resize(count);
+    forRange(pool, count, kGatherGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const glm::dvec3 offset = glm::dvec3(gathered[i].position) - origin;
+            keys[i] = spreadBits(quantise(offset.x, scale))
+                | spreadBits(quantise(offset.y, scale)) << 1
+                | spreadBits(quantise(offset.z, scale)) << 2;
+            order[i] = static_cast<std::uint32_t>(i);
+        }
+    });
+    sortByKey(pool);
+
+    // Top levels first, then the subtrees below them side by side. Large trees
+    // always take this path, so the node layout does not depend on the pool
+    nodes.reserve(count * 2);
+    orderScratch.resize(count);
+    subtrees.clear();
+    RangeBuilder<Subtree> top{ keys, order, orderScratch, gathered, nodes, count >= kSubtreeMinBodies ? &subtrees : nullptr };
+    top.build(0, static_cast<std::uint32_t>(count), 0, center, halfSize);
+
+    if (subtreeNodes.size() < subtrees.size()) subtreeNodes.resize(subtrees.size());
+    forRange(pool, subtrees.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t) {
+            const Subtree& task = subtrees[t];
+            std::vector<OctreeNode>& local = subtreeNodes[t];
+            local.clear();
+            local.reserve(2 * (task.end - task.begin));
+            RangeBuilder<Subtree> builder{ keys, order, orderScratch, gathered, local, nullptr };
+            builder.build(task.begin, task.end, kSubtreeLevel, task.center, task.halfSize);
+        }
+    });
+    for (std::size_t t = 0; t < subtrees.size(); ++t) {
+        const int offset = static_cast<int>(nodes.size());
+        for (OctreeNode& node : subtreeNodes[t]) {
+            for (NodeIndex& child : node.children) {
+                if (!child.isEmpty()) child.val += offset;
+            }
+        }
+        nodes.insert(nodes.end(), subtreeNodes[t].begin(), subtreeNodes[t].end());
+        nodes[subtrees[t].parent].children[subtrees[t].octant] = NodeIndex{offset};
+    }
 
-    // Add root node
-    NodeIndex root = allocateNode(center, halfSize);
+    packed.resize(count);
+    forRange(pool, count, kGatherGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) packed[k] = gathered[order[k]];
+    });
+    aggregate(pool);
+}
 
-    for (const auto& body : bodies) {
-        insert(root, body);
+void Octree::refit(Physics::ThreadPool* pool) {
+    if (nodes.empty()) return;
+    if (packed.size() < kParallelMinBodies) pool = nullptr;
+
+    forRange(pool, packed.size(), kGatherGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) packed[k].position = positionOf(packed[k].body);
+    });
+    aggregate(pool);
+
+    // Grow each cube about its centre until it holds its bodies again, children before parents
+    forRange(pool, nodes.size(), kAggregateGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t n = begin; n < end; ++n) {
+            OctreeNode& node = nodes[n];
+            if (!node.isLeaf()) continue;
+            for (std::uint32_t k = node.firstBody; k < node.firstBody + node.bodyCount; ++k) {
+                node.halfSize = std::max(node.halfSize, glm::compMax(glm::abs(packed[k].position - node.center)));
+            }
+        }
+    });
+    for (std::size_t n = nodes.size(); n-- > 0;) {
+        OctreeNode& node = nodes[n];
+        std::uint8_t childMask = node.childMask;
+        while (childMask) {
+            const OctreeNode& child = nodes[node.children[std::countr_zero(childMask)].val];
+            node.halfSize = std::max(node.halfSize, glm::compMax(glm::abs(child.center - node.center)) + child.halfSize);
+            childMask &= (childMask - 1);
+        }
     }
 }
 
@@ -138,12 +458,14 @@ glm::vec3 Octree::computeForce(Physics::PhysicsBody* body, double G) {
         return glm::vec3(0.0f);
     }
 
-    glm::vec3 totalForce(0.0f);
-    glm::vec3 bodyPos   = body->getPosition(BodyLock::NOLOCK);
+    Vec3 totalForce(0);
+    Vec3 bodyPos        = positionOf(body);
     double bodyMass      = body->getMass(BodyLock::NOLOCK);
 
-    std::vector<NodeIndex> stack;
-    stack.reserve(kTraversalStackReserve);
+    // Bodies of reached leaves and monopoles of accepted nodes are gathered, then summed in one kernel call
+    QueryScratch& scratch = queryScratch;
+    scratch.reset();
+    std::vector<NodeIndex>& stack = scratch.stack;
     stack.push_back(NodeIndex::rootIndex());
 
     while (!stack.empty()) {
@@ -154,31 +476,37 @@ glm::vec3 Octree::computeForce(Physics::PhysicsBody* body, double G) {
         // Empty region
         if (node.totalMass == 0.0) continue;
 
-        glm::vec3 dist = node.massCenter - body->getPosition(BodyLock::NOLOCK);
-        float distSq = glm::dot(dist, dist);
-        float softeningDistSq = distSq + Constants::SOFTENING_SQ;
-        float widthSq = node.halfSize * node.halfSize * 4.0f;
+        Vec3 dist = node.massCenter - bodyPos;
+        Real distSq = glm::dot(dist, dist);
+        Real widthSq = node.halfSize * node.halfSize * Real(4);
         const bool nodeContainsBody = containsPosition(node, bodyPos);
 
-        if (node.isLeaf() || (!nodeContainsBody && widthSq < Constants::THETA_SQ * distSq)) {
-            if (node.isLeaf() && !node.bodies.empty()) {
-                for (Physics::PhysicsBody* other : node.bodies) {
-                    if (other == body) continue;
-                    glm::vec3 pairDist = other->getPosition(BodyLock::NOLOCK) - bodyPos;
-                    float pairDistSq = glm::dot(pairDist, pairDist) + Constants::SOFTENING_SQ;
-                    float invPairDist = 1.0f / std::sqrt(pairDistSq);
-                    float invPairDist3 = invPairDist * invPairDist * invPairDist;
-                    double pairForce = (G * bodyMass * other->getMass(BodyLock::NOLOCK)) * invPairDist3;
-                    totalForce += static_cast<float>(pairForce) * pairDist;
+        if (node.isLeaf() || (!nodeContainsBody && widthSq < thetaSq * distSq)) {
+            if (node.isLeaf() && node.bodyCount > 0) {
+                for (std::uint32_t k = node.firstBody; k < node.firstBody + node.bodyCount; ++k) {
+                    const OctreeBody& other = packed[k];
+                    if (other.body == body) continue;
+                    scratch.addSource(other.position);
+                    scratch.mass.push_back(static_cast<Real>(other.mass));
                 }
                 continue;
             }
 
-            float invDist = 1.0f / sqrt(softeningDistSq);
-            float invDist3 = invDist * invDist * invDist;
-
-            double force = (G * bodyMass * node.totalMass) * invDist3;
-            totalForce += static_cast<float>(force) * dist;
+            scratch.addSource(node.massCenter);
+            scratch.mass.push_back(static_cast<Real>(node.totalMass));
+
+            if (useQuadrupoles) {
+                // Next term of the softened kernel's expansion about the mass centre
+                const std::array<double, 6>& q = node.quadrupole;
+                const glm::dvec3 d(dist);
+                const glm::dvec3 qd(q[0] * d.x + q[1] * d.y + q[2] * d.z,
+                                    q[1] * d.x + q[3] * d.y + q[4] * d.z,
+                                    q[2] * d.x + q[4] * d.y + q[5] * d.z);
+                const double invDistSq = 1.0 / (static_cast<double>(distSq) + Constants::SOFTENING_SQ);
+                const double invDist5 = invDistSq * invDistSq * std::sqrt(invDistSq);
+                const double radial = 7.5 * glm::dot(d, qd) * invDistSq - 1.5 * (q[0] + q[3] + q[5]);
+                totalForce += Vec3((G * bodyMass * invDist5) * (radial * d - 3.0 * qd));
+            }
         } else {
             // Add valid children to stack
             std::uint8_t childMask = node.childMask;
@@ -189,7 +517,14 @@ glm::vec3 Octree::computeForce(Physics::PhysicsBody* body, double G) {
             }
         }
     }
-    return totalForce;
+
+    const Real target[3] = { bodyPos.x, bodyPos.y, bodyPos.z };
+    Real field[3] = { Real(0), Real(0), Real(0) };
+    const Physics::LeafKernels::GravitySources sources{
+        scratch.x.data(), scratch.y.data(), scratch.z.data(), scratch.mass.data(), scratch.mass.size() };
+    Physics::LeafKernels::gravity(target, sources, static_cast<Real>(Constants::SOFTENING_SQ), field);
+    totalForce += static_cast<Real>(G * bodyMass) * Vec3(field[0], field[1], field[2]);
+    return glm::vec3(totalForce);
 }
 
 double Octree::computeHeat(Physics::PhysicsBody* body) {
@@ -198,14 +533,16 @@ double Octree::computeHeat(Physics::PhysicsBody* body) {
     }
 
     double totalHeat = 0.0;
-    glm::vec3 bodyPos = body->getPosition(BodyLock::NOLOCK);
+    Vec3 bodyPos = positionOf(body);
     ThermalProperties props = body->getThermalProperties(BodyLock::NOLOCK);
     const double absorptivity = Physics::Thermal::effectiveAbsorptivity(props, props.tempK);
     double area = body->getSurfaceArea();
     double projectedArea = area * 0.25;
 
-    std::vector<NodeIndex> stack;
-    stack.reserve(kTraversalStackReserve);
+    // Bodies of reached leaves are gathered and summed in one kernel call, accepted nodes as they come
+    QueryScratch& scratch = queryScratch;
+    scratch.reset();
+    std::vector<NodeIndex>& stack = scratch.stack;
     stack.push_back(NodeIndex::rootIndex());
 
     while (!stack.empty()) {
@@ -215,27 +552,20 @@ double Octree::computeHeat(Physics::PhysicsBody* body) {
 
         if (node.totalEffectiveArea == 0.0) continue;
 
-        glm::vec3 dist = node.massCenter - bodyPos;
+        Vec3 dist = node.massCenter - bodyPos;
         double distSq = static_cast<double>(glm::dot(dist, dist));
         if (distSq < kMinRadiationDistanceSq) distSq = kMinRadiationDistanceSq;
 
-        float widthSq = node.halfSize * node.halfSize * 4.0f;
+        Real widthSq = node.halfSize * node.halfSize * Real(4);
         const bool nodeContainsBody = containsPosition(node, bodyPos);
 
         if (node.isLeaf()) {
-            for (Physics::PhysicsBody* other : node.bodies) {
-                if (other == body) continue;
-                glm::vec3 pairDist = other->getPosition(BodyLock::NOLOCK) - bodyPos;
-                double pairDistSq = static_cast<double>(glm::dot(pairDist, pairDist));
-                if (pairDistSq < kMinRadiationDistanceSq) pairDistSq = kMinRadiationDistanceSq;
-
-                double otherArea = other->getSurfaceArea();
-                ThermalProperties otherProps = other->getThermalProperties(BodyLock::NOLOCK);
-                double other_t_4 = Physics::Thermal::fourthPower(Physics::Thermal::clampTemperature(otherProps.tempK));
-                double viewFactorTerm = (projectedArea * otherArea) / (4.0 * glm::pi<double>() * pairDistSq);
-                viewFactorTerm = std::min(viewFactorTerm, projectedArea);
-                double q_rad = Constants::STEFAN_BOLTZMANN * absorptivity * Physics::Thermal::effectiveEmissivity(otherProps, otherProps.tempK) * viewFactorTerm * other_t_4;
-                totalHeat += q_rad;
+            for (std::uint32_t k = node.firstBody; k < node.firstBody + node.bodyCount; ++k) {
+                const OctreeBody& other = packed[k];
+                if (other.body == body) continue;
+                scratch.addSource(other.position);
+                scratch.area.push_back(other.area);
+                scratch.emission.push_back(other.emissivity * other.tempPow4);
             }
 
         } else if (!nodeContainsBody && widthSq < Constants::THETA_SQ * distSq) {
@@ -252,5 +582,11 @@ double Octree::computeHeat(Physics::PhysicsBody* body) {
             }
         }
     }
+
+    const Real target[3] = { bodyPos.x, bodyPos.y, bodyPos.z };
+    const Physics::LeafKernels::RadiationSources sources{
+        scratch.x.data(), scratch.y.data(), scratch.z.data(), scratch.area.data(), scratch.emission.data(), scratch.area.size() };
+    totalHeat += Constants::STEFAN_BOLTZMANN * absorptivity
+        * Physics::LeafKernels::radiation(target, sources, projectedArea, kMinRadiationDistanceSq);
     return totalHeat;
 }
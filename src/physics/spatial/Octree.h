@@ -1,11 +1,17 @@
 #pragma once
 
+#include "../Constants.h"
 #include "../PhysicsBody.h"
 #include "NodeIndex.h"
 #include <glm/glm.hpp>
+#include <array>
 #include <vector>
 #include <cstdint>
 
+namespace Physics {
+    class ThreadPool;
+}
+
 struct Octant {
     std::uint8_t val; // 0-7 representing the octant
 
@@ -14,18 +20,33 @@ struct Octant {
     static constexpr std::uint8_t Z_MASK = 1 << 2;
 };
 
+// Everything the leaf interactions read about a body, packed in Morton order once per build
+struct OctreeBody {
+    Physics::Vec3 position;
+    double mass = 0.0;
+    double area = 0.0;
+    double emissivity = 0.0;        // effective, at the body's temperature
+    double tempPow4 = 0.0;          // clamped T^4
+    const Physics::PhysicsBody* body = nullptr; // identity only, so a query can skip itself
+};
+
+// Geometry is kept in Physics::Real so the tree matches the body state precision
 struct OctreeNode {
-    glm::vec3 center;
-    float halfSize;
+    Physics::Vec3 center;
+    Physics::Real halfSize;
     NodeIndex children[8];
     uint8_t childMask = 0; // Bitmask to track which children exist
 
-    // Leaf nodes only
-    std::vector<Physics::PhysicsBody*> bodies;
+    // Range of the packed bodies under this node; for leaves, the bodies it holds
+    std::uint32_t firstBody = 0;
+    std::uint32_t bodyCount = 0;
 
     // Aggregated properties (center, mass)
-    glm::vec3 massCenter;
+    Physics::Vec3 massCenter;
     double totalMass = 0.0;
+    // Second moment of mass about massCenter, sum of m * s s^T as xx, xy, xz, yy, yz, zz.
+    // Only summed when the tree is built with quadrupoles
+    std::array<double, 6> quadrupole{};
 
     // Aggregated thermal properties
     double totalEffectiveArea = 0.0; // sum of (epsilon * Area)
@@ -36,16 +57,84 @@ struct OctreeNode {
     }
 };
 
+/**
+ * @brief Linear octree over 63-bit Morton keys
+ *
+ * build() quantises every body to 21 bits per axis inside the root cube,
+ * interleaves the bits into a Morton key and radix sorts the keys, so the
+ * bodies of every node end up in one contiguous range. Nodes are cut from the
+ * sorted ranges top-down (subtrees below the first levels in parallel) and the
+ * mass centres and emission are summed bottom-up in double precision.
+ *
+ * Leaves do not own their bodies: each node names a range of packed, a flat
+ * array of OctreeBody in Morton order, so leaf interactions stream through
+ * contiguous memory instead of chasing body pointers and virtual getters.
+ *
+ * computeForce sums a node whole once its width w and the distance d to its
+ * mass centre satisfy w^2 < thetaSq * d^2. With quadrupoles the node also
+ * pulls through its second moment, which cuts the error of every accepted node
+ * by about another factor of w / d, so a larger thetaSq opens fewer nodes for
+ * the same force error.
+ *
+ * Queries collect the bodies of the leaves they reach (and, for forces, the
+ * accepted nodes) into per-thread batches and sum them in one vectorised
+ * call, see LeafKernels.
+ *
+ * The subdivision rules are those of one-at-a-time insertion: a node splits
+ * until each child holds a single body, except for coincident bodies and
+ * nodes at the minimum size. Bodies closer than the 21-bit key resolution are
+ * split by comparing positions with the node centre instead.
+ */
 class Octree {
 private:
+    friend class FastMultipole; // walks nodes and packed directly
+
+    struct Subtree {
+        int parent;
+        std::uint8_t octant;
+        std::uint32_t begin;
+        std::uint32_t end;
+        Physics::Vec3 center;
+        Physics::Real halfSize;
+    };
+
     std::vector<OctreeNode> nodes;
+    std::vector<OctreeBody> packed; // Morton order, leaves stream over their range
+
+    // Build scratch, kept so steady-state rebuilds allocate nothing
+    std::vector<OctreeBody> gathered; // input order
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint64_t> keyScratch;
+    std::vector<std::uint32_t> order;
+    std::vector<std::uint32_t> orderScratch;
+    std::vector<glm::dvec3> massMoments; // per node, sum of mass * position
+    static constexpr std::size_t kRadixBuckets = 256;
+    std::vector<std::array<std::uint32_t, kRadixBuckets>> radixCounts; // per sort block
+    std::vector<Subtree> subtrees;
+    std::vector<std::vector<OctreeNode>> subtreeNodes; // one per subtree, spliced after the top levels
+
+    Physics::Real thetaSq = Constants::THETA_SQ;
+    bool useQuadrupoles = false;
+
     void clear();
-    NodeIndex allocateNode(const glm::vec3& center, float halfSize);
-    void insert(NodeIndex nodeIndex, Physics::PhysicsBody* body);
-    Octant getOctant(NodeIndex nodeIdx, const glm::vec3& pos) const;
+    void sortByKey(Physics::ThreadPool* pool);
+    void aggregate(Physics::ThreadPool* pool);
 public:
     Octree() = default;
     glm::vec3 computeForce(Physics::PhysicsBody* body, double G);
     double computeHeat(Physics::PhysicsBody* body);
-    void build(const std::vector<Physics::PhysicsBody*>& bodies);
+    // Spreads gathering, sorting and subtree construction over pool when given; the tree is the same either way
+    void build(const std::vector<Physics::PhysicsBody*>& bodies, Physics::ThreadPool* pool = nullptr);
+    // Re-reads the positions of the bodies of the last build and re-sums the nodes without re-sorting.
+    // Node cubes only grow to keep holding their bodies, so queries stay correct; the tree just gets
+    // looser the further bodies move. Meant for short drifts between builds, e.g. block sub-steps
+    void refit(Physics::ThreadPool* pool = nullptr);
+    std::size_t nodeCount() const { return nodes.size(); }
+
+    // Gravity only, computeHeat keeps Constants::THETA_SQ
+    void setThetaSq(Physics::Real value) { thetaSq = value; }
+    Physics::Real getThetaSq() const { return thetaSq; }
+    // Takes effect at the next build
+    void setQuadrupoles(bool enabled) { useQuadrupoles = enabled; }
+    bool hasQuadrupoles() const { return useQuadrupoles; }
 };
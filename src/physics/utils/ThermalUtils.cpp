@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <glm/gtc/constants.hpp>
 #include "physics/Constants.h"
 
 namespace Physics::Thermal {
@@ -119,6 +120,13 @@ double conductiveHeatRate(double conductivityA, double conductivityB, double are
     return kEff * areaM2 * (tempBK - tempAK) / std::max(distanceM, kMinConductionDistance);
 }
 
+double sphereSurfaceArea(double massKg, double densityKgM3) {
+    if (massKg <= 0.0 || densityKgM3 <= 0.0) return 0.0;
+    const double volume = massKg / densityKgM3;
+    const double radius = std::cbrt((3.0 * volume) / (4.0 * glm::pi<double>()));
+    return 4.0 * glm::pi<double>() * radius * radius;
+}
+
 void applyThermalEnergy(ThermalProperties& props, double massKg, double energyJ) {
     const double capacity = heatCapacity(massKg, props);
     if (capacity <= 0.0 || energyJ == 0.0 || !std::isfinite(energyJ)) return;
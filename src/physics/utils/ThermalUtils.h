@@ -32,17 +32,20 @@ double convectionHeatRate(const ThermalProperties& props, double areaM2, double
 double ambientRadiationHeatRate(const ThermalProperties& props, double areaM2, double ambientTempK);
 double externalHeatFluxRate(const ThermalProperties& props, double areaM2);
 double conductiveHeatRate(double conductivityA, double conductivityB, double areaM2, double distanceM, double tempAK, double tempBK);
+double sphereSurfaceArea(double massKg, double densityKgM3);
 void applyThermalEnergy(ThermalProperties& props, double massKg, double energyJ);
 void applyConductiveExchange(ThermalProperties& a, double massA, ThermalProperties& b, double massB, double areaM2, double distanceM, double dt);
 
+// Returns the number of sub-steps taken
 template <typename HeatRateFn>
-void integrateTemperature(ThermalProperties& props, double massKg, double dt, HeatRateFn&& heatRateAtTemp) {
-    if (dt <= 0.0) return;
+int integrateTemperature(ThermalProperties& props, double massKg, double dt, HeatRateFn&& heatRateAtTemp) {
+    if (dt <= 0.0) return 0;
     const double capacity = heatCapacity(massKg, props);
-    if (capacity <= 0.0) return;
+    if (capacity <= 0.0) return 0;
 
     double remaining = dt;
     int guard = 0;
+    int subSteps = 0;
     while (remaining > 0.0 && guard++ < 4096) {
         const double rate = heatRateAtTemp(props.tempK);
         if (!std::isfinite(rate) || rate == 0.0) break;
@@ -54,7 +57,9 @@ void integrateTemperature(ThermalProperties& props, double massKg, double dt, He
 
         applyThermalEnergy(props, massKg, rate * subDt);
         remaining -= subDt;
+        ++subSteps;
     }
+    return subSteps;
 }
 
 }
@@ -0,0 +1,116 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+Physics::ThreadPool::ThreadPool(std::size_t threadCount) {
+    if (threadCount == 0) threadCount = defaultThreadCount();
+
+    queues.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    // Worker 0 is whichever thread calls parallelFor
+    threads.reserve(threadCount - 1);
+    for (std::size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+Physics::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    wakeCv.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+std::size_t Physics::ThreadPool::defaultThreadCount() {
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+void Physics::ThreadPool::parallelFor(std::size_t count, std::size_t grain, const RangeFn& fn) {
+    if (count == 0) return;
+    grain = std::max<std::size_t>(1, grain);
+
+    if (threads.empty() || count <= grain) {
+        fn(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> callLock(callMutex);
+
+    const std::size_t rangeCount = (count + grain - 1) / grain;
+    const std::size_t workerCount = queues.size();
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        job = &fn;
+        pendingRanges.store(rangeCount, std::memory_order_relaxed);
+
+        // Deal contiguous runs of chunks so neighbouring slots stay on one core
+        for (std::size_t r = 0; r < rangeCount; ++r) {
+            const std::size_t owner = r * workerCount / rangeCount;
+            const std::size_t begin = r * grain;
+            std::lock_guard<std::mutex> queueLock(queues[owner]->mutex);
+            queues[owner]->ranges.push_back({ begin, std::min(begin + grain, count) });
+        }
+        ++generation;
+    }
+    wakeCv.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(jobMutex);
+    doneCv.wait(lock, [this] { return pendingRanges.load(std::memory_order_acquire) == 0; });
+    job = nullptr;
+}
+
+void Physics::ThreadPool::workerLoop(std::size_t index) {
+    std::uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            wakeCv.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+        drain(index);
+    }
+}
+
+void Physics::ThreadPool::drain(std::size_t index) {
+    Range range{};
+    while (popLocal(index, range) || steal(index, range)) {
+        (*job)(range.begin, range.end);
+
+        if (pendingRanges.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            doneCv.notify_all();
+        }
+    }
+}
+
+bool Physics::ThreadPool::popLocal(std::size_t index, Range& out) {
+    Queue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty()) return false;
+    out = queue.ranges.front();
+    queue.ranges.pop_front();
+    return true;
+}
+
+bool Physics::ThreadPool::steal(std::size_t thief, Range& out) {
+    const std::size_t workerCount = queues.size();
+    for (std::size_t offset = 1; offset < workerCount; ++offset) {
+        Queue& victim = *queues[(thief + offset) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.ranges.empty()) continue;
+        out = victim.ranges.back();
+        victim.ranges.pop_back();
+        return true;
+    }
+    return false;
+}
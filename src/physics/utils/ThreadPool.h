@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Physics {
+    /**
+     * @brief Fixed-size work-stealing pool for data-parallel loops over bodies.
+     *
+     * parallelFor() cuts an index range into chunks and deals a contiguous run of
+     * chunks to every worker's deque. Each worker drains its own deque from the
+     * front and, once empty, steals from the back of the others, so uneven
+     * per-body costs (deep Barnes-Hut walks next to cheap ones) still balance.
+     *
+     * The calling thread takes part as worker 0, so a pool of size 1 spawns no
+     * threads and runs everything inline. Chunks only decide *who* computes an
+     * index, never *what* is computed, so any callback that writes only to its
+     * own indices produces bit-identical results for every thread count.
+     */
+    class ThreadPool {
+    public:
+        using RangeFn = std::function<void(std::size_t begin, std::size_t end)>;
+
+        /**
+         * @param threadCount Total workers including the caller; 0 picks the hardware concurrency
+         */
+        explicit ThreadPool(std::size_t threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        std::size_t size() const { return queues.size(); }
+
+        /**
+         * @brief Runs fn over [0, count) in chunks of at most grain indices and blocks until all are done.
+         *
+         * Calls from several threads are serialised.
+         */
+        void parallelFor(std::size_t count, std::size_t grain, const RangeFn& fn);
+
+        static std::size_t defaultThreadCount();
+
+    private:
+        struct Range {
+            std::size_t begin;
+            std::size_t end;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Range> ranges;
+        };
+
+        void workerLoop(std::size_t index);
+        void drain(std::size_t index);
+        bool popLocal(std::size_t index, Range& out);
+        bool steal(std::size_t thief, Range& out);
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> threads;
+
+        std::mutex callMutex; // one parallelFor at a time
+        std::mutex jobMutex;
+        std::condition_variable wakeCv;
+        std::condition_variable doneCv;
+        const RangeFn* job = nullptr;
+        std::uint64_t generation = 0;
+        std::atomic<std::size_t> pendingRanges{0};
+        bool stopping = false;
+    };
+}
@@ -45,8 +45,15 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     fpsLabel->setText("FPS: 0.0");
     statusBar()->addPermanentWidget(fpsLabel);
 
+    if constexpr (Physics::StepProfiler::enabled) {
+        stepProfileLabel = new QLabel(this);
+        stepProfileLabel->setText("Step: -");
+        statusBar()->addPermanentWidget(stepProfileLabel);
+    }
+
     connect(glWindow, &OpenGLWindow::fpsUpdated, this, [this](double fps) {
         fpsLabel->setText(QString("FPS: %1").arg(fps, 0, 'f', 1));
+        updateStepProfileLabel();
         updateStatusPanel();
     });
 
@@ -333,6 +340,24 @@ void MainWindow::loadAppSettings() {
     updateStatusPanel();
 }
 
+void MainWindow::updateStepProfileLabel() {
+    if (!stepProfileLabel || !sceneManager) return;
+
+    Physics::StepProfile profile;
+    if (!sceneManager->getStepProfiler().latest(profile)) return;
+
+    // Total plus the phase that dominates it
+    std::size_t slowest = 0;
+    for (std::size_t p = 1; p < Physics::kStepPhaseCount; ++p) {
+        if (profile.phaseNanos[p] > profile.phaseNanos[slowest]) slowest = p;
+    }
+    const auto phase = static_cast<Physics::StepPhase>(slowest);
+    stepProfileLabel->setText(QString("Step: %1 ms (%2 %3 ms)")
+        .arg(profile.totalMilliseconds(), 0, 'f', 2)
+        .arg(Physics::stepPhaseName(phase))
+        .arg(profile.milliseconds(phase), 0, 'f', 2));
+}
+
 void MainWindow::updateStatusPanel() {
     if (!sceneManager || !sceneManager->scene || !sceneManager->scene->getCamera())
         return;
@@ -415,7 +440,8 @@ void MainWindow::onHierarchySelectionChanged(SceneObject *previous, SceneObject
         inspector->loadObject(current);
 
         if (auto* selectedBody = current->getPhysicsBody()) {
-            selectedBody->withFrames(BodyLock::LOCK, [this](const std::vector<ObjectSnapshot>& snapshots) {
+            selectedBody->withFrames(BodyLock::LOCK, [this](const Physics::FrameHistory::View& frames) {
+                const std::vector<ObjectSnapshot> snapshots = frames.toVector();
                 snapshotModel->setSnapshots(snapshots);
                 frameGraphPanel->loadSnapshots(snapshots);
             });
@@ -36,6 +36,7 @@ private:
 
     QTreeWidgetItem* previousItem = nullptr;
     QLabel* fpsLabel;
+    QLabel* stepProfileLabel = nullptr; // only with PHYSICS_ENABLE_PROFILING
     QLabel* cameraPositionLabel;
     QLabel* selectedObjectLabel;
     QLabel* selectedObjectPositionLabel;
@@ -58,4 +59,5 @@ private:
     void setupMenuBar();
     void loadAppSettings();
     void updateStatusPanel();
+    void updateStepProfileLabel();
 };
@@ -75,13 +75,13 @@ void OpenGLWindow::paintGL() {
 
     //sceneManager->stepPhysics(deltaTime);
     // 1) Acquire the latest batch of snapshots
-    auto snaps = sceneManager->physicsSystem->fetchLatestSnapshot(renderSimTime);
+    const bool hasSnapshots = sceneManager->physicsSystem->fetchLatestSnapshot(renderSimTime, renderSnapshots);
 
     sceneManager->processHeldKeys(pressedKeys, deltaTime);
 
     Math::Ray ray = getMouseRay();
     sceneManager->updateHoverState(ray);
-    scene->draw(snaps, sceneManager->hoveredIDs, sceneManager->selectedIDs);
+    scene->draw(hasSnapshots ? &renderSnapshots : nullptr, sceneManager->hoveredIDs, sceneManager->selectedIDs);
     updateObjectLabels();
 
     calculateFPS();
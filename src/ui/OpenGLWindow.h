@@ -12,6 +12,7 @@
 #include <memory>
 #include <vector>
 #include "math/Ray.h"
+#include "physics/PhysicsBody.h"
 
 class Scene;
 class SceneManager;
@@ -64,6 +65,7 @@ protected:
 private:
     std::chrono::steady_clock::time_point lastFrame;
     float renderSimTime = 0.0f;
+    std::vector<ObjectSnapshot> renderSnapshots; // reused every frame
     std::atomic<float> simSpeed = 1.0f;
     bool simulating = false;
 
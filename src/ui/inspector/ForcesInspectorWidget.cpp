@@ -58,13 +58,7 @@ void ForcesInspectorWidget::load(SceneObject* object) {
         net.addVec3(
             [this]() {
                 auto* b = getBody();
-                if (!b) return glm::vec3(0.0f);
-
-                glm::vec3 sum(0.0f);
-                for (const auto& [_, f] : b->getAllForces(BodyLock::NOLOCK)) {
-                    sum += f;
-                }
-                return sum;
+                return b ? b->getNetForce(BodyLock::NOLOCK) : glm::vec3(0.0f);
             },
             nullptr,
             "N"
@@ -1,9 +1,24 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <type_traits>
+#include <glm/gtc/matrix_transform.hpp>
+#include "physics/CloneRunner.h"
 #include "physics/PhysicsSystem.h"
 #include "physics/PointMass.h"
 #include "physics/RigidBody.h"
+#include "physics/SnapshotChannel.h"
 #include "physics/bounding/BoxCollider.h"
+#include "physics/integration/WisdomHolman.h"
+#include "physics/solver/EnsembleRunner.h"
+#include "physics/solver/InterceptSolver.h"
+#include "physics/solver/VectorRootSolver.h"
+#include "physics/spatial/BVH.h"
+#include "physics/spatial/LeafKernels.h"
 #include "physics/utils/ThermalUtils.h"
 
 // Helper Macros for concise GLM comparisons
@@ -94,6 +109,19 @@ TEST(PointMass, Force_Update_Existing) {
     EXPECT_VEC3_EXACT(pm.getNetForce(BodyLock::LOCK), glm::vec3(0.0f, 50.0f, 0.0f));
 }
 
+TEST(PointMass, Force_NetDoesNotDriftOverManyUpdates) {
+    auto pm = Physics::PointMass(0, 1.0f);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> uniform(-100.0f, 100.0f);
+    for (int i = 0; i < 100000; ++i) {
+        pm.setForce(Physics::ForceRegistry::Gravity, glm::vec3(uniform(rng), uniform(rng), uniform(rng)), BodyLock::NOLOCK);
+        pm.setForce(Physics::ForceRegistry::Normal, glm::vec3(uniform(rng), uniform(rng), uniform(rng)), BodyLock::NOLOCK);
+    }
+    pm.setForce(Physics::ForceRegistry::Gravity, glm::vec3(0.0f), BodyLock::NOLOCK);
+    pm.setForce(Physics::ForceRegistry::Normal, glm::vec3(0.0f), BodyLock::NOLOCK);
+    EXPECT_VEC3_EXACT(pm.getNetForce(BodyLock::LOCK), glm::vec3(0.0f));
+}
+
 TEST(PointMass, Force_Get_NonExistent) {
     auto pm = Physics::PointMass(0, 1.0f);
 
@@ -101,6 +129,29 @@ TEST(PointMass, Force_Get_NonExistent) {
     EXPECT_VEC3_EXACT(pm.getNetForce(BodyLock::LOCK), glm::vec3(0.0f, 0.0f, 0.0f));
 }
 
+TEST(PointMass, Force_InternedIdMatchesName) {
+    auto pm = Physics::PointMass(0, 1.0f);
+    EXPECT_EQ(Physics::ForceRegistry::name(Physics::ForceRegistry::Gravity), "Gravity");
+    EXPECT_FALSE(Physics::ForceRegistry::find("NeverSetForce").has_value());
+
+    const auto drag = Physics::ForceRegistry::intern("Drag");
+    ASSERT_TRUE(drag.has_value());
+    EXPECT_EQ(Physics::ForceRegistry::intern("Drag"), drag);
+
+    pm.setForce(*drag, glm::vec3(0.0f, 0.0f, -2.0f), BodyLock::LOCK);
+    pm.setForce(Physics::ForceRegistry::Normal, glm::vec3(0.0f), BodyLock::LOCK);
+    pm.setForce("Gravity", glm::vec3(0.0f, -9.0f, 0.0f), BodyLock::LOCK);
+    EXPECT_VEC3_EXACT(pm.getForce("Drag", BodyLock::LOCK), glm::vec3(0.0f, 0.0f, -2.0f));
+    EXPECT_VEC3_EXACT(pm.getForce(Physics::ForceRegistry::Gravity, BodyLock::LOCK), glm::vec3(0.0f, -9.0f, 0.0f));
+    EXPECT_VEC3_EXACT(pm.getNetForce(BodyLock::LOCK), glm::vec3(0.0f, -9.0f, -2.0f));
+
+    // Forces set to zero still show up by name, unset ones don't
+    const auto named = pm.getAllForces(BodyLock::LOCK);
+    EXPECT_EQ(named.size(), 3u);
+    EXPECT_EQ(named.count("Normal"), 1u);
+    EXPECT_EQ(named.count("NeverSetForce"), 0u);
+}
+
 TEST(PointMass, Invalid_Mass) {
     auto pm = Physics::PointMass(0, 0.0f);
     // Mass defaults to 1.0, should ignore invalid mass values
@@ -170,6 +221,34 @@ TEST(PhysicsSystem, Management_AddGetRemove) {
     EXPECT_EQ(system.getBodyById(10), nullptr);
 }
 
+TEST(PhysicsSystem, BodyStore_StateSurvivesAddRemove) {
+    Physics::PhysicsSystem system(glm::vec3(0.0f));
+    Physics::PointMass a(0, 2.0);
+    Physics::PointMass b(1, 3.0);
+    Physics::PointMass c(2, 4.0);
+
+    a.setPosition(glm::vec3(1.0f, 2.0f, 3.0f), BodyLock::LOCK);
+    b.setVelocity(glm::vec3(0.0f, 5.0f, 0.0f), BodyLock::LOCK);
+    c.setPosition(glm::vec3(-4.0f, 0.0f, 0.0f), BodyLock::LOCK);
+    system.addBody(&a);
+    system.addBody(&b);
+    system.addBody(&c);
+    EXPECT_TRUE(a.isAttached());
+
+    // Removing the first slot moves the last body into it
+    system.removeBody(&a);
+    EXPECT_FALSE(a.isAttached());
+    EXPECT_VEC3_EXACT(a.getPosition(BodyLock::LOCK), glm::vec3(1.0f, 2.0f, 3.0f));
+    EXPECT_DOUBLE_EQ(a.getMass(BodyLock::LOCK), 2.0);
+    EXPECT_VEC3_EXACT(b.getVelocity(BodyLock::LOCK), glm::vec3(0.0f, 5.0f, 0.0f));
+    EXPECT_VEC3_EXACT(c.getPosition(BodyLock::LOCK), glm::vec3(-4.0f, 0.0f, 0.0f));
+    EXPECT_DOUBLE_EQ(c.getMass(BodyLock::LOCK), 4.0);
+    EXPECT_EQ(system.getBodyById(2), &c);
+
+    a.setMass(6.0, BodyLock::LOCK);
+    EXPECT_DOUBLE_EQ(a.getMass(BodyLock::LOCK), 6.0);
+}
+
 TEST(PhysicsSystem, Parameters_GlobalSettings) {
     Physics::PhysicsSystem system;
 
@@ -221,6 +300,1074 @@ TEST(PhysicsSystem, SampleSolverGravity_DoesNotDriftSideways) {
     EXPECT_NEAR(keys.getPosition(BodyLock::LOCK).z, 0.0f, 1.0e-6f);
 }
 
+TEST(PhysicsSystem, Solver_KeepsConvergedTrajectory) {
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -Constants::STANDARD_GRAVITY, 0.0f));
+    Physics::PointMass ball(0, 1.0, glm::vec3(0.0f), false);
+    system.addBody(&ball);
+
+    // Launch velocity that lands the ball on (5, 0, 0) after one second
+    system.solveProblem(&ball, {
+        {"r0_x", 0.0}, {"r0_y", 0.0}, {"r0_z", 0.0},
+        {"Stop_SubjectID", 0.0}, {"Stop_Prop", 3.0}, {"Stop_Op", 0.0}, {"Stop_Val", 0.0}, {"Stop_TargetID", -1.0},
+        {"Stop_Val_X", 5.0}, {"Stop_Val_Y", 0.0}, {"Stop_Val_Z", 0.0},
+        {"Target_Time", 1.0}
+    }, "v0");
+
+    constexpr float dt = 1.0f / 100.0f;
+    int steps = 0;
+    while (!system.step(dt)) ASSERT_LT(++steps, 100000);
+
+    // No re-bake: the clock, the state and the frames are those of the final guess's run
+    EXPECT_NEAR(system.simTime, 1.0, dt);
+    const glm::vec3 landed = ball.getPosition(BodyLock::LOCK);
+    EXPECT_NEAR(glm::distance(landed, glm::vec3(5.0f, 0.0f, 0.0f)), 0.0f, 1.0e-2f);
+    EXPECT_FALSE(system.isPhysicsEnabled());
+    ball.withFrames(BodyLock::LOCK, [&](const Physics::FrameHistory::View& frames) {
+        ASSERT_FALSE(frames.empty());
+        // The adopted fork's frames replace whatever the live scene ran while the batches were out
+        EXPECT_EQ(frames.size(), static_cast<std::size_t>(std::lround(system.simTime / dt)) + 1);
+        EXPECT_FLOAT_EQ(frames.front().time, 0.0f);
+        EXPECT_FLOAT_EQ(frames.back().time, static_cast<float>(system.simTime));
+        EXPECT_VEC3_EXACT(frames.back().position, landed);
+    });
+}
+
+TEST(PhysicsSystem, Solver_ClearingMidBatchCancelsTheForks) {
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -Constants::STANDARD_GRAVITY, 0.0f));
+    Physics::PointMass ball(0, 1.0, glm::vec3(0.0f), false);
+    system.addBody(&ball);
+
+    // The stop time is never reached, so the forks would run to their step limit
+    system.solveProblem(&ball, {
+        {"r0_x", 0.0}, {"r0_y", 0.0}, {"r0_z", 0.0},
+        {"Stop_SubjectID", 0.0}, {"Stop_Prop", 3.0}, {"Stop_Op", 0.0}, {"Stop_Val", 0.0}, {"Stop_TargetID", -1.0},
+        {"Stop_Val_X", 5.0}, {"Stop_Val_Y", 0.0}, {"Stop_Val_Z", 0.0},
+        {"Target_Time", 1.0e9}
+    }, "v0");
+    ASSERT_FALSE(system.step(0.01f)); // launches the first batch
+
+    const auto start = std::chrono::steady_clock::now();
+    system.clearRuntimeState();
+    EXPECT_LT(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 0.5);
+    EXPECT_EQ(system.simTime, 0.0);
+    EXPECT_FALSE(system.step(0.01f)); // no solver left to finish
+}
+
+TEST(PhysicsSystem, Clone_StepsLikeTheOriginalWithoutTouchingIt) {
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -9.81f, 0.0f));
+    system.setIntegrator(Physics::IntegratorType::LeapfrogKDK);
+    Physics::PointMass ball(0, 2.0, glm::vec3(0.0f, 10.0f, 0.0f));
+    ball.setVelocity(glm::vec3(1.0f, 4.0f, 0.0f), BodyLock::LOCK);
+    ball.setForce("Push", glm::vec3(0.5f, 0.0f, 0.0f), BodyLock::LOCK);
+    auto collider = std::make_unique<Physics::Bounding::BoxCollider>(
+        glm::vec3(0.0f), glm::vec3(5.0f, 1.0f, 5.0f), glm::quat(glm::vec3(0.0f, 0.3f, 0.0f)));
+    Physics::RigidBody floor(1, std::move(collider), glm::vec3(0.0f, -1.0f, 0.0f), true);
+    system.addBody(&ball);
+    system.addBody(&floor);
+    for (int i = 0; i < 10; ++i) system.step(0.01f);
+
+    std::unique_ptr<Physics::PhysicsSystem> copy = system.clone();
+    EXPECT_EQ(copy->simTime, system.simTime);
+    Physics::PhysicsBody* ballCopy = copy->getBodyById(0);
+    Physics::PhysicsBody* floorCopy = copy->getBodyById(1);
+    ASSERT_NE(ballCopy, nullptr);
+    ASSERT_NE(floorCopy, nullptr);
+    EXPECT_NE(ballCopy, &ball);
+    EXPECT_VEC3_EXACT(ballCopy->getForce("Push", BodyLock::LOCK), glm::vec3(0.5f, 0.0f, 0.0f));
+    const glm::vec3 corner(4.5f, -0.5f, 4.5f);
+    EXPECT_EQ(floorCopy->getCollider()->getTransformed(floorCopy->getWorldTransform(BodyLock::LOCK))->contains(corner),
+              floor.getCollider()->getTransformed(floor.getWorldTransform(BodyLock::LOCK))->contains(corner));
+
+    // Stepping the copy leaves the original alone, then both end up in the same state
+    const glm::dvec3 before = ball.getPositionPrecise(BodyLock::LOCK);
+    for (int i = 0; i < 50; ++i) copy->step(0.01f);
+    EXPECT_EQ(ball.getPositionPrecise(BodyLock::LOCK), before);
+    for (int i = 0; i < 50; ++i) system.step(0.01f);
+    EXPECT_EQ(ballCopy->getPositionPrecise(BodyLock::LOCK), ball.getPositionPrecise(BodyLock::LOCK));
+    EXPECT_EQ(ballCopy->getVelocityPrecise(BodyLock::LOCK), ball.getVelocityPrecise(BodyLock::LOCK));
+}
+
+TEST(PhysicsSystem, Sleep_RestingBodiesSleepUntilWoken) {
+    Physics::PhysicsSystem system(glm::vec3(0.0f));
+    system.setGravitationalConstant(0.0);
+    Physics::SleepConfig sleep;
+    sleep.enabled = true;
+    sleep.timeToSleep = 0.1f;
+    system.setSleepConfig(sleep);
+
+    Physics::PointMass restingA(0, 1.0, glm::vec3(0.0f, 0.0f, 0.0f));
+    Physics::PointMass restingB(1, 1.0, glm::vec3(5.0f, 0.0f, 0.0f));
+    Physics::PointMass moving(2, 1.0, glm::vec3(0.0f, 5.0f, 0.0f));
+    moving.setVelocity(glm::vec3(1.0f, 0.0f, 0.0f), BodyLock::LOCK);
+    system.addBody(&restingA);
+    system.addBody(&restingB);
+    system.addBody(&moving);
+
+    for (int i = 0; i < 30; ++i) system.step(0.01f);
+    EXPECT_TRUE(restingA.isSleeping(BodyLock::LOCK));
+    EXPECT_TRUE(restingB.isSleeping(BodyLock::LOCK));
+    EXPECT_FALSE(moving.isSleeping(BodyLock::LOCK));
+    EXPECT_EQ(system.getSleepingBodyCount(), 2u);
+    EXPECT_VEC3_NEAR(moving.getPosition(BodyLock::LOCK), glm::vec3(0.3f, 5.0f, 0.0f), 1e-4f);
+
+    // Setting state wakes only that body, changing the globals wakes everything
+    restingA.setVelocity(glm::vec3(0.0f, 0.0f, 2.0f), BodyLock::LOCK);
+    EXPECT_FALSE(restingA.isSleeping(BodyLock::LOCK));
+    system.step(0.1f);
+    EXPECT_VEC3_NEAR(restingA.getPosition(BodyLock::LOCK), glm::vec3(0.0f, 0.0f, 0.2f), 1e-5f);
+    EXPECT_TRUE(restingB.isSleeping(BodyLock::LOCK));
+
+    system.setGlobalAcceleration(glm::vec3(0.0f, -10.0f, 0.0f));
+    system.step(0.1f);
+    EXPECT_FALSE(restingB.isSleeping(BodyLock::LOCK));
+    EXPECT_LT(restingB.getPosition(BodyLock::LOCK).y, 0.0f);
+    EXPECT_EQ(system.getSleepingBodyCount(), 0u);
+}
+
+TEST(InterceptSolver, Rewind_LocalisesCrossingInsideCoarseStep) {
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -9.81f, 0.0f));
+    Physics::PointMass ball(0, 1.0, glm::vec3(0.0f));
+    ball.setVelocity(glm::vec3(0.0f, 10.0f, 0.0f), BodyLock::LOCK);
+    system.addBody(&ball);
+
+    // Rising through y = 5, one step is a tenth of a second
+    InterceptSolver solver([&]() { return 5.0f - ball.getPosition(BodyLock::LOCK).y; });
+    Physics::StateCheckpoint checkpoint;
+    solver.setRewind({
+        [&]() { system.captureCheckpoint(checkpoint); },
+        [&]() { system.restoreCheckpoint(checkpoint); },
+        [&](double dt) { system.step(static_cast<float>(dt)); },
+        [&]() { return system.simTime; }
+    });
+
+    int steps = 0;
+    while (!solver.stepFrame()) {
+        system.step(0.1f);
+        ASSERT_LT(++steps, 100);
+    }
+
+    const double expected = (10.0 - std::sqrt(100.0 - 2.0 * 9.81 * 5.0)) / 9.81;
+    ASSERT_TRUE(solver.getEventTime().has_value());
+    EXPECT_NEAR(*solver.getEventTime(), expected, 1.0e-6);
+    EXPECT_NEAR(system.simTime, expected, 1.0e-6);
+    EXPECT_NEAR(ball.getPosition(BodyLock::LOCK).y, 5.0f, 1.0e-4f);
+    ball.withFrames(BodyLock::LOCK, [&](const Physics::FrameHistory::View& frames) {
+        EXPECT_EQ(frames.size(), static_cast<std::size_t>(steps) + 1); // rewound sub-steps left no frames behind
+    });
+}
+
+TEST(VectorRootSolver, Broyden_SolvesNDimensionalSystemWithFewerEvaluations) {
+    // A default std::vector guess would have no unknowns, so vector solvers must be given one
+    using VectorSolver = VectorRootSolver<std::vector<double>, std::vector<double>>;
+    using Vec3Solver = VectorRootSolver<glm::vec3, glm::vec3>;
+    static_assert(!std::is_constructible_v<VectorSolver, VectorSolver::InitialGuessSetter, VectorSolver::StopCondition,
+                                           VectorSolver::ResultExtractor, const std::vector<double>&>);
+    static_assert(std::is_constructible_v<Vec3Solver, Vec3Solver::InitialGuessSetter, Vec3Solver::StopCondition,
+                                          Vec3Solver::ResultExtractor, const glm::vec3&>);
+
+    // Mildly nonlinear 4x4 system, each "simulation" is a plain function evaluation
+    auto F = [](const std::vector<double>& x) {
+        return std::vector<double>{
+            x[0] + 0.1 * x[1] * x[1],
+            x[1] + 0.1 * std::sin(x[2]),
+            x[2] + 0.05 * x[0] * x[3],
+            x[3] + 0.1 * x[0] * x[0]
+        };
+    };
+    const std::vector<double> target{ 1.0, -0.5, 0.25, 2.0 };
+
+    auto solve = [&](JacobianUpdate mode) {
+        std::vector<double> guess;
+        VectorRootSolver<std::vector<double>, std::vector<double>> solver(
+            [&](const std::vector<double>& x) { guess = x; },
+            []() { return true; },
+            [&]() { return F(guess); },
+            target, 1e-9, 50, 1e-6, 1.0, std::vector<double>(4, 0.0));
+        solver.setJacobianUpdate(mode);
+        guess = solver.getCurrentGuess();
+        int frames = 0;
+        while (!solver.stepFrame()) EXPECT_LT(++frames, 10000);
+
+        const std::vector<double> result = F(solver.getCurrentGuess());
+        for (std::size_t i = 0; i < target.size(); ++i) EXPECT_NEAR(result[i], target[i], 1e-8);
+        return solver.getEvaluationCount();
+    };
+
+    const int finiteDifference = solve(JacobianUpdate::FiniteDifference);
+    const int broyden = solve(JacobianUpdate::Broyden);
+    EXPECT_LT(broyden, finiteDifference);
+}
+
+TEST(CloneRunner, Run_BranchesLaunchesWithoutTouchingTheLiveScene) {
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -9.81f, 0.0f));
+    Physics::PointMass ball(0, 1.0, glm::vec3(0.0f));
+    system.addBody(&ball);
+
+    // One clone per launch speed, all stepped at once until they fall back below y = 0
+    constexpr std::size_t launches = 6;
+    std::vector<std::unique_ptr<Physics::PhysicsSystem>> clones;
+    std::vector<Physics::PhysicsSystem*> runs;
+    for (std::size_t i = 0; i < launches; ++i) {
+        clones.push_back(system.clone());
+        clones.back()->getBodyById(0)->setVelocity(glm::vec3(0.0f, 5.0f * static_cast<float>(i + 1), 0.0f), BodyLock::LOCK);
+        runs.push_back(clones.back().get());
+    }
+    Physics::CloneRunner runner(3);
+    const std::vector<std::size_t> steps = runner.run(runs, 0.01f, [](const Physics::PhysicsSystem& clone, std::size_t) {
+        return clone.simTime > 0.0 && clone.getBodyById(0)->getPosition(BodyLock::LOCK).y < 0.0f;
+    }, 100000);
+
+    ASSERT_EQ(steps.size(), launches);
+    for (std::size_t i = 0; i < launches; ++i) {
+        const double flightTime = 2.0 * 5.0 * static_cast<double>(i + 1) / 9.81;
+        EXPECT_NEAR(clones[i]->simTime, flightTime, 0.02);
+        if (i > 0) {
+            EXPECT_GT(steps[i], steps[i - 1]);
+        }
+    }
+    EXPECT_EQ(system.simTime, 0.0);
+    EXPECT_VEC3_EXACT(ball.getVelocity(BodyLock::LOCK), glm::vec3(0.0f));
+}
+
+TEST(EnsembleRunner, Run_HitProbabilityMatchesLaunchNoise) {
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -9.81f, 0.0f));
+    Physics::PointMass ball(0, 1.0, glm::vec3(0.0f));
+    ball.setVelocity(glm::vec3(0.0f, 10.0f, 0.0f), BodyLock::LOCK);
+    system.addBody(&ball);
+
+    // Hit once the ball rises to y = 4, which needs vy >= sqrt(2 g 4)
+    StopMonitor stop;
+    stop.subjectID = 0;
+    stop.prop = 0;
+    stop.op = 1;
+    stop.val = 4.0f;
+
+    Physics::CloneRunner runner(4);
+    EnsembleRunner ensemble(system, runner);
+    ensemble.addPerturbation(EnsembleRunner::velocityNoise(0, 0.1)); // 1 m/s per axis
+
+    EnsembleConfig config;
+    config.members = 400;
+    config.dt = 0.01f;
+    config.maxTime = 3.0;
+    config.seed = 7;
+    config.batchSize = 64;
+    std::size_t batches = 0;
+    const EnsembleStats stats = ensemble.run(config, stop, [&](const EnsembleStats&) { ++batches; return true; });
+
+    const double expected = 0.5 * std::erfc((std::sqrt(2.0 * 9.81 * 4.0) - 10.0) / std::numbers::sqrt2);
+    EXPECT_EQ(stats.runs, 400u);
+    EXPECT_EQ(batches, 7u);
+    EXPECT_NEAR(stats.hitProbability(), expected, 4.0 * stats.hitProbabilityStdError());
+    EXPECT_EQ(stats.eventTime.count, stats.hits);
+    EXPECT_GT(stats.eventTime.min, 0.3);
+    EXPECT_LT(stats.eventTime.max, 1.0);
+    EXPECT_EQ(ball.getVelocity(BodyLock::LOCK), glm::vec3(0.0f, 10.0f, 0.0f));
+
+    // Same seed, different batching: the same members, folded in the same order
+    config.batchSize = 0;
+    const EnsembleStats rerun = ensemble.run(config, stop);
+    EXPECT_EQ(rerun.hits, stats.hits);
+    EXPECT_DOUBLE_EQ(rerun.eventTime.mean, stats.eventTime.mean);
+}
+
+TEST(Octree, Build_ParallelMatchesSerialAndDirectSum) {
+    // Enough bodies for the parallel sort and the separately built subtrees
+    constexpr int bodyCount = 6000;
+    std::mt19937 rng(7);
+    std::normal_distribution<float> normal(0.0f, 20.0f);
+    std::vector<std::unique_ptr<Physics::PointMass>> owned;
+    std::vector<Physics::PhysicsBody*> bodies;
+    for (int i = 0; i < bodyCount; ++i) {
+        owned.push_back(std::make_unique<Physics::PointMass>(i, 1.0 + (i % 5), glm::vec3(normal(rng), normal(rng), normal(rng))));
+        bodies.push_back(owned.back().get());
+    }
+    // Coincident bodies share a leaf instead of splitting forever
+    owned.push_back(std::make_unique<Physics::PointMass>(bodyCount, 2.0, bodies[0]->getPosition(BodyLock::NOLOCK)));
+    bodies.push_back(owned.back().get());
+
+    Octree serial;
+    serial.build(bodies);
+    Physics::ThreadPool pool(4);
+    Octree parallel;
+    parallel.build(bodies, &pool);
+    EXPECT_EQ(parallel.nodeCount(), serial.nodeCount());
+
+    for (std::size_t i = 0; i < bodies.size(); i += 97) {
+        const glm::vec3 force = serial.computeForce(bodies[i], 1.0);
+        EXPECT_EQ(parallel.computeForce(bodies[i], 1.0), force);
+        EXPECT_EQ(parallel.computeHeat(bodies[i]), serial.computeHeat(bodies[i]));
+
+        glm::dvec3 direct(0.0);
+        const glm::dvec3 pos = bodies[i]->getPositionPrecise(BodyLock::NOLOCK);
+        for (Physics::PhysicsBody* other : bodies) {
+            if (other == bodies[i]) continue;
+            const glm::dvec3 d = other->getPositionPrecise(BodyLock::NOLOCK) - pos;
+            const double distSq = glm::dot(d, d) + Constants::SOFTENING_SQ;
+            direct += bodies[i]->getMass(BodyLock::NOLOCK) * other->getMass(BodyLock::NOLOCK) / (distSq * std::sqrt(distSq)) * d;
+        }
+        EXPECT_LT(glm::length(glm::dvec3(force) - direct), 0.05 * glm::length(direct));
+    }
+}
+
+TEST(Octree, Refit_TracksMovedBodiesLikeARebuild) {
+    std::mt19937 rng(9);
+    std::normal_distribution<float> normal(0.0f, 10.0f);
+    std::vector<std::unique_ptr<Physics::PointMass>> owned;
+    std::vector<Physics::PhysicsBody*> bodies;
+    for (int i = 0; i < 2000; ++i) {
+        owned.push_back(std::make_unique<Physics::PointMass>(i, 1.0, glm::vec3(normal(rng), normal(rng), normal(rng))));
+        bodies.push_back(owned.back().get());
+    }
+    Octree refitted;
+    refitted.build(bodies);
+
+    // Small drifts for most, one body thrown right across the tree
+    for (Physics::PhysicsBody* body : bodies) {
+        body->setPosition(body->getPosition(BodyLock::NOLOCK) + 0.1f * glm::vec3(normal(rng), normal(rng), normal(rng)), BodyLock::NOLOCK);
+    }
+    bodies[0]->setPosition(-bodies[0]->getPosition(BodyLock::NOLOCK), BodyLock::NOLOCK);
+    refitted.refit();
+    Octree rebuilt;
+    rebuilt.build(bodies);
+
+    // Both against the direct sum: the looser refitted tree may err a little more, never by much
+    double refitError = 0.0;
+    double rebuildError = 0.0;
+    for (std::size_t i = 0; i < bodies.size(); i += 41) {
+        const glm::dvec3 pos = bodies[i]->getPositionPrecise(BodyLock::NOLOCK);
+        glm::dvec3 direct(0.0);
+        for (Physics::PhysicsBody* other : bodies) {
+            if (other == bodies[i]) continue;
+            const glm::dvec3 d = other->getPositionPrecise(BodyLock::NOLOCK) - pos;
+            const double distSq = glm::dot(d, d) + Constants::SOFTENING_SQ;
+            direct += d / (distSq * std::sqrt(distSq));
+        }
+        refitError += glm::length(glm::dvec3(refitted.computeForce(bodies[i], 1.0)) - direct) / glm::length(direct);
+        rebuildError += glm::length(glm::dvec3(rebuilt.computeForce(bodies[i], 1.0)) - direct) / glm::length(direct);
+    }
+    EXPECT_LT(refitError, 2.0 * rebuildError);
+}
+
+TEST(Octree, ComputeForce_QuadrupolesCutFarFieldError) {
+    // A lopsided cluster seen from far away, so the probe only ever sums cluster nodes whole
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    std::vector<std::unique_ptr<Physics::PointMass>> owned;
+    std::vector<Physics::PhysicsBody*> bodies;
+    for (int i = 0; i < 400; ++i) {
+        const glm::vec3 pos(3.0f * uniform(rng), uniform(rng), 0.5f * uniform(rng));
+        owned.push_back(std::make_unique<Physics::PointMass>(i, 1.0 + (i % 4), pos));
+        bodies.push_back(owned.back().get());
+    }
+    owned.push_back(std::make_unique<Physics::PointMass>(400, 1.0, glm::vec3(12.0f, 7.0f, -5.0f)));
+    Physics::PhysicsBody* probe = owned.back().get();
+    bodies.push_back(probe);
+
+    glm::dvec3 direct(0.0);
+    const glm::dvec3 probePos = probe->getPositionPrecise(BodyLock::NOLOCK);
+    for (Physics::PhysicsBody* other : bodies) {
+        if (other == probe) continue;
+        const glm::dvec3 d = other->getPositionPrecise(BodyLock::NOLOCK) - probePos;
+        const double distSq = glm::dot(d, d) + Constants::SOFTENING_SQ;
+        direct += other->getMass(BodyLock::NOLOCK) / (distSq * std::sqrt(distSq)) * d;
+    }
+    auto error = [&](Physics::Real thetaSq, bool quadrupoles) {
+        Octree tree;
+        tree.setThetaSq(thetaSq);
+        tree.setQuadrupoles(quadrupoles);
+        tree.build(bodies);
+        return glm::length(glm::dvec3(tree.computeForce(probe, 1.0)) - direct) / glm::length(direct);
+    };
+
+    const double monopole = error(Constants::THETA_SQ, false);
+    EXPECT_GT(monopole, 0.0);
+    EXPECT_LT(error(Constants::THETA_SQ, true), 0.1 * monopole);
+    EXPECT_LT(error(Physics::Real(0.05), false), monopole); // smaller angles open more nodes
+}
+
+TEST(LeafKernels, EveryLevelMatchesScalar) {
+    // 37 sources leave a partial vector at every width; one sits on the target
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> uniform(-2.0, 2.0);
+    std::vector<Physics::Real> x, y, z, mass;
+    std::vector<double> area, emission;
+    for (int i = 0; i < 37; ++i) {
+        x.push_back(static_cast<Physics::Real>(uniform(rng)));
+        y.push_back(static_cast<Physics::Real>(uniform(rng)));
+        z.push_back(static_cast<Physics::Real>(uniform(rng)));
+        mass.push_back(static_cast<Physics::Real>(3.0 + uniform(rng)));
+        area.push_back(3.0 + uniform(rng));
+        emission.push_back(1e8 * (3.0 + uniform(rng)));
+    }
+    const Physics::Real target[3] = { x[9], y[9], z[9] };
+    const Physics::LeafKernels::GravitySources gravitySources{ x.data(), y.data(), z.data(), mass.data(), mass.size() };
+    const Physics::LeafKernels::RadiationSources radiationSources{ x.data(), y.data(), z.data(), area.data(), emission.data(), area.size() };
+    const auto softeningSq = static_cast<Physics::Real>(Constants::SOFTENING_SQ);
+
+    Physics::Real expected[3] = { 0, 0, 0 };
+    Physics::LeafKernels::detail::gravityScalar(target, gravitySources, softeningSq, expected);
+    const double expectedHeat = Physics::LeafKernels::detail::radiationScalar(target, radiationSources, 0.5, 0.0001);
+    const double magnitude = std::sqrt(double(expected[0]) * expected[0] + double(expected[1]) * expected[1] + double(expected[2]) * expected[2]);
+
+    using Physics::LeafKernels::Level;
+    for (Level level : { Level::Scalar, Level::Avx2, Level::Avx512 }) {
+        if (level > Physics::LeafKernels::detectedLevel()) continue;
+        SCOPED_TRACE(Physics::LeafKernels::levelName(level));
+        Physics::LeafKernels::setLevel(level);
+        ASSERT_EQ(Physics::LeafKernels::activeLevel(), level);
+
+        Physics::Real field[3] = { 0, 0, 0 };
+        Physics::LeafKernels::gravity(target, gravitySources, softeningSq, field);
+        for (int axis = 0; axis < 3; ++axis) EXPECT_NEAR(field[axis], expected[axis], 1e-5 * magnitude);
+        EXPECT_NEAR(Physics::LeafKernels::radiation(target, radiationSources, 0.5, 0.0001), expectedHeat, 1e-12 * expectedHeat);
+    }
+    Physics::LeafKernels::setLevel(Physics::LeafKernels::detectedLevel());
+}
+
+TEST(FastMultipole, ComputeForces_MatchesDirectSumOnAnyPool) {
+    constexpr int bodyCount = 5000;
+    std::mt19937 rng(11);
+    std::normal_distribution<float> normal(0.0f, 20.0f);
+    std::vector<std::unique_ptr<Physics::PointMass>> owned;
+    std::vector<Physics::PhysicsBody*> bodies;
+    for (int i = 0; i < bodyCount; ++i) {
+        owned.push_back(std::make_unique<Physics::PointMass>(i, 1.0 + (i % 5), glm::vec3(normal(rng), normal(rng), normal(rng))));
+        bodies.push_back(owned.back().get());
+    }
+    owned.push_back(std::make_unique<Physics::PointMass>(bodyCount, 2.0, bodies[0]->getPosition(BodyLock::NOLOCK)));
+    bodies.push_back(owned.back().get());
+
+    Octree tree;
+    tree.build(bodies);
+    FastMultipole fmm;
+    std::vector<glm::vec3> serial;
+    fmm.computeForces(tree, 1.0, serial);
+    ASSERT_EQ(serial.size(), bodies.size());
+    EXPECT_GT(fmm.farInteractionCount(), 0u);
+
+    Physics::ThreadPool pool(4);
+    std::vector<glm::vec3> parallel;
+    fmm.computeForces(tree, 1.0, parallel, &pool);
+    EXPECT_EQ(parallel, serial);
+
+    FastMultipole fine;
+    fine.setTheta(0.3);
+    std::vector<glm::vec3> fineForces;
+    fine.computeForces(tree, 1.0, fineForces);
+
+    double meanError = 0.0;
+    double meanFineError = 0.0;
+    int samples = 0;
+    for (std::size_t i = 0; i < bodies.size(); i += 53) {
+        glm::dvec3 direct(0.0);
+        const glm::dvec3 pos = bodies[i]->getPositionPrecise(BodyLock::NOLOCK);
+        for (Physics::PhysicsBody* other : bodies) {
+            if (other == bodies[i]) continue;
+            const glm::dvec3 d = other->getPositionPrecise(BodyLock::NOLOCK) - pos;
+            const double distSq = glm::dot(d, d) + Constants::SOFTENING_SQ;
+            direct += bodies[i]->getMass(BodyLock::NOLOCK) * other->getMass(BodyLock::NOLOCK) / (distSq * std::sqrt(distSq)) * d;
+        }
+        const double error = glm::length(glm::dvec3(serial[i]) - direct) / glm::length(direct);
+        EXPECT_LT(error, 0.05);
+        meanError += error;
+        meanFineError += glm::length(glm::dvec3(fineForces[i]) - direct) / glm::length(direct);
+        ++samples;
+    }
+    meanError /= samples;
+    meanFineError /= samples;
+    EXPECT_LT(meanError, 5e-3);
+    EXPECT_LT(meanFineError, 0.5 * meanError);
+}
+
+TEST(PhysicsSystem, Step_FastMultipoleFollowsBarnesHut) {
+    auto run = [](Physics::GravitySolver solver) {
+        Physics::PhysicsSystem system(glm::vec3(0.0f));
+        system.setGravitationalConstant(1.0);
+        Physics::GravityConfig gravity;
+        gravity.solver = solver;
+        system.setGravityConfig(gravity);
+
+        std::vector<std::unique_ptr<Physics::PointMass>> bodies;
+        for (int i = 0; i < 200; ++i) {
+            const float a = static_cast<float>(i);
+            auto pm = std::make_unique<Physics::PointMass>(i, 1.0 + (i % 3), glm::vec3(std::sin(a) * 30.0f, std::cos(a * 1.3f) * 30.0f, std::sin(a * 0.7f) * 30.0f), false);
+            system.addBody(pm.get());
+            bodies.push_back(std::move(pm));
+        }
+        for (int i = 0; i < 10; ++i) system.step(0.1f);
+
+        std::vector<glm::vec3> velocities;
+        for (const auto& body : bodies) velocities.push_back(body->getVelocity(BodyLock::LOCK));
+        return velocities;
+    };
+
+    const std::vector<glm::vec3> barnesHut = run(Physics::GravitySolver::BarnesHut);
+    const std::vector<glm::vec3> multipole = run(Physics::GravitySolver::FastMultipole);
+    // Both approximate, so compare in aggregate
+    double differenceSq = 0.0;
+    double magnitudeSq = 0.0;
+    for (std::size_t i = 0; i < barnesHut.size(); ++i) {
+        EXPECT_GT(glm::length(multipole[i]), 0.0f);
+        differenceSq += glm::dot(multipole[i] - barnesHut[i], multipole[i] - barnesHut[i]);
+        magnitudeSq += glm::dot(barnesHut[i], barnesHut[i]);
+    }
+    EXPECT_LT(std::sqrt(differenceSq / magnitudeSq), 0.05);
+}
+
+TEST(PhysicsSystem, Step_WorkerCount_IsBitIdentical) {
+    constexpr int bodyCount = 300;
+    constexpr int steps = 10;
+
+    auto run = [](std::size_t workers) {
+        Physics::PhysicsSystem system(glm::vec3(0.0f));
+        system.setGravitationalConstant(1.0);
+        system.setWorkerCount(workers);
+
+        std::vector<std::unique_ptr<Physics::PointMass>> bodies;
+        for (int i = 0; i < bodyCount; ++i) {
+            const float a = static_cast<float>(i);
+            auto pm = std::make_unique<Physics::PointMass>(i, 1.0 + (i % 7), glm::vec3(std::sin(a) * 50.0f, std::cos(a * 1.3f) * 50.0f, std::sin(a * 0.7f) * 50.0f), false);
+            ThermalProperties props;
+            props.tempK = 250.0 + (i % 11) * 20.0;
+            pm->setThermalProperty(props, BodyLock::LOCK);
+            system.addBody(pm.get());
+            bodies.push_back(std::move(pm));
+        }
+        for (int i = 0; i < steps; ++i) system.step(0.01f);
+
+        std::vector<float> state;
+        for (auto& pm : bodies) {
+            const glm::vec3 p = pm->getPosition(BodyLock::LOCK);
+            const glm::vec3 v = pm->getVelocity(BodyLock::LOCK);
+            state.insert(state.end(), { p.x, p.y, p.z, v.x, v.y, v.z, static_cast<float>(pm->getThermalProperties(BodyLock::LOCK).tempK) });
+        }
+        return state;
+    };
+
+    const std::vector<float> serial = run(1);
+    EXPECT_EQ(run(4), serial);
+}
+
+TEST(PhysicsSystem, Step_BlockTimesteps_ResolveFastInnerOrbit) {
+    // Inner orbit period 2*pi, outer one 64 times longer; dt is far too coarse for the inner one
+    constexpr float dt = 0.5f;
+    constexpr float softenedRadius3 = 1.01f * 1.0049876f; // (1 + SOFTENING_SQ)^1.5
+    Physics::PhysicsSystem system(glm::vec3(0.0f));
+    system.setGravitationalConstant(1.0);
+    Physics::PointMass sun(0, 1.0, glm::vec3(0.0f), true);
+    Physics::PointMass inner(1, 1e-6, glm::vec3(1.0f, 0.0f, 0.0f));
+    Physics::PointMass outer(2, 1e-6, glm::vec3(16.0f, 0.0f, 0.0f));
+    inner.setVelocity(glm::vec3(0.0f, 1.0f / std::sqrt(softenedRadius3), 0.0f), BodyLock::LOCK);
+    outer.setVelocity(glm::vec3(0.0f, 0.25f, 0.0f), BodyLock::LOCK);
+    system.addBody(&sun);
+    system.addBody(&inner);
+    system.addBody(&outer);
+
+    Physics::BlockTimestepConfig config;
+    config.enabled = true;
+    system.setBlockTimestepConfig(config);
+
+    float worstInner = 0.0f;
+    float worstOuter = 0.0f;
+    for (int i = 0; i < 50; ++i) {
+        system.step(dt);
+        worstInner = std::max(worstInner, std::fabs(glm::length(inner.getPosition(BodyLock::LOCK)) - 1.0f));
+        worstOuter = std::max(worstOuter, std::fabs(glm::length(outer.getPosition(BodyLock::LOCK)) - 16.0f));
+    }
+    EXPECT_NEAR(system.simTime, 25.0f, dt / 2);
+    EXPECT_LT(worstInner, 1e-3f);
+    EXPECT_LT(worstOuter, 1e-3f);
+    EXPECT_VEC3_EXACT(sun.getPosition(BodyLock::LOCK), glm::vec3(0.0f));
+
+    // The slow outer body must have left the finest level the fast one needs
+    const int innerLevel = system.getBlockLevel(&inner);
+    const int outerLevel = system.getBlockLevel(&outer);
+    ASSERT_GE(outerLevel, 0);
+    EXPECT_LT(outerLevel, innerLevel);
+}
+
+TEST(PhysicsSystem, Step_BlockTimesteps_ReuseEndOfStepForces) {
+    // The same scene twice, one of them forced to recompute its forces at the start of every step
+    struct Scene {
+        Physics::PhysicsSystem system{glm::vec3(0.0f)};
+        Physics::PointMass sun{0, 1.0, glm::vec3(0.0f), true};
+        Physics::PointMass inner{1, 1e-6, glm::vec3(1.0f, 0.0f, 0.0f)};
+        Physics::PointMass outer{2, 1e-6, glm::vec3(16.0f, 0.0f, 0.0f)};
+        Scene() {
+            system.setGravitationalConstant(1.0);
+            inner.setVelocity(glm::vec3(0.0f, 1.0f, 0.0f), BodyLock::LOCK);
+            outer.setVelocity(glm::vec3(0.0f, 0.25f, 0.0f), BodyLock::LOCK);
+            system.addBody(&sun);
+            system.addBody(&inner);
+            system.addBody(&outer);
+            Physics::BlockTimestepConfig config;
+            config.enabled = true;
+            system.setBlockTimestepConfig(config);
+        }
+    };
+    Scene reused;
+    Scene recomputed;
+
+    std::uint64_t reusedEvaluations = 0;
+    std::uint64_t recomputedEvaluations = 0;
+    for (int i = 0; i < 20; ++i) {
+        recomputed.outer.setMass(recomputed.outer.getMass(BodyLock::LOCK), BodyLock::LOCK); // counts as an edit
+        reused.system.step(0.5f);
+        recomputed.system.step(0.5f);
+
+        Physics::StepProfile profile;
+        if (reused.system.getProfiler().latest(profile)) reusedEvaluations += profile.count(Physics::StepCounter::ForceEvaluations);
+        if (recomputed.system.getProfiler().latest(profile)) recomputedEvaluations += profile.count(Physics::StepCounter::ForceEvaluations);
+    }
+    EXPECT_EQ(reused.inner.getPositionPrecise(BodyLock::LOCK), recomputed.inner.getPositionPrecise(BodyLock::LOCK));
+    EXPECT_EQ(reused.outer.getVelocityPrecise(BodyLock::LOCK), recomputed.outer.getVelocityPrecise(BodyLock::LOCK));
+    if constexpr (Physics::StepProfiler::enabled) {
+        // Three bodies skipped on every step after the first
+        EXPECT_EQ(recomputedEvaluations - reusedEvaluations, 19u * 3u);
+    }
+}
+
+TEST(PhysicsSystem, StepAdaptive_ShortensStepsNearPeriapsis) {
+    // Periapsis r = 1 with e = 0.5, apoapsis near 3, period about 17.8
+    Physics::PhysicsSystem system(glm::vec3(0.0f));
+    system.setGravitationalConstant(1.0);
+    system.setIntegrator(Physics::IntegratorType::LeapfrogKDK);
+    Physics::PointMass sun(0, 1.0, glm::vec3(0.0f), true);
+    Physics::PointMass planet(1, 1e-6, glm::vec3(1.0f, 0.0f, 0.0f));
+    planet.setVelocity(glm::vec3(0.0f, std::sqrt(1.5f), 0.0f), BodyLock::LOCK);
+    system.addBody(&sun);
+    system.addBody(&planet);
+
+    Physics::AdaptiveTimestepConfig config;
+    config.enabled = true;
+    config.relativeTolerance = 1e-4;
+    system.setAdaptiveTimestepConfig(config);
+
+    float periapsisDt = 0.0f;
+    float apoapsisDt = std::numeric_limits<float>::max();
+    float farthest = 0.0f;
+    int steps = 0;
+    while (system.simTime < 18.0) {
+        ASSERT_FALSE(system.stepAdaptive(10.0f));
+        ASSERT_LT(++steps, 5000);
+        const float r = glm::length(planet.getPosition(BodyLock::LOCK));
+        farthest = std::max(farthest, r);
+        if (r > 2.8f) apoapsisDt = std::min(apoapsisDt, system.getLastStepDt());
+        if (r < 1.2f && system.simTime > 10.0) periapsisDt = std::max(periapsisDt, system.getLastStepDt()); // past the start-up ramp
+    }
+    EXPECT_GT(periapsisDt, 0.0f);
+    EXPECT_GT(apoapsisDt, 2.0f * periapsisDt);
+    EXPECT_NEAR(farthest, 3.0f, 0.15f); // softening widens the orbit a little
+}
+
+TEST(PhysicsSystem, StepAdaptive_BallisticStepsStayWithinScene) {
+    // Leapfrog is exact under constant gravity, so only the scene bounds the steps
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -9.81f, 0.0f));
+    system.setIntegrator(Physics::IntegratorType::LeapfrogKDK);
+    Physics::PointMass floor(0, 1.0, glm::vec3(0.0f), true);
+    Physics::PointMass ball(1, 1.0, glm::vec3(0.0f, 20.0f, 0.0f));
+    ball.setVelocity(glm::vec3(5.0f, 15.0f, 0.0f), BodyLock::LOCK);
+    system.addBody(&floor);
+    system.addBody(&ball);
+
+    Physics::AdaptiveTimestepConfig config;
+    config.enabled = true;
+    config.maxDt = 100.0f;
+    system.setAdaptiveTimestepConfig(config);
+
+    std::size_t steps = 0;
+    while (system.simTime < 3.0) {
+        const glm::vec3 before = ball.getPosition(BodyLock::LOCK);
+        const float extent = glm::length(before);
+        ASSERT_FALSE(system.stepAdaptive(100.0f));
+        ++steps;
+        const float moved = glm::length(ball.getPosition(BodyLock::LOCK) - before);
+        ASSERT_LE(moved, 1.5f * config.maxSceneFraction * extent); // the cap uses the speed at the start of the step
+    }
+
+    // The full and half steps behind each accepted step leave one frame and one profile sample
+    ball.withFrames(BodyLock::LOCK, [&](const Physics::FrameHistory::View& frames) {
+        ASSERT_EQ(frames.recordedFrames(), steps + 1);
+        EXPECT_FLOAT_EQ(frames.back().time, static_cast<float>(system.simTime));
+        EXPECT_FLOAT_EQ(frames[frames.size() - 2].time, static_cast<float>(system.simTime) - system.getLastStepDt());
+    });
+    if constexpr (Physics::StepProfiler::enabled) {
+        EXPECT_EQ(system.getProfiler().committed(), steps);
+    }
+}
+
+TEST(Integrator, KeplerDrift_ClosesEllipseAfterOnePeriod) {
+    // Periapsis r = 1 with e = 0.5: a = 2, apoapsis at 3, mu = 1
+    glm::dvec3 position(1.0, 0.0, 0.0);
+    glm::dvec3 velocity(0.0, std::sqrt(1.5), 0.0); // vis-viva at periapsis with a = 2
+    const double period = 2.0 * std::numbers::pi * std::sqrt(8.0);
+
+    Physics::keplerDrift(position, velocity, 1.0, 0.5 * period);
+    EXPECT_NEAR(position.x, -3.0, 1e-9); // apoapsis
+    EXPECT_NEAR(position.y, 0.0, 1e-9);
+
+    Physics::keplerDrift(position, velocity, 1.0, 0.5 * period);
+    EXPECT_NEAR(position.x, 1.0, 1e-9);
+    EXPECT_NEAR(velocity.y, std::sqrt(1.5), 1e-9);
+}
+
+TEST(Integrator, KeplerDrift_HyperbolicLongDriftKeepsEnergy) {
+    // v^2 = 100 at r = 1 with mu = 1: far past escape, drifted for many crossing times
+    glm::dvec3 position(1.0, 0.0, 0.0);
+    glm::dvec3 velocity(0.0, 10.0, 0.0);
+    auto energy = [&] { return 0.5 * glm::dot(velocity, velocity) - 1.0 / glm::length(position); };
+    const double before = energy();
+
+    Physics::keplerDrift(position, velocity, 1.0, 1000.0);
+    ASSERT_TRUE(std::isfinite(position.x) && std::isfinite(velocity.x));
+    EXPECT_NEAR(energy(), before, 1e-9 * std::fabs(before));
+    EXPECT_GT(glm::length(position), 9000.0); // asymptotic speed ~9.95
+
+    Physics::keplerDrift(position, velocity, 1.0, -1000.0);
+    EXPECT_NEAR(position.x, 1.0, 1e-6);
+    EXPECT_NEAR(position.y, 0.0, 1e-6);
+}
+
+TEST(Integrator, SymplecticIntegrators_KeepOrbitEnergyAtCoarseSteps) {
+    // ~12 steps per orbit, where the legacy update loses the orbit
+    constexpr float dt = 0.5f;
+    auto energyDrift = [&](Physics::IntegratorType type) {
+        Physics::PhysicsSystem system(glm::vec3(0.0f));
+        system.setGravitationalConstant(1.0);
+        system.setIntegrator(type);
+        Physics::PointMass star(0, 1.0e6, glm::vec3(0.0f), false);
+        Physics::PointMass planet(1, 1.0, glm::vec3(100.0f, 0.0f, 0.0f));
+        planet.setVelocity(glm::vec3(0.0f, 100.0f, 0.0f), BodyLock::LOCK);
+        system.addBody(&star);
+        system.addBody(&planet);
+
+        auto energy = [&] {
+            const glm::dvec3 v(planet.getVelocity(BodyLock::LOCK));
+            const glm::dvec3 V(star.getVelocity(BodyLock::LOCK));
+            const glm::dvec3 d = glm::dvec3(planet.getPosition(BodyLock::LOCK)) - glm::dvec3(star.getPosition(BodyLock::LOCK));
+            return 0.5 * glm::dot(v, v) + 0.5e6 * glm::dot(V, V) - 1.0e6 / std::sqrt(glm::dot(d, d) + Constants::SOFTENING_SQ);
+        };
+        const double initial = energy();
+        for (int i = 0; i < 63; ++i) system.step(dt); // 5 orbits
+        return std::fabs((energy() - initial) / initial);
+    };
+
+    EXPECT_GT(energyDrift(Physics::IntegratorType::VelocityVerlet), 1e-2);
+    EXPECT_LT(energyDrift(Physics::IntegratorType::LeapfrogKDK), 1e-2);
+    EXPECT_LT(energyDrift(Physics::IntegratorType::Yoshida4), 1e-3);
+    EXPECT_LT(energyDrift(Physics::IntegratorType::Yoshida6), 1e-4);
+    EXPECT_LT(energyDrift(Physics::IntegratorType::WisdomHolman), 1e-4);
+}
+
+TEST(PhysicsSystem, Step_FarFromOrigin_MatchesOrbitAtOrigin) {
+    if constexpr (std::is_same_v<Physics::Real, float>) {
+        GTEST_SKIP() << "needs PHYSICS_DOUBLE_PRECISION";
+    }
+
+    // The same orbit 1e12 m out must trace the same path relative to its star
+    auto relativeOrbit = [](const glm::dvec3& origin) {
+        Physics::PhysicsSystem system(glm::vec3(0.0f));
+        system.setGravitationalConstant(1.0);
+        system.setIntegrator(Physics::IntegratorType::LeapfrogKDK);
+        Physics::PointMass star(0, 1.0e6, glm::vec3(0.0f), false);
+        Physics::PointMass planet(1, 1.0, glm::vec3(0.0f));
+        star.setPositionPrecise(origin, BodyLock::LOCK);
+        planet.setPositionPrecise(origin + glm::dvec3(100.0, 0.0, 0.0), BodyLock::LOCK);
+        planet.setVelocityPrecise(glm::dvec3(0.0, 100.0, 0.0), BodyLock::LOCK);
+        system.addBody(&star);
+        system.addBody(&planet);
+
+        for (int i = 0; i < 126; ++i) system.step(0.05f); // one orbit
+        return planet.getPositionPrecise(BodyLock::LOCK) - star.getPositionPrecise(BodyLock::LOCK);
+    };
+
+    const glm::dvec3 near = relativeOrbit(glm::dvec3(0.0));
+    const glm::dvec3 far = relativeOrbit(glm::dvec3(1.0e12, -1.0e12, 0.0));
+    EXPECT_LT(glm::length(far - near), 1e-2);
+}
+
+TEST(PhysicsSystem, Step_WorldTransformFollowsPosition) {
+    // Scaled transform: accumulating glm::translate increments would move the translation twice as fast
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -9.81f, 0.0f));
+    auto collider = std::make_unique<Physics::Bounding::BoxCollider>(
+        glm::vec3(0.0f), glm::vec3(0.5f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    Physics::RigidBody box(0, 1.0, std::move(collider), glm::vec3(1.0f, 50.0f, 0.0f));
+    box.setWorldTransform(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 50.0f, 0.0f)), glm::vec3(2.0f)), BodyLock::LOCK);
+    box.setVelocity(glm::vec3(3.0f, 0.0f, -1.0f), BodyLock::LOCK);
+    system.addBody(&box);
+
+    for (int i = 0; i < 200; ++i) system.step(0.01f);
+    const glm::mat4 transform = box.getWorldTransform(BodyLock::LOCK);
+    EXPECT_VEC3_EXACT(glm::vec3(transform[3]), glm::vec3(box.getPositionPrecise(BodyLock::LOCK)));
+    EXPECT_FLOAT_EQ(transform[0][0], 2.0f);
+}
+
+TEST(PhysicsSystem, Checkpoint_RestoresStateFramesAndClock) {
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -9.81f, 0.0f));
+    Physics::PointMass a(0, 2.0, glm::vec3(0.0f, 10.0f, 0.0f));
+    Physics::PointMass b(1, 1.0, glm::vec3(5.0f, 0.0f, 0.0f));
+    b.setVelocity(glm::vec3(0.0f, 3.0f, 0.0f), BodyLock::LOCK);
+    system.addBody(&a);
+    system.addBody(&b);
+    for (int i = 0; i < 10; ++i) system.step(0.01f);
+
+    Physics::StateCheckpoint checkpoint;
+    system.captureCheckpoint(checkpoint);
+    EXPECT_EQ(checkpoint.getSimTime(), system.simTime);
+
+    auto advance = [&] {
+        for (int i = 0; i < 20; ++i) system.step(0.01f);
+        return std::make_pair(b.getPositionPrecise(BodyLock::LOCK), b.getVelocityPrecise(BodyLock::LOCK));
+    };
+    const auto expected = advance();
+
+    // Anything edited after the capture must come back as well
+    ASSERT_TRUE(system.restoreCheckpoint(checkpoint));
+    EXPECT_DOUBLE_EQ(system.simTime, checkpoint.getSimTime());
+    b.withFrames(BodyLock::LOCK, [](const Physics::FrameHistory::View& frames) { EXPECT_EQ(frames.size(), 11u); });
+    b.setForce("Push", glm::vec3(50.0f, 0.0f, 0.0f), BodyLock::LOCK);
+    ThermalProperties props = b.getThermalProperties(BodyLock::LOCK);
+    props.tempK = 1000.0;
+    b.setThermalProperty(props, BodyLock::LOCK);
+
+    ASSERT_TRUE(system.restoreCheckpoint(checkpoint));
+    EXPECT_VEC3_EXACT(b.getForce("Push", BodyLock::LOCK), glm::vec3(0.0f));
+    EXPECT_NE(b.getThermalProperties(BodyLock::LOCK).tempK, 1000.0);
+    const auto replayed = advance();
+    EXPECT_EQ(replayed.first, expected.first);
+    EXPECT_EQ(replayed.second, expected.second);
+
+    // reset() rewinds to the state captured before the first step
+    system.reset();
+    EXPECT_EQ(system.simTime, 0.0);
+    EXPECT_VEC3_EXACT(b.getPosition(BodyLock::LOCK), glm::vec3(5.0f, 0.0f, 0.0f));
+    EXPECT_VEC3_EXACT(b.getVelocity(BodyLock::LOCK), glm::vec3(0.0f, 3.0f, 0.0f));
+
+    Physics::PointMass late(2, 1.0, glm::vec3(0.0f));
+    system.addBody(&late);
+    EXPECT_FALSE(system.restoreCheckpoint(checkpoint));
+    system.removeBody(&late);
+}
+
+TEST(PhysicsSystem, Checkpoint_RestoresFramesAfterSpillFills) {
+    // The bodies share one spill segment, so it fills after a few thousand steps
+    constexpr int bodyCount = 256;
+    constexpr float dt = 0.01f;
+    Physics::PhysicsSystem system(glm::vec3(0.0f, -9.81f, 0.0f));
+    system.setGravitationalConstant(0.0);
+    Physics::FrameHistoryConfig historyConfig;
+    historyConfig.windowFrames = Physics::FrameSpillFile::kChunkFrames;
+    historyConfig.maxSpillBytes = Physics::FrameSpillFile::kChunkBytes * Physics::FrameSpillFile::kSegmentChunks;
+    system.setFrameHistoryConfig(historyConfig);
+
+    std::vector<std::unique_ptr<Physics::PointMass>> bodies;
+    for (int i = 0; i < bodyCount; ++i) {
+        bodies.push_back(std::make_unique<Physics::PointMass>(i, 1.0, glm::vec3(static_cast<float>(i), 0.0f, 0.0f)));
+        system.addBody(bodies.back().get());
+    }
+    const std::size_t spillFrames = historyConfig.maxSpillBytes / sizeof(Physics::FrameRecord) / bodyCount;
+    const int fillSteps = static_cast<int>(spillFrames + 3 * historyConfig.windowFrames);
+    for (int i = 0; i < fillSteps; ++i) system.step(dt);
+
+    Physics::StateCheckpoint checkpoint;
+    system.captureCheckpoint(checkpoint);
+    for (int i = 0; i < 2 * static_cast<int>(historyConfig.windowFrames); ++i) system.step(dt);
+
+    ASSERT_TRUE(system.restoreCheckpoint(checkpoint));
+    for (const auto& body : bodies) {
+        body->withFrames(BodyLock::LOCK, [&](const Physics::FrameHistory::View& frames) {
+            ASSERT_GT(frames.size(), 1u);
+            EXPECT_EQ(frames.recordedFrames(), static_cast<std::size_t>(fillSteps) + 1);
+            EXPECT_NEAR(frames.back().time, static_cast<float>(checkpoint.getSimTime()), 0.5f * dt);
+            EXPECT_NEAR(frames[frames.size() - 2].time, frames.back().time - dt, 0.5f * dt);
+        });
+    }
+    EXPECT_LT(bodies.front()->getPosition(BodyLock::LOCK).y, 0.0f);
+}
+
+TEST(StepProfiler, History_KeepsNewestStepsOldestFirst) {
+    Physics::StepProfiler profiler;
+    Physics::StepProfile profile;
+    EXPECT_FALSE(profiler.latest(profile));
+
+    const std::uint64_t steps = Physics::StepProfiler::kHistory + 44;
+    for (std::uint64_t step = 1; step <= steps; ++step) {
+        profiler.begin();
+        profiler.count(Physics::StepCounter::Contacts, step);
+        profiler.commit(step);
+    }
+
+    ASSERT_TRUE(profiler.latest(profile));
+    EXPECT_EQ(profile.step, steps);
+    EXPECT_EQ(profile.count(Physics::StepCounter::Contacts), steps);
+
+    std::vector<Physics::StepProfile> history;
+    profiler.history(history);
+    ASSERT_EQ(history.size(), Physics::StepProfiler::kHistory);
+    EXPECT_EQ(history.front().step, 45u);
+    EXPECT_EQ(history.back().step, steps);
+}
+
+TEST(StepProfiler, Step_RecordsPhasesAndCounters) {
+    if constexpr (!Physics::StepProfiler::enabled) {
+        GTEST_SKIP() << "needs PHYSICS_ENABLE_PROFILING";
+    }
+
+    Physics::PhysicsSystem system(glm::vec3(0.0f));
+    Physics::PointMass a(0, 1.0, glm::vec3(0.0f));
+    Physics::PointMass b(1, 1.0, glm::vec3(10.0f, 0.0f, 0.0f));
+    system.addBody(&a);
+    system.addBody(&b);
+    system.step(0.01f);
+
+    Physics::StepProfile profile;
+    ASSERT_TRUE(system.getProfiler().latest(profile));
+    EXPECT_EQ(profile.step, 1u);
+    EXPECT_GE(profile.count(Physics::StepCounter::OctreeNodes), 3u);
+    EXPECT_EQ(profile.count(Physics::StepCounter::ForceEvaluations), 2u);
+    EXPECT_GT(profile.count(Physics::StepCounter::ThermalSubSteps), 0u);
+
+    // Phases are exclusive, so together they never exceed the step
+    std::uint64_t phases = 0;
+    for (std::uint64_t nanos : profile.phaseNanos) phases += nanos;
+    EXPECT_LE(phases, profile.totalNanos);
+}
+
+TEST(SnapshotChannel, Read_InterpolatesAndHonoursEpoch) {
+    Physics::SnapshotChannel channel;
+    Physics::PointMass pm(0, 1.0);
+    std::vector<ObjectSnapshot> out;
+
+    EXPECT_FALSE(channel.read(0.0f, 1, out));
+
+    channel.beginWrite().push_back({ &pm, 0.0f, glm::vec3(0.0f), glm::vec3(0.0f), 300.0f });
+    channel.publish(1);
+    channel.beginWrite().push_back({ &pm, 1.0f, glm::vec3(2.0f), glm::vec3(4.0f), 400.0f });
+    channel.publish(1);
+
+    ASSERT_TRUE(channel.read(0.5f, 1, out));
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_VEC3_EXACT(out[0].position, glm::vec3(1.0f));
+    EXPECT_VEC3_EXACT(out[0].velocity, glm::vec3(2.0f));
+    EXPECT_FLOAT_EQ(out[0].temperature, 350.0f);
+
+    // Frames from before an invalidation are never returned
+    EXPECT_FALSE(channel.read(0.5f, 2, out));
+}
+
+TEST(FrameHistory, Window_SpillsAndPinsFirstFrame) {
+    constexpr std::size_t chunk = Physics::FrameSpillFile::kChunkFrames;
+    constexpr std::size_t total = 5 * chunk + 7;
+    auto record = [](std::size_t i) {
+        const float f = static_cast<float>(i);
+        return Physics::FrameRecord{ f, glm::vec3(f, 0.0f, 0.0f), glm::vec3(0.0f, f, 0.0f), 300.0f + f };
+    };
+    Physics::PointMass pm(0, 1.0);
+
+    // Spilled: every frame stays readable, in order, while memory holds at most window + one chunk
+    Physics::FrameHistory spilled;
+    spilled.configure(chunk, std::make_shared<Physics::FrameSpillFile>(std::filesystem::path{}, std::size_t(1) << 30));
+    for (std::size_t i = 0; i < total; ++i) spilled.push(record(i));
+
+    EXPECT_LT(spilled.residentFrames(), 2 * chunk);
+    EXPECT_EQ(spilled.droppedFrames(), 0u);
+    const Physics::FrameHistory::View view = spilled.view(&pm);
+    ASSERT_EQ(view.size(), total);
+    for (std::size_t i = 0; i < total; ++i) {
+        ASSERT_FLOAT_EQ(view[i].time, static_cast<float>(i));
+    }
+    EXPECT_EQ(view.front().body, &pm);
+    EXPECT_VEC3_EXACT(view.back().velocity, glm::vec3(0.0f, static_cast<float>(total - 1), 0.0f));
+
+    // Truncating into the spill pulls the partial chunk back into memory and keeps pushing in order
+    const std::size_t kept = 2 * chunk + 3;
+    spilled.truncate(kept);
+    EXPECT_EQ(spilled.size(), kept);
+    EXPECT_EQ(spilled.spilledFrames(), 2 * chunk);
+    spilled.push(record(kept));
+    ASSERT_EQ(spilled.size(), kept + 1);
+    for (std::size_t i = 0; i <= kept; ++i) {
+        ASSERT_FLOAT_EQ(spilled.view(&pm)[i].time, static_cast<float>(i));
+    }
+
+    // Dropped: the t=0 frame survives for resets and the sequence stays time-ordered
+    Physics::FrameHistory dropped;
+    dropped.configure(chunk, nullptr);
+    for (std::size_t i = 0; i < total; ++i) dropped.push(record(i));
+
+    const Physics::FrameHistory::View bounded = dropped.view(&pm);
+    EXPECT_EQ(bounded.size(), 1 + dropped.residentFrames());
+    EXPECT_FLOAT_EQ(bounded.front().time, 0.0f);
+    EXPECT_FLOAT_EQ(bounded.back().time, static_cast<float>(total - 1));
+    EXPECT_TRUE(std::is_sorted(bounded.begin(), bounded.end(),
+        [](const ObjectSnapshot& a, const ObjectSnapshot& b) { return a.time < b.time; }));
+
+    // A recorded count taken before more frames were dropped still truncates back to the same frame
+    const std::size_t mark = dropped.recordedFrames();
+    EXPECT_EQ(mark, total);
+    for (std::size_t i = total; i < total + chunk; ++i) dropped.push(record(i));
+    EXPECT_GT(dropped.droppedFrames(), 0u);
+    dropped.truncate(mark);
+    EXPECT_EQ(dropped.recordedFrames(), mark);
+    EXPECT_FLOAT_EQ(bounded.back().time, static_cast<float>(mark - 1));
+    EXPECT_FLOAT_EQ(bounded.front().time, 0.0f);
+
+    Physics::FrameHistory copy;
+    copy.configure(chunk, nullptr);
+    copy.assign(dropped);
+    EXPECT_EQ(copy.recordedFrames(), dropped.recordedFrames());
+    ASSERT_EQ(copy.size(), dropped.size());
+    EXPECT_FLOAT_EQ(copy.view(&pm).front().time, 0.0f);
+    EXPECT_FLOAT_EQ(copy.view(&pm).back().time, bounded.back().time);
+
+    dropped.clear();
+    EXPECT_TRUE(dropped.view(&pm).empty());
+
+    // A zero window really is off: nothing stays in memory but the pinned first frame
+    Physics::FrameHistory off;
+    off.configure(0, nullptr);
+    for (std::size_t i = 0; i < total; ++i) off.push(record(i));
+    EXPECT_EQ(off.residentFrames(), 0u);
+    EXPECT_EQ(off.recordedFrames(), total);
+    ASSERT_EQ(off.size(), 1u);
+    EXPECT_FLOAT_EQ(off.view(&pm).front().time, 0.0f);
+}
+
+TEST(FrameHistory, FullSpill_DropsOldestFramesAndTruncatesExactly) {
+    constexpr std::size_t chunk = Physics::FrameSpillFile::kChunkFrames;
+    constexpr std::size_t capacity = chunk * Physics::FrameSpillFile::kSegmentChunks; // one segment
+    constexpr std::size_t total = capacity + 5 * chunk + 7;
+    auto record = [](std::size_t i) {
+        const float f = static_cast<float>(i);
+        return Physics::FrameRecord{ f, glm::vec3(f, 0.0f, 0.0f), glm::vec3(0.0f), 300.0f };
+    };
+    Physics::PointMass pm(0, 1.0);
+
+    Physics::FrameHistory history;
+    history.configure(chunk, std::make_shared<Physics::FrameSpillFile>(std::filesystem::path{}, Physics::FrameSpillFile::kChunkBytes * Physics::FrameSpillFile::kSegmentChunks));
+    for (std::size_t i = 0; i < total; ++i) history.push(record(i));
+    ASSERT_GT(history.droppedFrames(), 0u);
+    EXPECT_EQ(history.recordedFrames(), total);
+
+    // Pinned origin, then one unbroken run that starts right after the dropped frames
+    auto expectContiguous = [&](std::size_t recorded) {
+        const Physics::FrameHistory::View view = history.view(&pm);
+        ASSERT_EQ(view.size(), 1 + recorded - history.droppedFrames());
+        EXPECT_FLOAT_EQ(view[0].time, 0.0f);
+        for (std::size_t i = 1; i < view.size(); ++i) {
+            ASSERT_FLOAT_EQ(view[i].time, static_cast<float>(history.droppedFrames() + i - 1));
+        }
+    };
+    expectContiguous(total);
+
+    const std::size_t mark = total - 3 * chunk - 11; // inside the spill
+    history.truncate(mark);
+    EXPECT_EQ(history.recordedFrames(), mark);
+    EXPECT_FLOAT_EQ(history.view(&pm).back().time, static_cast<float>(mark - 1));
+    expectContiguous(mark);
+}
+
 TEST(ThermalUtils, ConductiveExchange_ConservesEnergyAndDoesNotOvershoot) {
     ThermalProperties hot;
     hot.tempK = 400.0;
@@ -418,6 +1565,49 @@ TEST(RigidBody, CollisionHeat_ZeroSpecificHeat_DoesNotCreateNaN) {
     EXPECT_TRUE(std::isfinite(pm.getThermalProperties(BodyLock::LOCK).tempK));
 }
 
+TEST(RigidBody, Collision_FarFromOrigin_MatchesCollisionAtOrigin) {
+    if constexpr (std::is_same_v<Physics::Real, float>) {
+        GTEST_SKIP() << "needs PHYSICS_DOUBLE_PRECISION";
+    }
+
+    // Broad and narrow phase work around the bodies, so contacts 1e12 m out behave as at the origin
+    auto makeBox = [](uint32_t id, const glm::dvec3& position, const glm::vec3& halfExtents) {
+        auto collider = std::make_unique<Physics::Bounding::BoxCollider>(
+            glm::vec3(0.0f), halfExtents, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        auto box = std::make_unique<Physics::RigidBody>(id, std::move(collider), glm::vec3(0.0f), true);
+        box->setPositionPrecise(position, BodyLock::LOCK);
+        glm::mat4 transform(1.0f);
+        transform[3] = glm::vec4(glm::vec3(position), 1.0f);
+        box->setWorldTransform(transform, BodyLock::LOCK);
+        return box;
+    };
+    auto landing = [&](const glm::dvec3& origin) {
+        auto floor = makeBox(0, origin, glm::vec3(5.0f, 1.0f, 5.0f));
+        Physics::PointMass ball(1, 1.0, glm::vec3(0.0f));
+        ball.setPositionPrecise(origin + glm::dvec3(0.5, 0.98, -0.25), BodyLock::LOCK);
+        ball.setVelocityPrecise(glm::dvec3(0.0, -2.0, 0.0), BodyLock::LOCK);
+        EXPECT_TRUE(floor->collidesWithPointMass(ball));
+        floor->resolveCollisionWithPointMass(0.01f, ball);
+        return std::pair(ball.getPositionPrecise(BodyLock::LOCK) - origin, ball.getVelocityPrecise(BodyLock::LOCK));
+    };
+    auto pairCount = [&](const glm::dvec3& origin, double gap) {
+        auto a = makeBox(0, origin, glm::vec3(0.5f));
+        auto b = makeBox(1, origin + glm::dvec3(1.0 + gap, 0.0, 0.0), glm::vec3(0.5f));
+        BVH bvh;
+        bvh.build({ a.get(), b.get() });
+        return bvh.getPotentialCollisions().size();
+    };
+
+    const auto [nearPosition, nearVelocity] = landing(glm::dvec3(0.0));
+    const glm::dvec3 far(1.0e12, -1.0e12, 3.0e11);
+    const auto [farPosition, farVelocity] = landing(far);
+    EXPECT_NEAR(nearPosition.y, 1.0, 1e-5); // pushed out onto the top face
+    EXPECT_LT(glm::length(farPosition - nearPosition), 1e-5);
+    EXPECT_LT(glm::length(farVelocity - nearVelocity), 1e-5);
+    EXPECT_EQ(pairCount(far, -0.01), 1u);
+    EXPECT_EQ(pairCount(far, 0.01), 0u);
+}
+
 // Simulation tests
 TEST(Integration, Zero_Velocity_Zero_Acceleration) {
     constexpr float time = 50.0f;